@@ -0,0 +1,95 @@
+#include "incs.hpp"
+#include <cmath>
+
+#include "jobsystem.hpp"
+#include "transform.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t kNodes{ 100000 };
+    constexpr size_t kBranching{ 4 };
+    constexpr size_t kWorkItems{ 1 << 20 };
+    constexpr int kRepeats{ 30 };
+
+    template<class Fn>
+    double bestOf(Fn &&fn) {
+        fn();
+        double best{ std::numeric_limits<double>::max() };
+        for(int i = 0; i < kRepeats; ++i) {
+            const auto start{ Clock::now() };
+            fn();
+            const std::chrono::duration<double, std::micro> elapsed{ Clock::now() - start };
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    TransformHierarchy buildHierarchy() {
+        TransformHierarchy hierarchy{ kNodes };
+        hierarchy.Create();
+        for(size_t i = 1; i < kNodes; ++i) {
+            const auto node{ hierarchy.Create(static_cast<TransformHierarchy::Node>((i - 1) / kBranching)) };
+            hierarchy.SetPosition(node, glm::vec3{ 0.01f * i, 0.0f, 1.0f });
+        }
+        hierarchy.Update();
+        return hierarchy;
+    }
+}
+
+int main() {
+    const size_t maxThreads{ std::max<size_t>(1, std::thread::hardware_concurrency()) };
+    auto hierarchy{ buildHierarchy() };
+    std::vector<float> work(kWorkItems, 1.0f);
+
+    std::cout << "Job system scalability, best of " << kRepeats << '\n';
+    std::cout << std::setw(8) << "threads"
+              << std::setw(22) << "transforms (all)"
+              << std::setw(22) << "transforms (root)"
+              << std::setw(18) << "parallel_for"
+              << std::setw(10) << "speedup" << '\n';
+
+    std::vector<size_t> counts;
+    for(size_t threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);   // always finish with every core
+
+    double baseline{ 0.0 };
+    for(const size_t threads : counts) {
+        JobSystem::Instance()->Initialize(threads);
+
+        // every node dirty: full recompute of 100k world matrices
+        const double all{ bestOf([&] {
+            for(TransformHierarchy::Node node = 0; node < kNodes; ++node) {
+                hierarchy.SetScale(node, glm::vec3{ 1.0f });
+            }
+            hierarchy.Update();
+        }) };
+        // only the root dirty: the flag has to travel down the whole tree
+        const double root{ bestOf([&] {
+            hierarchy.SetPosition(0, glm::vec3{ 1.0f });
+            hierarchy.Update();
+        }) };
+        const double compute{ bestOf([&] {
+            JobSystem::Instance()->ParallelFor(0, work.size(), 4096, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; ++i) {
+                    work[i] = std::sqrt(work[i] * 1.0001f + 0.5f);
+                }
+            });
+        }) };
+        if(1 == threads) {
+            baseline = compute;
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << threads
+                  << std::setw(19) << all << " us"
+                  << std::setw(19) << root << " us"
+                  << std::setw(15) << compute << " us"
+                  << std::setw(9) << std::setprecision(2) << baseline / compute << "x" << '\n';
+
+        JobSystem::Instance()->Shutdown();
+    }
+    return 0;
+}
@@ -0,0 +1,353 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <plog/Appenders/RollingFileAppender.h>
+#include <plog/Formatters/TxtFormatter.h>
+#ifdef _WIN32
+#include <codecvt>
+#include <locale>
+#endif
+
+#include "binarylog.hpp"
+#include "imguiappender.hpp"
+#include "logutilites.hpp"
+
+/**
+ * Logger benchmarks; ImGui runs without a renderer, no window or GL needed.
+ *
+ * Log window: time of one ImGui frame that draws the Logs window, by rows
+ * stored. "clipped" is ImGuiLogVisualizer::Draw and should stay flat,
+ * "all rows" submits every row the way the window used to (up to 100k).
+ *
+ * Log filter: over 1M rows, time from SetFilter until the window shows the
+ * complete result, and the number of frames the rescan was spread over.
+ *
+ * ImGui appender: cost of one record from the appender into the window,
+ * the previous stream + wstring_convert path against the in-place one.
+ *
+ * File sink: cost of one record and file bytes per record for the text log,
+ * the binary log fed by plog records, and BLOG with typed arguments.
+ */
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t kRowCounts[]{ 1000, 10000, 100000, 1000000, 2000000 };
+    constexpr size_t kMaxAllRows{ 100000 };
+    constexpr size_t kRowBytes{ 64 };
+    constexpr int kWarmup{ 3 };
+    constexpr int kFrames{ 20 };
+    constexpr size_t kFilterRows{ 1000000 };
+    constexpr size_t kRecords{ 200000 };
+
+    std::atomic<size_t> gAllocations{ 0 };
+
+    const char *const kTags[]{ "[Mash]", "[Texture]", "[Shader]", "[Scene]" };
+
+    void createContext() {
+        ImGui::CreateContext();
+        ImGuiIO &io{ ImGui::GetIO() };
+        io.DisplaySize = ImVec2{ 1370.0f, 900.0f };
+        io.DeltaTime = 1.0f / 60.0f;
+        io.IniFilename = nullptr;
+        unsigned char *pixels{ nullptr };
+        int width{ 0 }, height{ 0 };
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+
+    plog::Severity rowSeverity(size_t i) {
+        return 0 == i % 97 ? plog::error : 0 == i % 13 ? plog::warning : 0 == i % 3 ? plog::debug : plog::info;
+    }
+
+    std::string makeRow(size_t i) {
+        char row[kRowBytes];
+        std::snprintf(row, sizeof(row), "[12:%02zu:%02zu.%03zu][%-5s] %s record %zu",
+            i / 60000 % 60, i / 1000 % 60, i % 1000, plog::severityToString(rowSeverity(i)),
+            kTags[i % std::size(kTags)], i);
+        return row;
+    }
+
+    void fill(Utilites::ImGuiLogVisualizer &visualizer, size_t rows) {
+        for(size_t i = 0; i < rows; ++i) {
+            visualizer.Roll(rowSeverity(i), kTags[i % std::size(kTags)], makeRow(i));
+        }
+    }
+
+    template<class Fn>
+    void drawFrame(Fn &&draw) {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2{ 0.0f, 0.0f });
+        ImGui::SetNextWindowSize(ImVec2{ 1370.0f, 900.0f });
+        draw();
+        ImGui::Render();
+    }
+
+    /// Average microseconds of an ImGui frame (NewFrame to Render) around draw.
+    template<class Fn>
+    double frameTime(Fn &&draw) {
+        double total{ 0.0 };
+        for(int frame = 0; frame < kWarmup + kFrames; ++frame) {
+            const auto start{ Clock::now() };
+            drawFrame(draw);
+            const std::chrono::duration<double, std::micro> elapsed{ Clock::now() - start };
+            if(frame >= kWarmup) {
+                total += elapsed.count();
+            }
+        }
+        return total / kFrames;
+    }
+
+    void benchWindow() {
+        std::cout << "Log window frame, average of " << kFrames << '\n';
+        std::cout << std::setw(10) << "rows"
+                  << std::setw(16) << "clipped"
+                  << std::setw(16) << "all rows" << '\n';
+
+        for(const size_t rows : kRowCounts) {
+            Utilites::ImGuiLogVisualizer::Limits limits;
+            limits.lines = rows;
+            limits.bytes = rows * kRowBytes;
+            Utilites::ImGuiLogVisualizer visualizer{ limits };
+            fill(visualizer, rows);
+            std::vector<std::string> all;
+            for(size_t i = 0; i < rows && rows <= kMaxAllRows; ++i) {
+                all.push_back(makeRow(i));
+            }
+
+            const double clipped{ frameTime([&] { visualizer.Draw(); }) };
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::setw(10) << visualizer.Lines()
+                      << std::setw(13) << clipped << " us";
+            if(rows <= kMaxAllRows) {
+                const double everything{ frameTime([&] {
+                    ImGui::Begin("Logs");
+                    for(const auto &row : all) {
+                        ImGui::TextColored(ImVec4{ 0.1f, 0.7f, 0.3f, 1.0f }, "%s", row.c_str());
+                    }
+                    ImGui::End();
+                }) };
+                std::cout << std::setw(13) << everything << " us";
+            } else {
+                std::cout << std::setw(16) << "-";
+            }
+            std::cout << '\n';
+        }
+    }
+
+    void benchFilter() {
+        Utilites::ImGuiLogVisualizer::Limits limits;
+        limits.lines = kFilterRows;
+        limits.bytes = kFilterRows * kRowBytes;
+        Utilites::ImGuiLogVisualizer visualizer{ limits };
+        fill(visualizer, kFilterRows);
+        drawFrame([&] { visualizer.Draw(); });
+
+        using Filter = Utilites::ImGuiLogVisualizer::Filter;
+        const std::pair<const char *, Filter> filters[]{
+            { "warning and worse", Filter{ (1u << plog::fatal) | (1u << plog::error) | (1u << plog::warning) } },
+            { "tag [Shader]", Filter{ ~0u, "[Shader]" } },
+            { "text \"record 12\"", Filter{ ~0u, {}, "record 12" } },
+            { "narrowed \"record 123\"", Filter{ ~0u, {}, "record 123" } },
+            { "regex \"record \\d+77$\"", Filter{ ~0u, {}, "record \\d+77$", true } },
+            { "none", Filter{} },
+        };
+
+        std::cout << '\n' << "Log filter over " << visualizer.Lines() << " rows" << '\n';
+        std::cout << std::setw(28) << "filter"
+                  << std::setw(12) << "matches"
+                  << std::setw(14) << "complete"
+                  << std::setw(10) << "frames" << '\n';
+        for(const auto &[name, filter] : filters) {
+            const auto start{ Clock::now() };
+            visualizer.SetFilter(filter);
+            int frames{ 0 };
+            do {
+                drawFrame([&] { visualizer.Draw(); });
+                ++frames;
+            } while(visualizer.Filtering());
+            const std::chrono::duration<double, std::milli> elapsed{ Clock::now() - start };
+            std::cout << std::fixed << std::setprecision(2)
+                      << std::setw(28) << name
+                      << std::setw(12) << visualizer.Matches()
+                      << std::setw(11) << elapsed.count() << " ms"
+                      << std::setw(10) << frames << '\n';
+        }
+    }
+    /// Record the way AsyncAppender hands it over: stored fields, nothing computed on access.
+    class BenchRecord : public plog::Record {
+    public:
+        explicit BenchRecord(const plog::util::nchar *message)
+            : plog::Record{ plog::info, "Mash::Mash", 42, __FILE__, nullptr, 0 }
+            , mMessage{ message }
+        {
+            plog::util::ftime(&mTime);
+        }
+
+        /// Moves the clock on by a millisecond.
+        void Tick() {
+            if(++mTime.millitm == 1000) {
+                mTime.millitm = 0;
+                ++mTime.time;
+            }
+        }
+
+        const plog::util::Time &getTime() const override { return mTime; }
+        const char *getFunc() const override { return "Mash::Mash"; }
+        const plog::util::nchar *getMessage() const override { return mMessage; }
+
+    private:
+        plog::util::Time mTime;
+        const plog::util::nchar *mMessage;
+    };
+
+    std::string legacyConvert(const plog::util::nstring &text) {
+#ifdef _WIN32
+        std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> conv;
+        return conv.to_bytes(text);
+#else
+        return text;
+#endif
+    }
+
+    /// SimpleFormatter::format and ImGuiAppender::write as they were before the in-place path.
+    void legacyWrite(Utilites::ImGuiLogVisualizer &visualizer, const plog::Record &record) {
+        using namespace plog;
+        tm t;
+        util::localtime_s(&t, &record.getTime().time);
+        util::nostringstream ss;
+        ss << PLOG_NSTR("[") << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_hour << PLOG_NSTR(":") << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_min << PLOG_NSTR(":") << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_sec << PLOG_NSTR(".") << std::setfill(PLOG_NSTR('0')) << std::setw(3) << record.getTime().millitm << PLOG_NSTR("]");
+        ss << PLOG_NSTR("[") << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::left << severityToString(record.getSeverity()) << PLOG_NSTR("]");
+        util::nostringstream func;
+        func << record.getFunc();
+        const util::nstring name{ func.str() };
+        util::nostringstream result;
+        if(name.find(PLOG_NSTR("::")) != util::nstring::npos) {
+            result << PLOG_NSTR("[Anonymous@") << record.getLine() << PLOG_NSTR("]");
+        } else {
+            result << PLOG_NSTR("[") << name << PLOG_NSTR("]");
+        }
+        ss << result.str() << PLOG_NSTR(" ");
+        ss << record.getMessage() << PLOG_NSTR("\n");
+
+        const util::nstring message{ record.getMessage() };
+        const size_t close{ message.find(PLOG_NSTR(']')) };
+        const util::nstring tag{ 0 == message.find(PLOG_NSTR('[')) && close != util::nstring::npos ? message.substr(0, close + 1) : util::nstring{} };
+        visualizer.Roll(record.getSeverity(), legacyConvert(tag), legacyConvert(ss.str()));
+    }
+
+    template<class Fn>
+    void measureRecords(const char *name, Fn &&write) {
+        Utilites::ImGuiLogVisualizer::Ref visualizer{ std::make_shared<Utilites::ImGuiLogVisualizer>() };
+        BenchRecord record{ PLOG_NSTR("[Mash] Loaded 24 vertices, 36 indices from cube.obj") };
+        for(size_t i = 0; i < kRecords / 10; ++i) {
+            write(visualizer, record);
+            record.Tick();
+        }
+        const size_t allocations{ gAllocations.load() };
+        const auto start{ Clock::now() };
+        for(size_t i = 0; i < kRecords; ++i) {
+            write(visualizer, record);
+            record.Tick();
+        }
+        const std::chrono::duration<double, std::nano> elapsed{ Clock::now() - start };
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(22) << name
+                  << std::setw(14) << elapsed.count() / kRecords
+                  << std::setw(16) << std::setprecision(2) << static_cast<double>(gAllocations.load() - allocations) / kRecords << '\n';
+    }
+
+    void benchAppender() {
+        std::cout << '\n' << "ImGui appender, " << kRecords << " records" << '\n';
+        std::cout << std::setw(22) << "path"
+                  << std::setw(14) << "ns/record"
+                  << std::setw(16) << "allocs/record" << '\n';
+        measureRecords("stream + convert", [](const Utilites::ImGuiLogVisualizer::Ref &visualizer, const plog::Record &record) {
+            legacyWrite(*visualizer, record);
+        });
+        std::unique_ptr<plog::ImGuiAppender<plog::SimpleFormatter>> appender;
+        measureRecords("in place", [&appender](const Utilites::ImGuiLogVisualizer::Ref &visualizer, const plog::Record &record) {
+            if(nullptr == appender) {
+                appender = std::make_unique<plog::ImGuiAppender<plog::SimpleFormatter>>(visualizer);
+            }
+            appender->write(record);
+        });
+    }
+
+    /// ns/record and file bytes/record of write(i), i counting records; close
+    /// runs untimed before the file is measured.
+    template<class Fn, class Close>
+    void measureSink(const char *name, const std::filesystem::path &path, Fn &&write, Close &&close) {
+        const auto start{ Clock::now() };
+        for(size_t i = 0; i < kRecords; ++i) {
+            write(i);
+        }
+        const std::chrono::duration<double, std::nano> elapsed{ Clock::now() - start };
+        close();
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(22) << name
+                  << std::setw(14) << elapsed.count() / kRecords
+                  << std::setw(16) << static_cast<double>(std::filesystem::file_size(path)) / kRecords << '\n';
+        std::filesystem::remove(path);
+    }
+
+    void benchFileSink() {
+        const std::filesystem::path directory{ std::filesystem::temp_directory_path() };
+        const std::filesystem::path text{ directory / "log_bench.txt" };
+        const std::filesystem::path binary{ directory / "log_bench.blog" };
+        BenchRecord record{ PLOG_NSTR("[Mash] Loaded 24 vertices, 36 indices from cube.obj") };
+
+        std::cout << '\n' << "File sink, " << kRecords << " records" << '\n';
+        std::cout << std::setw(22) << "path"
+                  << std::setw(14) << "ns/record"
+                  << std::setw(16) << "bytes/record" << '\n';
+        auto closeBinary = [] { BinaryLog::Instance()->Close(); };
+
+        auto file{ std::make_unique<plog::RollingFileAppender<plog::TxtFormatter>>(text.string().c_str()) };
+        measureSink("text file", text, [&](size_t) {
+            file->write(record);
+            record.Tick();
+        }, [&file] { file.reset(); });
+
+        BinaryLog::Instance()->Open(binary.string());
+        plog::BinaryAppender appender;
+        measureSink("binary, plog record", binary, [&](size_t) {
+            appender.write(record);
+            record.Tick();
+        }, closeBinary);
+
+        // what BLOGI expands to, without the logger's severity check
+        BinaryLog::Instance()->Open(binary.string());
+        static BinaryLog::Site site{ plog::info, __FILE__, __LINE__, "Mash::Mash" };
+        const std::string path{ "cube.obj" };
+        measureSink("binary, BLOG", binary, [&](size_t i) {
+            BinaryLog::Instance()->Write(site, "[Mash] Loaded {} vertices, {} indices from {}", 24 + i % 8, 36 + i % 8, path);
+        }, closeBinary);
+    }
+}
+
+void *operator new(size_t size) {
+    ++gAllocations;
+    if(void *memory{ std::malloc(size) }) {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+int main() {
+    createContext();
+    benchWindow();
+    benchFilter();
+    benchAppender();
+    benchFileSink();
+    ImGui::DestroyContext();
+    return 0;
+}
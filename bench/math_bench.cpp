@@ -0,0 +1,156 @@
+#include "incs.hpp"
+#include <cstring>
+#include <functional>
+#include <random>
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include "batchmath.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t kCount{ 100003 };   ///< deliberately not a multiple of any lane width
+    constexpr int kRepeats{ 20 };
+
+    struct Data {
+        std::vector<glm::mat4> lhs, rhs, out, ref;
+        std::vector<glm::vec3> t, s, points, pointsOut, pointsRef;
+        std::vector<glm::quat> r;
+        std::vector<BatchMath::AABB> boxes, boxesOut, boxesRef;
+
+        Data() {
+            std::mt19937 rng{ 42 };
+            std::uniform_real_distribution<float> dist{ -4.0f, 4.0f };
+            auto rnd = [&] { return dist(rng); };
+            auto mat = [&] {
+                glm::mat4 m;
+                for(int c = 0; c < 4; ++c) {
+                    m[c] = glm::vec4{ rnd(), rnd(), rnd(), rnd() };
+                }
+                return m;
+            };
+            for(size_t i = 0; i < kCount; ++i) {
+                lhs.push_back(mat());
+                rhs.push_back(mat());
+                t.emplace_back(rnd(), rnd(), rnd());
+                s.emplace_back(rnd(), rnd(), rnd());
+                r.push_back(glm::normalize(glm::quat{ rnd(), rnd(), rnd(), rnd() }));
+                points.emplace_back(rnd(), rnd(), rnd());
+                const glm::vec3 a{ rnd(), rnd(), rnd() };
+                const glm::vec3 b{ rnd(), rnd(), rnd() };
+                boxes.push_back({ glm::min(a, b), glm::max(a, b) });
+            }
+            out.resize(kCount);
+            ref.resize(kCount);
+            pointsOut.resize(kCount);
+            pointsRef.resize(kCount);
+            boxesOut.resize(kCount);
+            boxesRef.resize(kCount);
+        }
+    };
+
+    double measure(const std::function<void()> &fn) {
+        fn(); // warm up caches and the dispatcher
+        double best{ std::numeric_limits<double>::max() };
+        for(int i = 0; i < kRepeats; ++i) {
+            const auto start{ Clock::now() };
+            fn();
+            const std::chrono::duration<double, std::micro> elapsed{ Clock::now() - start };
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    template<class T>
+    bool sameBits(const std::vector<T> &a, const std::vector<T> &b) {
+        return 0 == std::memcmp(a.data(), b.data(), a.size() * sizeof(T));
+    }
+
+    void report(const char *kernel, const char *backend, double glmUs, double batchUs, bool exact) {
+        std::cout << std::left << std::setw(18) << kernel << std::setw(8) << backend
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << glmUs << " us"
+                  << std::setw(10) << batchUs << " us"
+                  << std::setw(8) << std::setprecision(2) << glmUs / batchUs << "x"
+                  << (exact ? "   bit-exact" : "   MISMATCH") << '\n';
+    }
+}
+
+int main() {
+    Data d;
+    bool allExact{ true };
+
+    const double glmMultiply{ measure([&] {
+        for(size_t i = 0; i < kCount; ++i) d.ref[i] = d.lhs[i] * d.rhs[i];
+    }) };
+    const auto multiplyRef{ d.ref };
+    const double glmCompose{ measure([&] {
+        for(size_t i = 0; i < kCount; ++i) {
+            glm::mat4 m{ glm::mat4_cast(d.r[i]) };
+            m[0] *= d.s[i].x;
+            m[1] *= d.s[i].y;
+            m[2] *= d.s[i].z;
+            m[3] = glm::vec4{ d.t[i], 1.0f };
+            d.ref[i] = m;
+        }
+    }) };
+    const auto composeRef{ d.ref };
+    const double glmInverse{ measure([&] {
+        for(size_t i = 0; i < kCount; ++i) d.ref[i] = glm::inverseTranspose(d.lhs[i]);
+    }) };
+    const auto inverseRef{ d.ref };
+    const double glmPoints{ measure([&] {
+        for(size_t i = 0; i < kCount; ++i) d.pointsRef[i] = glm::vec3{ d.lhs[0] * glm::vec4{ d.points[i], 1.0f } };
+    }) };
+    const double glmBoxes{ measure([&] {
+        for(size_t i = 0; i < kCount; ++i) {
+            const auto &box{ d.boxes[i] };
+            glm::vec3 lo{}, hi{};
+            for(int c = 0; c < 8; ++c) {
+                const glm::vec3 corner{
+                    (c & 1) ? box.max.x : box.min.x,
+                    (c & 2) ? box.max.y : box.min.y,
+                    (c & 4) ? box.max.z : box.min.z
+                };
+                const glm::vec3 w{ d.rhs[i] * glm::vec4{ corner, 1.0f } };
+                lo = 0 == c ? w : glm::min(lo, w);
+                hi = 0 == c ? w : glm::max(hi, w);
+            }
+            d.boxesRef[i] = { lo, hi };
+        }
+    }) };
+
+    std::cout << "BatchMath benchmark, " << kCount << " items, best of " << kRepeats
+              << ", detected backend: " << BatchMath::Name(BatchMath::Detect()) << '\n';
+    std::cout << std::left << std::setw(18) << "kernel" << std::setw(8) << "backend"
+              << std::right << std::setw(13) << "glm" << std::setw(13) << "batch" << std::setw(9) << "speedup" << '\n';
+
+    using BatchMath::Backend;
+    for(const auto backend : { Backend::Scalar, Backend::SSE, Backend::AVX2, Backend::NEON }) {
+        if(!BatchMath::Select(backend)) {
+            continue;
+        }
+        const char *name{ BatchMath::Name(backend) };
+        auto check = [&](const char *kernel, double glmUs, double batchUs, bool exact) {
+            report(kernel, name, glmUs, batchUs, exact);
+            allExact = allExact && exact;
+        };
+
+        double us{ measure([&] { BatchMath::Multiply(d.lhs.data(), d.rhs.data(), d.out.data(), kCount); }) };
+        check("Multiply", glmMultiply, us, sameBits(d.out, multiplyRef));
+
+        us = measure([&] { BatchMath::ComposeTRS(d.t.data(), d.r.data(), d.s.data(), d.out.data(), kCount); });
+        check("ComposeTRS", glmCompose, us, sameBits(d.out, composeRef));
+
+        us = measure([&] { BatchMath::InverseTranspose(d.lhs.data(), d.out.data(), kCount); });
+        check("InverseTranspose", glmInverse, us, sameBits(d.out, inverseRef));
+
+        us = measure([&] { BatchMath::TransformPoints(d.lhs[0], d.points.data(), d.pointsOut.data(), kCount); });
+        check("TransformPoints", glmPoints, us, sameBits(d.pointsOut, d.pointsRef));
+
+        us = measure([&] { BatchMath::TransformAABBs(d.rhs.data(), d.boxes.data(), d.boxesOut.data(), kCount); });
+        check("TransformAABBs", glmBoxes, us, sameBits(d.boxesOut, d.boxesRef));
+    }
+
+    return allExact ? 0 : 1;
+}
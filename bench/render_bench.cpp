@@ -0,0 +1,507 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "logutilites.hpp"
+#include "headless.hpp"
+#include "mash.hpp"
+#include "templates.hpp"
+#include "vertex.hpp"
+#include "shader.hpp"
+#include "texturegen.hpp"
+#include "texture.hpp"
+#include "transform.hpp"
+#include "jobsystem.hpp"
+#include "entities.hpp"
+#include "components.hpp"
+#include "commandbuffer.hpp"
+#include "glbackend.hpp"
+#include "framepipeline.hpp"
+#include "gpustats.hpp"
+#include "glcapture.hpp"
+#include "trace.hpp"
+
+/**
+ * Deterministic rendering benchmark: every preset builds a fixed scene, runs
+ * a fixed number of frames on the headless backend and reports metrics as
+ * JSON. With --baseline the results are compared against an earlier run and
+ * the exit code is 1 when something regressed, 2 when there is no baseline.
+ * GL calls are counted by the GLCapture hooks: everything the frame sends to
+ * the driver, ImGui and clears included.
+ *
+ *   render_bench [--frames N] [--size WxH] [--preset name]... [--output file.json]
+ *                [--baseline file.json] [--write-baseline file.json] [--tolerance 0.1]
+ */
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using Metrics = std::map<std::string, double>;
+    using Results = std::map<std::string, Metrics>;
+
+    struct Preset {
+        const char *name;
+        const char *description;
+        size_t quads;
+        size_t textures;       ///< textures the quads cycle through, rotated through the sampled units
+        int uiWindows;
+        int widgetsPerWindow;
+        int logsPerFrame;
+    };
+
+    const Preset kPresets[]{
+        { "instanced", "10k quads sharing one template mesh under a rotating root", 10000, 2, 0, 0, 0 },
+        { "textures", "30 decoded and uploaded textures, 1k quads rebinding them on the sampled units", 1000, 30, 0, 0, 0 },
+        { "ui", "40 ImGui windows with 25 widgets each over a small scene", 16, 2, 40, 25, 0 },
+        { "logspam", "200 log records per frame into the ImGui log window", 16, 2, 0, 0, 200 },
+    };
+
+    /// fs.glsl picks sample_0 or sample_1 by texId, so only these units are ever sampled
+    constexpr int kSampledUnits{ 2 };
+
+    struct Options {
+        uint64_t frames{ 300 };
+        glm::ivec2 size{ 1280, 720 };
+        std::vector<std::string> presets;
+        std::string output{ "bench.json" };
+        std::string baseline;
+        std::string writeBaseline;
+        double tolerance{ 0.10 };
+    };
+
+    //================================ HELPERS ==================================//
+
+    double elapsedMs(Clock::time_point from) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+    }
+
+    /// VmRSS/VmHWM from /proc/self/status in bytes, 0 where unavailable.
+    double memoryStatus(const char *key) {
+        std::ifstream status{ "/proc/self/status" };
+        std::string line;
+        const size_t length{ std::strlen(key) };
+        while(std::getline(status, line)) {
+            if(0 == line.compare(0, length, key) && ':' == line[length]) {
+                return std::stod(line.substr(length + 1)) * 1024.0;
+            }
+        }
+        return 0.0;
+    }
+
+    /// Just enough JSON for the files this tool writes: nested objects of numbers.
+    class JsonReader {
+    public:
+        explicit JsonReader(std::string text) : mText{ std::move(text) } {}
+
+        bool ReadResults(Results &results) {
+            bool ok{ Object([&](const std::string &key) {
+                if("presets" != key) {
+                    return Skip();
+                }
+                return Object([&](const std::string &preset) {
+                    return Object([&](const std::string &metric) {
+                        double value{ 0.0 };
+                        if(!Number(value)) {
+                            return Skip();
+                        }
+                        results[preset][metric] = value;
+                        return true;
+                    });
+                });
+            }) };
+            return ok;
+        }
+
+    private:
+        std::string mText;
+        size_t mAt{ 0 };
+
+        void Space() {
+            while(mAt < mText.size() && std::isspace(static_cast<unsigned char>(mText[mAt]))) {
+                ++mAt;
+            }
+        }
+        bool Consume(char c) {
+            Space();
+            if(mAt < mText.size() && c == mText[mAt]) {
+                ++mAt;
+                return true;
+            }
+            return false;
+        }
+        bool String(std::string &out) {
+            if(!Consume('"')) {
+                return false;
+            }
+            out.clear();
+            while(mAt < mText.size() && '"' != mText[mAt]) {
+                if('\\' == mText[mAt] && mAt + 1 < mText.size()) {
+                    ++mAt;
+                }
+                out.push_back(mText[mAt++]);
+            }
+            return Consume('"');
+        }
+        bool Number(double &out) {
+            Space();
+            const char *begin{ mText.c_str() + mAt };
+            char *end{ nullptr };
+            out = std::strtod(begin, &end);
+            if(end == begin) {
+                return false;
+            }
+            mAt += static_cast<size_t>(end - begin);
+            return true;
+        }
+        template<class Fn>
+        bool Object(Fn &&member) {
+            if(!Consume('{')) {
+                return false;
+            }
+            if(Consume('}')) {
+                return true;
+            }
+            do {
+                std::string key;
+                if(!String(key) || !Consume(':') || !member(key)) {
+                    return false;
+                }
+            } while(Consume(','));
+            return Consume('}');
+        }
+        bool Skip() {
+            Space();
+            if(mAt >= mText.size()) {
+                return false;
+            }
+            std::string text;
+            double number{ 0.0 };
+            switch(mText[mAt]) {
+                case '"':
+                    return String(text);
+                case '{':
+                    return Object([this](const std::string &) { return Skip(); });
+                case '[':
+                    ++mAt;
+                    if(Consume(']')) {
+                        return true;
+                    }
+                    do {
+                        if(!Skip()) {
+                            return false;
+                        }
+                    } while(Consume(','));
+                    return Consume(']');
+                case 't': mAt += 4; return true;
+                case 'f': mAt += 5; return true;
+                case 'n': mAt += 4; return true;
+                default:
+                    return Number(number);
+            }
+        }
+    };
+
+    void writeResults(std::ostream &out, const Options &options, const std::string &renderer, const Results &results) {
+        out << std::fixed << std::setprecision(4);
+        out << "{\n  \"frames\": " << options.frames << ",\n  \"size\": \"" << options.size.x << "x" << options.size.y
+            << "\",\n  \"renderer\": ";
+        Trace::WriteJsonString(out, renderer.c_str());
+        out << ",\n  \"presets\": {";
+        bool firstPreset{ true };
+        for(const auto &[preset, metrics] : results) {
+            out << (firstPreset ? "\n" : ",\n") << "    \"" << preset << "\": {";
+            firstPreset = false;
+            bool firstMetric{ true };
+            for(const auto &[metric, value] : metrics) {
+                out << (firstMetric ? "\n" : ",\n") << "      \"" << metric << "\": " << value;
+                firstMetric = false;
+            }
+            out << "\n    }";
+        }
+        out << "\n  }\n}\n";
+    }
+
+    /// Counts are deterministic and may not grow at all; timings and memory get the tolerance.
+    bool exact(const std::string &metric) {
+        return "draws_per_frame" == metric || "gl_calls_per_frame" == metric || "upload_bytes" == metric;
+    }
+
+    bool compare(const Results &baseline, const Results &current, double tolerance) {
+        bool regressed{ false };
+        std::printf("\n%-10s %-20s %14s %14s %9s\n", "preset", "metric", "baseline", "current", "change");
+        for(const auto &[preset, metrics] : current) {
+            const auto stored{ baseline.find(preset) };
+            if(baseline.end() == stored) {
+                std::printf("%-10s (not in baseline)\n", preset.c_str());
+                continue;
+            }
+            for(const auto &[metric, value] : metrics) {
+                const auto before{ stored->second.find(metric) };
+                if(stored->second.end() == before) {
+                    continue;
+                }
+                const double reference{ before->second };
+                const double change{ reference > 0.0 ? (value - reference) / reference : 0.0 };
+                const bool worse{ exact(metric) ? value > reference : change > tolerance };
+                regressed = regressed || worse;
+                std::printf("%-10s %-20s %14.4f %14.4f %+8.1f%% %s\n", preset.c_str(), metric.c_str(),
+                    reference, value, change * 100.0, worse ? "REGRESSION" : "");
+            }
+        }
+        return !regressed;
+    }
+
+    Options parseOptions(int argc, char **argv) {
+        Options options;
+        for(int i = 1; i < argc; ++i) {
+            const std::string arg{ argv[i] };
+            const bool hasValue{ i + 1 < argc };
+            if("--frames" == arg && hasValue) {
+                options.frames = std::max<uint64_t>(1, std::stoull(argv[++i]));
+            } else if("--size" == arg && hasValue) {
+                std::sscanf(argv[++i], "%dx%d", &options.size.x, &options.size.y);
+            } else if("--preset" == arg && hasValue) {
+                options.presets.push_back(argv[++i]);
+            } else if("--output" == arg && hasValue) {
+                options.output = argv[++i];
+            } else if("--baseline" == arg && hasValue) {
+                options.baseline = argv[++i];
+            } else if("--write-baseline" == arg && hasValue) {
+                options.writeBaseline = argv[++i];
+            } else if("--tolerance" == arg && hasValue) {
+                options.tolerance = std::stod(argv[++i]);
+            } else {
+                std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            }
+        }
+        return options;
+    }
+
+    //================================= SCENE ===================================//
+
+    struct Shared {
+        HeadlessWindow *window;
+        Shader::Ref shader;
+        std::unique_ptr<Mash> quad;
+        std::vector<Texture::Ref> textures;
+    };
+
+    void drawUi(const Preset &preset, uint64_t frame) {
+        char title[32];
+        for(int w = 0; w < preset.uiWindows; ++w) {
+            std::snprintf(title, sizeof(title), "Bench %d", w);
+            ImGui::Begin(title);
+            for(int i = 0; i < preset.widgetsPerWindow; ++i) {
+                float value{ static_cast<float>((frame + i) % 100) / 100.0f };
+                ImGui::PushID(i);
+                switch(i % 4) {
+                    case 0: ImGui::Text("Row %d: %.3f", i, value); break;
+                    case 1: ImGui::SliderFloat("slider", &value, 0.0f, 1.0f); break;
+                    case 2: ImGui::Button("button"); break;
+                    case 3: ImGui::Separator(); break;
+                }
+                ImGui::PopID();
+            }
+            ImGui::End();
+        }
+    }
+
+    Metrics run(const Preset &preset, Shared &shared, uint64_t frames) {
+        const size_t uploadedBefore{ GpuStats::Uploaded() };
+        const auto setupStart{ Clock::now() };
+
+        // extra textures are decoded and uploaded as part of the setup cost
+        std::vector<Texture *> textures;
+        for(const auto &texture : shared.textures) {
+            textures.push_back(texture.get());
+        }
+        std::vector<Texture::Ref> extra;
+        if(preset.textures > textures.size()) {
+            std::vector<std::string> files;
+            for(size_t i = textures.size(); i < preset.textures; ++i) {
+                files.push_back(0 == i % 2 ? "resources/textures/texture_0.jpeg" : "resources/textures/texture_1.png");
+            }
+            shared.shader->Use();
+            extra = TextureGenerator::Gen(files, shared.shader);
+            for(const auto &texture : extra) {
+                if(nullptr != texture) {
+                    textures.push_back(texture.get());
+                }
+            }
+        }
+
+        TransformHierarchy transforms{ preset.quads + 1 };
+        const auto root{ transforms.Create() };
+        EntityRegistry scene;
+        scene.Reserve(preset.quads);
+        const size_t columns{ std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(preset.quads))))) };
+        const float cell{ 2.0f / columns };
+        for(size_t i = 0; i < preset.quads; ++i) {
+            const auto node{ transforms.Create(root) };
+            transforms.SetPosition(node, glm::vec3{ -1.0f + cell * (0.5f + i % columns), -1.0f + cell * (0.5f + i / columns), 0.0f });
+            transforms.SetScale(node, glm::vec3{ cell * 0.1f, cell * 0.1f, 1.0f });
+            // neighbours alternate units and walk the textures, so every draw rebinds a sampled unit
+            scene.Create(
+                TransformComponent{ node },
+                MeshComponent{ shared.quad.get() },
+                TextureComponent{ textures[i % textures.size()], static_cast<int>(i % kSampledUnits) }
+            );
+        }
+        const double setup{ elapsedMs(setupStart) };
+
+        GLBackend backend;
+        uint64_t calls{ 0 };
+        size_t draws{ 0 };
+        uint64_t frameIndex{ 0 };
+        auto prepare = [&](FrameData &) {
+            shared.window->poll_events();
+            shared.window->new_frame();
+        };
+        auto simulate = [&](FrameData &frame) {
+            ImGui::NewFrame();
+            drawUi(preset, frame.index);
+            for(int i = 0; i < preset.logsPerFrame; ++i) {
+                LOGI << "[Bench] frame " << frame.index << " record " << i;
+            }
+            if(preset.logsPerFrame > 0) {
+                // the writer thread formats them; wait so every frame draws the same log
+                Utilites::LogHelper::Instance()->Flush();
+                Utilites::LogHelper::Instance()->Visualizer()->Draw();
+            }
+
+            transforms.SetRotation(root, glm::angleAxis(0.01f * frame.index, glm::vec3{ 0, 0, 1 }));
+            transforms.Update();
+
+            frame.clearColor = glm::vec4{ .3f, .2f, .4f, 1.0f };
+            frame.commands.resize(scene.Chunks<TransformComponent, MeshComponent, TextureComponent>());
+            for(auto &buffer : frame.commands) {
+                buffer.Reset();
+            }
+            scene.ParallelChunks<TransformComponent, MeshComponent, TextureComponent>(
+                [&](size_t chunk, Entity, TransformComponent &transform, MeshComponent &mesh, TextureComponent &texture) {
+                    auto &buffer{ frame.commands[chunk] };
+                    buffer.BindShader(shared.shader.get());
+                    ObjectBlock object;
+                    object.transform = transforms.World(transform.node);
+                    object.mixValue = 0.8f;
+                    object.texId = texture.unit;
+                    buffer.SetObject(object);
+                    buffer.BindTexture(texture.texture, static_cast<uint32_t>(texture.unit));
+                    buffer.Draw(mesh.mash);
+                });
+
+            ImGui::Render();
+            frame.ui.Capture(ImGui::GetDrawData());
+        };
+        auto submit = [&](FrameData &frame) {
+            shared.window->clear(frame.clearColor);
+            backend.Begin(frame.uniforms);
+            for(const auto &buffer : frame.commands) {
+                backend.Execute(buffer);
+            }
+            backend.End();
+            draws += backend.GetStats().draws;
+            if(auto *data{ frame.ui.Data() }) {
+                ImGui_ImplOpenGL3_RenderDrawData(data);
+            }
+            shared.window->update();
+            GLCapture::Instance()->EndFrame();
+            for(const auto &call : GLCapture::Instance()->LastFrame()) {
+                calls += call.calls;
+            }
+            ++frameIndex;
+        };
+
+        // the setup's calls are not part of any frame
+        GLCapture::Instance()->EndFrame();
+        shared.window->restart(frames);
+        {
+            FramePipeline pipeline{ prepare, simulate, submit };
+            while(shared.window->isActive()) {
+                pipeline.Frame();
+            }
+            pipeline.Flush();
+        }
+
+        const auto report{ shared.window->report() };
+        Metrics metrics;
+        metrics["setup_ms"] = setup;
+        metrics["frame_ms_avg"] = report.average;
+        metrics["frame_ms_p99"] = report.p99;
+        metrics["frame_ms_max"] = report.max;
+        metrics["gl_calls_per_frame"] = frameIndex > 0 ? static_cast<double>(calls) / frameIndex : 0.0;
+        metrics["draws_per_frame"] = frameIndex > 0 ? static_cast<double>(draws) / frameIndex : 0.0;
+        metrics["upload_bytes"] = static_cast<double>(GpuStats::Uploaded() - uploadedBefore);
+        metrics["rss_bytes"] = memoryStatus("VmRSS");
+        metrics["peak_rss_bytes"] = memoryStatus("VmHWM");
+        return metrics;
+    }
+}
+
+int main(int argc, char **argv) {
+    const Options options{ parseOptions(argc, argv) };
+    Utilites::LogHelper::Instance()->Initialize(plog::info);
+    JobSystem::Instance()->Initialize();
+
+    HeadlessWindow window{ options.size, options.frames };
+    if(!window.isActive()) {
+        std::fprintf(stderr, "Cannot create the headless context\n");
+        return 2;
+    }
+    const std::string renderer{ reinterpret_cast<const char *>(glGetString(GL_RENDERER)) };
+    if(!GLCapture::Instance()->Install()) {
+        std::fprintf(stderr, "Cannot install the GL call hooks\n");
+        return 2;
+    }
+
+    Shared shared{ &window, std::make_shared<Shader>("resources/shaders/vs.glsl", "resources/shaders/fs.glsl") };
+    if(!shared.shader->Valide()) {
+        std::fprintf(stderr, "Cannot create shader: %s\n", shared.shader->GetLastError()->what.c_str());
+        return 3;
+    }
+    const auto square{ TemplateGenerator::Generate(TemplateType::SQUARE, 5) };
+    shared.quad = std::make_unique<Mash>(square.first, square.second, shared.shader);
+    shared.shader->Use();
+    shared.textures = TextureGenerator::Gen(std::vector<std::string>{
+        "resources/textures/texture_0.jpeg",
+        "resources/textures/texture_1.png"
+    }, shared.shader);
+
+    Results results;
+    for(const auto &preset : kPresets) {
+        const bool selected{ options.presets.empty() ||
+            options.presets.end() != std::find(options.presets.begin(), options.presets.end(), preset.name) };
+        if(!selected) {
+            continue;
+        }
+        std::fprintf(stderr, "[%s] %s\n", preset.name, preset.description);
+        results[preset.name] = run(preset, shared, options.frames);
+    }
+
+    std::ofstream output{ options.output };
+    writeResults(output, options, renderer, results);
+    std::printf("Results written to %s\n", options.output.c_str());
+    if(!options.writeBaseline.empty()) {
+        std::ofstream baseline{ options.writeBaseline };
+        writeResults(baseline, options, renderer, results);
+        std::printf("Baseline written to %s\n", options.writeBaseline.c_str());
+    }
+
+    if(options.baseline.empty()) {
+        return 0;
+    }
+    std::ifstream stored{ options.baseline };
+    if(!stored) {
+        std::fprintf(stderr, "No baseline at %s, run with --write-baseline to create one\n", options.baseline.c_str());
+        return 2;
+    }
+    std::stringstream text;
+    text << stored.rdbuf();
+    Results baseline;
+    if(!JsonReader{ text.str() }.ReadResults(baseline)) {
+        std::fprintf(stderr, "Cannot parse baseline %s\n", options.baseline.c_str());
+        return 2;
+    }
+    return compare(baseline, results, options.tolerance) ? 0 : 1;
+}
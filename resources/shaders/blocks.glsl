@@ -0,0 +1,14 @@
+// std140 blocks shared by every program, mirrored by uniformblocks.hpp.
+// Included after #version; the blocks must match across the stages.
+
+layout (std140) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    float time;
+};
+
+layout (std140) uniform Object {
+    mat4 transform;
+    float mix_value;
+    int texId;
+};
@@ -1,11 +1,14 @@
 #version 330 core
 
+// Variants (see ShaderVariants):
+//   TEXTURE_SAMPLER s  sample s only, instead of picking one by texId
+//   TEXTURE_ONLY       the texture without the vertex color (mix_value 1)
+//   COLOR_ONLY         the vertex color without a texture (mix_value 0)
+
 in vec4 FragColor;
 in vec2 TexCoord;
 
-uniform float mix_value;
-
-uniform int texId = 0;
+#include "blocks.glsl"
 
 uniform sampler2D sample_0;
 uniform sampler2D sample_1;
@@ -13,6 +16,12 @@ uniform sampler2D sample_1;
 out vec4 ResultColor;
 
 void main() {
+#if defined(COLOR_ONLY)
+    ResultColor = FragColor;
+#else
+  #if defined(TEXTURE_SAMPLER)
+    vec4 activeTexture = texture(TEXTURE_SAMPLER, TexCoord);
+  #else
     vec4 activeTexture;
     switch(texId) {
         case 0:
@@ -22,5 +31,11 @@ void main() {
             activeTexture = texture(sample_1, TexCoord);
             break;
     }
+  #endif
+  #if defined(TEXTURE_ONLY)
+    ResultColor = activeTexture;
+  #else
     ResultColor = mix(FragColor, activeTexture, mix_value);
+  #endif
+#endif
 }
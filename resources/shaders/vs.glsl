@@ -7,10 +7,10 @@ layout (location = 2) in vec2 texCoord;
 out vec4 FragColor;
 out vec2 TexCoord;
 
-uniform mat4 transform;
+#include "blocks.glsl"
 
 void main() {
-    gl_Position = transform * vec4(position, 1.0);
+    gl_Position = projection * view * transform * vec4(position, 1.0);
     FragColor = color;
     TexCoord = texCoord;
 }
@@ -0,0 +1,759 @@
+// the hook pointers are defined here, so the gl* names stay the driver's
+#define GLHOOKS_IMPLEMENTATION
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#include <unordered_map>
+
+#include "glcapture.hpp"
+
+#define GLHOOKS_DEFINE(name) decltype(&::gl##name) glhook##name{ &::gl##name };
+GLHOOKS_GL11(GLHOOKS_DEFINE)
+#undef GLHOOKS_DEFINE
+
+namespace {
+    using GLStream::Call;
+
+    constexpr size_t kFlushBytes{ 4 << 20 };
+    constexpr size_t kUnits{ 32 };
+    constexpr GLuint kUnknown{ std::numeric_limits<GLuint>::max() };
+
+    struct Real {
+#define GLCAPTURE_GLEW_SLOT(name) decltype(__glew##name) name{ nullptr };
+        GLSTREAM_GLEW_CALLS(GLCAPTURE_GLEW_SLOT)
+#undef GLCAPTURE_GLEW_SLOT
+#define GLCAPTURE_GL11_SLOT(name) decltype(glhook##name) name{ nullptr };
+        GLHOOKS_GL11(GLCAPTURE_GL11_SLOT)
+#undef GLCAPTURE_GL11_SLOT
+    };
+
+    /// Bindings as the hooks last saw them, kUnknown until first set.
+    struct Shadow {
+        GLuint program;
+        GLuint vertexArray;
+        GLuint arrayBuffer;
+        GLuint drawFramebuffer;
+        GLuint readFramebuffer;
+        GLuint renderbuffer;
+        GLuint activeUnit;
+        std::array<GLuint, kUnits> textures;
+        std::array<GLuint, kUnits> samplers;
+        std::unordered_map<GLenum, bool> caps;
+        GLint unpackAlignment;
+        GLint unpackRowLength;
+
+        void Reset() {
+            program = vertexArray = arrayBuffer = kUnknown;
+            drawFramebuffer = readFramebuffer = renderbuffer = activeUnit = kUnknown;
+            textures.fill(kUnknown);
+            samplers.fill(kUnknown);
+            caps.clear();
+            unpackAlignment = 4;
+            unpackRowLength = 0;
+        }
+    };
+
+    struct State {
+        Real real;
+        Shadow shadow;
+        GLCapture::Stats counts{};
+        GLStream::Writer writer;
+        std::ofstream file;
+        std::string path;
+        uint64_t frames{ 0 };
+        bool capturing{ false };
+    } gState;
+
+    Real &gReal{ gState.real };
+
+    void flush() {
+        const auto &bytes{ gState.writer.Bytes() };
+        gState.file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        gState.writer.Clear();
+    }
+
+    /// Counts the call and returns the writer for its arguments while capturing.
+    GLStream::Writer *begin(Call call, bool redundant) {
+        auto &stats{ gState.counts[static_cast<size_t>(call)] };
+        ++stats.calls;
+        stats.redundant += redundant ? 1 : 0;
+        if(!gState.capturing) {
+            return nullptr;
+        }
+        if(gState.writer.Bytes().size() > kFlushBytes) {
+            flush();
+        }
+        gState.writer.Begin(call, redundant);
+        return &gState.writer;
+    }
+
+    template<class... Args>
+    void record(Call call, bool redundant, Args... args) {
+        if(auto *out{ begin(call, redundant) }) {
+            (out->Put(args), ...);
+        }
+    }
+
+    void names(GLStream::Writer *out, GLsizei n, const GLuint *values) {
+        out->Put(n);
+        for(GLsizei i = 0; i < n; ++i) {
+            out->Put(values[i]);
+        }
+    }
+
+    bool same(GLuint &slot, GLuint value) {
+        const bool redundant{ slot == value };
+        slot = value;
+        return redundant;
+    }
+
+    bool toggle(GLenum cap, bool enabled) {
+        auto [it, inserted]{ gState.shadow.caps.try_emplace(cap, enabled) };
+        const bool redundant{ !inserted && it->second == enabled };
+        it->second = enabled;
+        return redundant;
+    }
+
+    namespace hooks {
+        //=============================== GLEW ===============================//
+
+        void GLAPIENTRY ActiveTexture(GLenum texture) {
+            record(Call::ActiveTexture, same(gState.shadow.activeUnit, texture - GL_TEXTURE0), texture);
+            gReal.ActiveTexture(texture);
+        }
+        void GLAPIENTRY AttachShader(GLuint program, GLuint shader) {
+            record(Call::AttachShader, false, program, shader);
+            gReal.AttachShader(program, shader);
+        }
+        void GLAPIENTRY BindBuffer(GLenum target, GLuint buffer) {
+            // the element array binding is VAO state, only the array binding is tracked
+            record(Call::BindBuffer, GL_ARRAY_BUFFER == target && same(gState.shadow.arrayBuffer, buffer), target, buffer);
+            gReal.BindBuffer(target, buffer);
+        }
+        void GLAPIENTRY BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+            record(Call::BindBufferRange, false, target, index, buffer, offset, size);
+            gReal.BindBufferRange(target, index, buffer, offset, size);
+        }
+        void GLAPIENTRY BindFramebuffer(GLenum target, GLuint framebuffer) {
+            auto &shadow{ gState.shadow };
+            bool redundant{ false };
+            if(GL_FRAMEBUFFER == target) {
+                redundant = framebuffer == shadow.drawFramebuffer && framebuffer == shadow.readFramebuffer;
+                shadow.drawFramebuffer = shadow.readFramebuffer = framebuffer;
+            } else if(GL_DRAW_FRAMEBUFFER == target) {
+                redundant = same(shadow.drawFramebuffer, framebuffer);
+            } else if(GL_READ_FRAMEBUFFER == target) {
+                redundant = same(shadow.readFramebuffer, framebuffer);
+            }
+            record(Call::BindFramebuffer, redundant, target, framebuffer);
+            gReal.BindFramebuffer(target, framebuffer);
+        }
+        void GLAPIENTRY BindRenderbuffer(GLenum target, GLuint renderbuffer) {
+            record(Call::BindRenderbuffer, same(gState.shadow.renderbuffer, renderbuffer), target, renderbuffer);
+            gReal.BindRenderbuffer(target, renderbuffer);
+        }
+        void GLAPIENTRY BindSampler(GLuint unit, GLuint sampler) {
+            record(Call::BindSampler, unit < kUnits && same(gState.shadow.samplers[unit], sampler), unit, sampler);
+            gReal.BindSampler(unit, sampler);
+        }
+        void GLAPIENTRY BindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride) {
+            record(Call::BindVertexBuffer, false, bindingindex, buffer, offset, stride);
+            gReal.BindVertexBuffer(bindingindex, buffer, offset, stride);
+        }
+        void GLAPIENTRY BindVertexArray(GLuint array) {
+            record(Call::BindVertexArray, same(gState.shadow.vertexArray, array), array);
+            gReal.BindVertexArray(array);
+        }
+        void GLAPIENTRY BlendEquation(GLenum mode) {
+            record(Call::BlendEquation, false, mode);
+            gReal.BlendEquation(mode);
+        }
+        void GLAPIENTRY BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha) {
+            record(Call::BlendEquationSeparate, false, modeRGB, modeAlpha);
+            gReal.BlendEquationSeparate(modeRGB, modeAlpha);
+        }
+        void GLAPIENTRY BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+            record(Call::BlendFuncSeparate, false, srcRGB, dstRGB, srcAlpha, dstAlpha);
+            gReal.BlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+        }
+        void GLAPIENTRY BufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+            if(auto *out{ begin(Call::BufferData, false) }) {
+                out->Put(target);
+                out->Put(size);
+                out->Put(nullptr != data);
+                out->Blob(data, nullptr != data ? static_cast<size_t>(size) : 0);
+                out->Put(usage);
+            }
+            gReal.BufferData(target, size, data, usage);
+        }
+        void GLAPIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+            if(auto *out{ begin(Call::BufferSubData, false) }) {
+                out->Put(target);
+                out->Put(offset);
+                out->Blob(data, static_cast<size_t>(size));
+            }
+            gReal.BufferSubData(target, offset, size, data);
+        }
+        GLenum GLAPIENTRY CheckFramebufferStatus(GLenum target) {
+            begin(Call::CheckFramebufferStatus, false);
+            return gReal.CheckFramebufferStatus(target);
+        }
+        GLenum GLAPIENTRY ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+            record(Call::ClientWaitSync, false, reinterpret_cast<uintptr_t>(sync), flags, timeout);
+            return gReal.ClientWaitSync(sync, flags, timeout);
+        }
+        void GLAPIENTRY ClipControl(GLenum origin, GLenum depth) {
+            record(Call::ClipControl, false, origin, depth);
+            gReal.ClipControl(origin, depth);
+        }
+        void GLAPIENTRY CompileShader(GLuint shader) {
+            record(Call::CompileShader, false, shader);
+            gReal.CompileShader(shader);
+        }
+        GLuint GLAPIENTRY CreateProgram() {
+            const GLuint program{ gReal.CreateProgram() };
+            record(Call::CreateProgram, false, program);
+            return program;
+        }
+        GLuint GLAPIENTRY CreateShader(GLenum type) {
+            const GLuint shader{ gReal.CreateShader(type) };
+            record(Call::CreateShader, false, type, shader);
+            return shader;
+        }
+        void GLAPIENTRY DeleteBuffers(GLsizei n, const GLuint *buffers) {
+            if(auto *out{ begin(Call::DeleteBuffers, false) }) {
+                names(out, n, buffers);
+            }
+            gState.shadow.arrayBuffer = kUnknown;
+            gReal.DeleteBuffers(n, buffers);
+        }
+        void GLAPIENTRY DeleteFramebuffers(GLsizei n, const GLuint *framebuffers) {
+            if(auto *out{ begin(Call::DeleteFramebuffers, false) }) {
+                names(out, n, framebuffers);
+            }
+            gState.shadow.drawFramebuffer = gState.shadow.readFramebuffer = kUnknown;
+            gReal.DeleteFramebuffers(n, framebuffers);
+        }
+        void GLAPIENTRY DeleteProgram(GLuint program) {
+            record(Call::DeleteProgram, false, program);
+            gReal.DeleteProgram(program);
+        }
+        void GLAPIENTRY DeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers) {
+            if(auto *out{ begin(Call::DeleteRenderbuffers, false) }) {
+                names(out, n, renderbuffers);
+            }
+            gState.shadow.renderbuffer = kUnknown;
+            gReal.DeleteRenderbuffers(n, renderbuffers);
+        }
+        void GLAPIENTRY DeleteShader(GLuint shader) {
+            record(Call::DeleteShader, false, shader);
+            gReal.DeleteShader(shader);
+        }
+        void GLAPIENTRY DeleteSync(GLsync sync) {
+            record(Call::DeleteSync, false, reinterpret_cast<uintptr_t>(sync));
+            gReal.DeleteSync(sync);
+        }
+        void GLAPIENTRY DeleteVertexArrays(GLsizei n, const GLuint *arrays) {
+            if(auto *out{ begin(Call::DeleteVertexArrays, false) }) {
+                names(out, n, arrays);
+            }
+            gState.shadow.vertexArray = kUnknown;
+            gReal.DeleteVertexArrays(n, arrays);
+        }
+        void GLAPIENTRY DetachShader(GLuint program, GLuint shader) {
+            record(Call::DetachShader, false, program, shader);
+            gReal.DetachShader(program, shader);
+        }
+        void GLAPIENTRY DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint basevertex) {
+            if(auto *out{ begin(Call::DrawElementsBaseVertex, false) }) {
+                out->Put(mode);
+                out->Put(count);
+                out->Put(type);
+                out->Offset(indices);
+                out->Put(basevertex);
+            }
+            gReal.DrawElementsBaseVertex(mode, count, type, indices, basevertex);
+        }
+        void GLAPIENTRY EnableVertexAttribArray(GLuint index) {
+            record(Call::EnableVertexAttribArray, false, index);
+            gReal.EnableVertexAttribArray(index);
+        }
+        GLsync GLAPIENTRY FenceSync(GLenum condition, GLbitfield flags) {
+            const GLsync sync{ gReal.FenceSync(condition, flags) };
+            record(Call::FenceSync, false, condition, flags, reinterpret_cast<uintptr_t>(sync));
+            return sync;
+        }
+        void GLAPIENTRY FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) {
+            record(Call::FramebufferRenderbuffer, false, target, attachment, renderbuffertarget, renderbuffer);
+            gReal.FramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+        }
+        void GLAPIENTRY GenBuffers(GLsizei n, GLuint *buffers) {
+            gReal.GenBuffers(n, buffers);
+            if(auto *out{ begin(Call::GenBuffers, false) }) {
+                names(out, n, buffers);
+            }
+        }
+        void GLAPIENTRY GenFramebuffers(GLsizei n, GLuint *framebuffers) {
+            gReal.GenFramebuffers(n, framebuffers);
+            if(auto *out{ begin(Call::GenFramebuffers, false) }) {
+                names(out, n, framebuffers);
+            }
+        }
+        void GLAPIENTRY GenQueries(GLsizei n, GLuint *ids) {
+            gReal.GenQueries(n, ids);
+            if(auto *out{ begin(Call::GenQueries, false) }) {
+                names(out, n, ids);
+            }
+        }
+        void GLAPIENTRY GenRenderbuffers(GLsizei n, GLuint *renderbuffers) {
+            gReal.GenRenderbuffers(n, renderbuffers);
+            if(auto *out{ begin(Call::GenRenderbuffers, false) }) {
+                names(out, n, renderbuffers);
+            }
+        }
+        void GLAPIENTRY GenVertexArrays(GLsizei n, GLuint *arrays) {
+            gReal.GenVertexArrays(n, arrays);
+            if(auto *out{ begin(Call::GenVertexArrays, false) }) {
+                names(out, n, arrays);
+            }
+        }
+        void GLAPIENTRY GenerateMipmap(GLenum target) {
+            record(Call::GenerateMipmap, false, target);
+            gReal.GenerateMipmap(target);
+        }
+        void GLAPIENTRY GetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name) {
+            begin(Call::GetActiveAttrib, false);
+            gReal.GetActiveAttrib(program, index, bufSize, length, size, type, name);
+        }
+        void GLAPIENTRY GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name) {
+            begin(Call::GetActiveUniform, false);
+            gReal.GetActiveUniform(program, index, bufSize, length, size, type, name);
+        }
+        GLint GLAPIENTRY GetAttribLocation(GLuint program, const GLchar *name) {
+            begin(Call::GetAttribLocation, false);
+            return gReal.GetAttribLocation(program, name);
+        }
+        void GLAPIENTRY GetInteger64v(GLenum pname, GLint64 *data) {
+            begin(Call::GetInteger64v, false);
+            gReal.GetInteger64v(pname, data);
+        }
+        void GLAPIENTRY GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+            begin(Call::GetProgramInfoLog, false);
+            gReal.GetProgramInfoLog(program, bufSize, length, infoLog);
+        }
+        void GLAPIENTRY GetProgramiv(GLuint program, GLenum pname, GLint *params) {
+            begin(Call::GetProgramiv, false);
+            gReal.GetProgramiv(program, pname, params);
+        }
+        void GLAPIENTRY GetQueryObjectiv(GLuint id, GLenum pname, GLint *params) {
+            begin(Call::GetQueryObjectiv, false);
+            gReal.GetQueryObjectiv(id, pname, params);
+        }
+        void GLAPIENTRY GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64 *params) {
+            begin(Call::GetQueryObjectui64v, false);
+            gReal.GetQueryObjectui64v(id, pname, params);
+        }
+        void GLAPIENTRY GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
+            begin(Call::GetShaderInfoLog, false);
+            gReal.GetShaderInfoLog(shader, bufSize, length, infoLog);
+        }
+        void GLAPIENTRY GetShaderiv(GLuint shader, GLenum pname, GLint *params) {
+            begin(Call::GetShaderiv, false);
+            gReal.GetShaderiv(shader, pname, params);
+        }
+        GLuint GLAPIENTRY GetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName) {
+            const GLuint index{ gReal.GetUniformBlockIndex(program, uniformBlockName) };
+            if(auto *out{ begin(Call::GetUniformBlockIndex, false) }) {
+                out->Put(program);
+                out->Blob(uniformBlockName, std::strlen(uniformBlockName));
+                out->Put(index);
+            }
+            return index;
+        }
+        void GLAPIENTRY GetUniformfv(GLuint program, GLint location, GLfloat *params) {
+            begin(Call::GetUniformfv, false);
+            gReal.GetUniformfv(program, location, params);
+        }
+        void GLAPIENTRY GetUniformiv(GLuint program, GLint location, GLint *params) {
+            begin(Call::GetUniformiv, false);
+            gReal.GetUniformiv(program, location, params);
+        }
+        GLint GLAPIENTRY GetUniformLocation(GLuint program, const GLchar *name) {
+            const GLint location{ gReal.GetUniformLocation(program, name) };
+            if(auto *out{ begin(Call::GetUniformLocation, false) }) {
+                out->Put(program);
+                out->Blob(name, std::strlen(name));
+                out->Put(location);
+            }
+            return location;
+        }
+        void GLAPIENTRY LinkProgram(GLuint program) {
+            record(Call::LinkProgram, false, program);
+            gReal.LinkProgram(program);
+        }
+        void GLAPIENTRY MaxShaderCompilerThreadsARB(GLuint count) {
+            record(Call::MaxShaderCompilerThreadsARB, false, count);
+            gReal.MaxShaderCompilerThreadsARB(count);
+        }
+        void GLAPIENTRY MaxShaderCompilerThreadsKHR(GLuint count) {
+            record(Call::MaxShaderCompilerThreadsKHR, false, count);
+            gReal.MaxShaderCompilerThreadsKHR(count);
+        }
+        void GLAPIENTRY QueryCounter(GLuint id, GLenum target) {
+            record(Call::QueryCounter, false, id, target);
+            gReal.QueryCounter(id, target);
+        }
+        void GLAPIENTRY RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+            record(Call::RenderbufferStorage, false, target, internalformat, width, height);
+            gReal.RenderbufferStorage(target, internalformat, width, height);
+        }
+        void GLAPIENTRY ShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length) {
+            if(auto *out{ begin(Call::ShaderSource, false) }) {
+                out->Put(shader);
+                out->Put(count);
+                for(GLsizei i = 0; i < count; ++i) {
+                    const bool sized{ nullptr != length && length[i] >= 0 };
+                    out->Blob(string[i], sized ? static_cast<size_t>(length[i]) : std::strlen(string[i]));
+                }
+            }
+            gReal.ShaderSource(shader, count, string, length);
+        }
+        void GLAPIENTRY TextureParameteri(GLuint texture, GLenum pname, GLint param) {
+            record(Call::TextureParameteri, false, texture, pname, param);
+            gReal.TextureParameteri(texture, pname, param);
+        }
+        void GLAPIENTRY Uniform1f(GLint location, GLfloat v0) {
+            record(Call::Uniform1f, false, location, v0);
+            gReal.Uniform1f(location, v0);
+        }
+        void GLAPIENTRY Uniform1i(GLint location, GLint v0) {
+            record(Call::Uniform1i, false, location, v0);
+            gReal.Uniform1i(location, v0);
+        }
+        void GLAPIENTRY Uniform4fv(GLint location, GLsizei count, const GLfloat *value) {
+            if(auto *out{ begin(Call::Uniform4fv, false) }) {
+                out->Put(location);
+                out->Put(count);
+                out->Blob(value, static_cast<size_t>(count) * 4 * sizeof(GLfloat));
+            }
+            gReal.Uniform4fv(location, count, value);
+        }
+        void GLAPIENTRY UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
+            if(auto *out{ begin(Call::UniformMatrix4fv, false) }) {
+                out->Put(location);
+                out->Put(count);
+                out->Put(transpose);
+                out->Blob(value, static_cast<size_t>(count) * 16 * sizeof(GLfloat));
+            }
+            gReal.UniformMatrix4fv(location, count, transpose, value);
+        }
+        void GLAPIENTRY UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding) {
+            record(Call::UniformBlockBinding, false, program, uniformBlockIndex, uniformBlockBinding);
+            gReal.UniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
+        }
+        void GLAPIENTRY UseProgram(GLuint program) {
+            record(Call::UseProgram, same(gState.shadow.program, program), program);
+            gReal.UseProgram(program);
+        }
+        void GLAPIENTRY VertexAttribBinding(GLuint attribindex, GLuint bindingindex) {
+            record(Call::VertexAttribBinding, false, attribindex, bindingindex);
+            gReal.VertexAttribBinding(attribindex, bindingindex);
+        }
+        void GLAPIENTRY VertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset) {
+            record(Call::VertexAttribFormat, false, attribindex, size, type, normalized, relativeoffset);
+            gReal.VertexAttribFormat(attribindex, size, type, normalized, relativeoffset);
+        }
+        void GLAPIENTRY VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer) {
+            if(auto *out{ begin(Call::VertexAttribPointer, false) }) {
+                out->Put(index);
+                out->Put(size);
+                out->Put(type);
+                out->Put(normalized);
+                out->Put(stride);
+                out->Offset(pointer);
+            }
+            gReal.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+        }
+
+        //============================== GL 1.1 ==============================//
+
+        void GLAPIENTRY BindTexture(GLenum target, GLuint texture) {
+            const GLuint unit{ gState.shadow.activeUnit };
+            const bool tracked{ GL_TEXTURE_2D == target && unit < kUnits };
+            record(Call::BindTexture, tracked && same(gState.shadow.textures[unit], texture), target, texture);
+            gReal.BindTexture(target, texture);
+        }
+        void GLAPIENTRY Clear(GLbitfield mask) {
+            record(Call::Clear, false, mask);
+            gReal.Clear(mask);
+        }
+        void GLAPIENTRY ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+            record(Call::ClearColor, false, red, green, blue, alpha);
+            gReal.ClearColor(red, green, blue, alpha);
+        }
+        void GLAPIENTRY DeleteTextures(GLsizei n, const GLuint *textures) {
+            if(auto *out{ begin(Call::DeleteTextures, false) }) {
+                names(out, n, textures);
+            }
+            gState.shadow.textures.fill(kUnknown);
+            gReal.DeleteTextures(n, textures);
+        }
+        void GLAPIENTRY DepthFunc(GLenum func) {
+            record(Call::DepthFunc, false, func);
+            gReal.DepthFunc(func);
+        }
+        void GLAPIENTRY Disable(GLenum cap) {
+            record(Call::Disable, toggle(cap, false), cap);
+            gReal.Disable(cap);
+        }
+        void GLAPIENTRY DrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+            if(auto *out{ begin(Call::DrawElements, false) }) {
+                out->Put(mode);
+                out->Put(count);
+                out->Put(type);
+                out->Offset(indices);
+            }
+            gReal.DrawElements(mode, count, type, indices);
+        }
+        void GLAPIENTRY Enable(GLenum cap) {
+            record(Call::Enable, toggle(cap, true), cap);
+            gReal.Enable(cap);
+        }
+        void GLAPIENTRY Finish() {
+            begin(Call::Finish, false);
+            gReal.Finish();
+        }
+        void GLAPIENTRY GenTextures(GLsizei n, GLuint *textures) {
+            gReal.GenTextures(n, textures);
+            if(auto *out{ begin(Call::GenTextures, false) }) {
+                names(out, n, textures);
+            }
+        }
+        void GLAPIENTRY GetIntegerv(GLenum pname, GLint *data) {
+            begin(Call::GetIntegerv, false);
+            gReal.GetIntegerv(pname, data);
+        }
+        const GLubyte *GLAPIENTRY GetString(GLenum name) {
+            begin(Call::GetString, false);
+            return gReal.GetString(name);
+        }
+        GLboolean GLAPIENTRY IsEnabled(GLenum cap) {
+            begin(Call::IsEnabled, false);
+            return gReal.IsEnabled(cap);
+        }
+        void GLAPIENTRY PixelStorei(GLenum pname, GLint param) {
+            if(GL_UNPACK_ALIGNMENT == pname) {
+                gState.shadow.unpackAlignment = param;
+            } else if(GL_UNPACK_ROW_LENGTH == pname) {
+                gState.shadow.unpackRowLength = param;
+            }
+            record(Call::PixelStorei, false, pname, param);
+            gReal.PixelStorei(pname, param);
+        }
+        void GLAPIENTRY PolygonMode(GLenum face, GLenum mode) {
+            record(Call::PolygonMode, false, face, mode);
+            gReal.PolygonMode(face, mode);
+        }
+        void GLAPIENTRY ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels) {
+            begin(Call::ReadPixels, false);
+            gReal.ReadPixels(x, y, width, height, format, type, pixels);
+        }
+        void GLAPIENTRY Scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+            record(Call::Scissor, false, x, y, width, height);
+            gReal.Scissor(x, y, width, height);
+        }
+        void GLAPIENTRY TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                   GLint border, GLenum format, GLenum type, const void *pixels) {
+            if(auto *out{ begin(Call::TexImage2D, false) }) {
+                out->Put(target);
+                out->Put(level);
+                out->Put(internalformat);
+                out->Put(width);
+                out->Put(height);
+                out->Put(border);
+                out->Put(format);
+                out->Put(type);
+                out->Put(nullptr != pixels);
+                const auto &shadow{ gState.shadow };
+                out->Blob(pixels, nullptr != pixels
+                    ? GLStream::ImageSize(width, height, format, type, shadow.unpackAlignment, shadow.unpackRowLength)
+                    : 0);
+            }
+            gReal.TexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        }
+        void GLAPIENTRY TexParameteri(GLenum target, GLenum pname, GLint param) {
+            record(Call::TexParameteri, false, target, pname, param);
+            gReal.TexParameteri(target, pname, param);
+        }
+        void GLAPIENTRY Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+            record(Call::Viewport, false, x, y, width, height);
+            gReal.Viewport(x, y, width, height);
+        }
+    }
+}
+
+GLCapture *GLCapture::Instance() {
+    static GLCapture capture;
+    return &capture;
+}
+
+GLCapture::~GLCapture() {
+    Stop();
+}
+
+bool GLCapture::Install() {
+    if(mInstalled) {
+        return true;
+    }
+    // entry points the driver lacks stay null, so GLEW availability checks still hold
+#define GLCAPTURE_HOOK_GLEW(name) \
+    gReal.name = __glew##name; \
+    if(nullptr != gReal.name) { __glew##name = hooks::name; }
+    GLSTREAM_GLEW_CALLS(GLCAPTURE_HOOK_GLEW)
+#undef GLCAPTURE_HOOK_GLEW
+#define GLCAPTURE_HOOK_GL11(name) \
+    gReal.name = glhook##name; \
+    glhook##name = hooks::name;
+    GLHOOKS_GL11(GLCAPTURE_HOOK_GL11)
+#undef GLCAPTURE_HOOK_GL11
+
+    gState.shadow.Reset();
+    gState.counts = {};
+    mInstalled = true;
+    LOGI << "[GLCapture] Installed hooks for " << GLStream::CallCount - 1 << " entry points";
+    return true;
+}
+
+void GLCapture::Uninstall() {
+    if(!mInstalled) {
+        return;
+    }
+    Stop();
+#define GLCAPTURE_UNHOOK_GLEW(name) __glew##name = gReal.name;
+    GLSTREAM_GLEW_CALLS(GLCAPTURE_UNHOOK_GLEW)
+#undef GLCAPTURE_UNHOOK_GLEW
+#define GLCAPTURE_UNHOOK_GL11(name) glhook##name = gReal.name;
+    GLHOOKS_GL11(GLCAPTURE_UNHOOK_GL11)
+#undef GLCAPTURE_UNHOOK_GL11
+    mInstalled = false;
+}
+
+bool GLCapture::Installed() const {
+    return mInstalled;
+}
+
+bool GLCapture::Start(const std::string &path) {
+    if(!mInstalled) {
+        LOGE << "[GLCapture] Install the hooks before capturing";
+        return false;
+    }
+    Stop();
+    gState.file.open(path, std::ios::binary | std::ios::trunc);
+    if(!gState.file) {
+        LOGE << "[GLCapture] Cannot open '" << path << "'";
+        return false;
+    }
+    gState.file.write(GLStream::Magic, sizeof(GLStream::Magic));
+    gState.writer.Clear();
+    gState.writer.Put(GLStream::Version);
+    gState.path = path;
+    gState.frames = 0;
+    gState.capturing = true;
+    LOGI << "[GLCapture] Capturing to '" << path << "'";
+    return true;
+}
+
+void GLCapture::Stop() {
+    if(!gState.capturing) {
+        return;
+    }
+    gState.capturing = false;
+    flush();
+    gState.file.close();
+    LOGI << "[GLCapture] Saved " << gState.frames << " frames to '" << gState.path << "'";
+    gState.path.clear();
+}
+
+bool GLCapture::Capturing() const {
+    return gState.capturing;
+}
+
+void GLCapture::EndFrame() {
+    if(!mInstalled) {
+        return;
+    }
+    if(gState.capturing) {
+        gState.writer.Begin(Call::Frame, false);
+        ++gState.frames;
+        flush();
+    }
+    std::lock_guard<std::mutex> lock{ mLastLock };
+    mLast = gState.counts;
+    mLastCapture = gState.path;
+    mLastCaptured = gState.frames;
+    gState.counts = {};
+}
+
+GLCapture::Stats GLCapture::LastFrame() const {
+    std::lock_guard<std::mutex> lock{ mLastLock };
+    return mLast;
+}
+
+void GLCapture::Draw() {
+    Stats last;
+    std::string capture;
+    uint64_t captured{ 0 };
+    {
+        std::lock_guard<std::mutex> lock{ mLastLock };
+        last = mLast;
+        capture = mLastCapture;
+        captured = mLastCaptured;
+    }
+    std::vector<size_t> order;
+    CallStats total;
+    for(size_t i = 0; i < last.size(); ++i) {
+        if(last[i].calls > 0) {
+            order.push_back(i);
+            total.calls += last[i].calls;
+            total.redundant += last[i].redundant;
+        }
+    }
+    std::sort(order.begin(), order.end(), [&last](size_t a, size_t b) {
+        return last[a].calls > last[b].calls;
+    });
+
+    ImGui::Begin("GL Calls");
+    if(!mInstalled) {
+        ImGui::TextWrapped("GL call hooks are not installed");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Last frame: %llu calls, %llu redundant (%.1f%%)",
+        static_cast<unsigned long long>(total.calls), static_cast<unsigned long long>(total.redundant),
+        total.calls > 0 ? 100.0 * total.redundant / total.calls : 0.0);
+    if(capture.empty()) {
+        ImGui::TextWrapped("Not capturing (start with --gl-capture <file>)");
+    } else {
+        ImGui::TextWrapped("Capturing to %s: %llu frames", capture.c_str(), static_cast<unsigned long long>(captured));
+    }
+    if(ImGui::BeginTable("calls", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Call");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Redundant");
+        ImGui::TableSetupColumn("%");
+        ImGui::TableHeadersRow();
+        for(const size_t i : order) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(GLStream::Name(static_cast<GLStream::Call>(i)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(last[i].calls));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(last[i].redundant));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", 100.0 * last[i].redundant / last[i].calls);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
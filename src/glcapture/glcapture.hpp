@@ -0,0 +1,64 @@
+#ifndef __GLCAPTURE_H__
+#define __GLCAPTURE_H__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "glstream.hpp"
+
+/**
+ * Interception layer over the GL entry points the project uses.
+ * Install swaps GLEW's function pointers (and the GL 1.1 ones from
+ * glhooks.hpp) for hooks that count every call and flag the redundant ones:
+ * binds and enables that leave the tracked state unchanged. While a capture
+ * runs, the hooks also serialize each call with its arguments (see
+ * glstream.hpp) for GLReplay.
+ *
+ * Everything except Draw and LastFrame belongs to the GL thread. Objects
+ * created before Start are missing from the capture, so start it right
+ * after Install to get a replayable file.
+ */
+class GLCapture {
+public:
+    struct CallStats {
+        uint64_t calls{ 0 };
+        uint64_t redundant{ 0 };
+    };
+    using Stats = std::array<CallStats, GLStream::CallCount>;
+
+    static GLCapture *Instance();
+
+    /// After glewInit, with the context current.
+    bool Install();
+    void Uninstall();
+    bool Installed() const;
+
+    bool Start(const std::string &path);
+    void Stop();
+    bool Capturing() const;
+
+    /// Publishes the frame's counts and closes the frame in the capture.
+    void EndFrame();
+
+    /// Counts of the last complete frame.
+    Stats LastFrame() const;
+
+    /// ImGui window with the per-call counts and redundancy of the last frame.
+    void Draw();
+
+private:
+    std::atomic<bool> mInstalled{ false };
+
+    mutable std::mutex mLastLock;
+    Stats mLast{};
+    std::string mLastCapture;     ///< path of the running capture, empty when idle
+    uint64_t mLastCaptured{ 0 };  ///< frames written to it
+
+    GLCapture() = default;
+    ~GLCapture();
+};
+
+#endif // __GLCAPTURE_H__
@@ -0,0 +1,65 @@
+#ifndef __GLHOOKS_H__
+#define __GLHOOKS_H__
+
+#include <GL/glew.h>
+
+/**
+ * GLEW reaches every entry point newer than OpenGL 1.1 through a function
+ * pointer, which GLCapture swaps to intercept calls. The 1.1 functions are
+ * plain libGL exports, so the ones this project calls are given the same
+ * pointer indirection here; the pointers start out at the driver functions.
+ *
+ * Included by incs.hpp and, as its custom loader header, by the ImGui
+ * OpenGL backend, so both go through the hooks.
+ */
+
+#define GLHOOKS_GL11(X) \
+    X(BindTexture) \
+    X(Clear) \
+    X(ClearColor) \
+    X(DeleteTextures) \
+    X(DepthFunc) \
+    X(Disable) \
+    X(DrawElements) \
+    X(Enable) \
+    X(Finish) \
+    X(GenTextures) \
+    X(GetIntegerv) \
+    X(GetString) \
+    X(IsEnabled) \
+    X(PixelStorei) \
+    X(PolygonMode) \
+    X(ReadPixels) \
+    X(Scissor) \
+    X(TexImage2D) \
+    X(TexParameteri) \
+    X(Viewport)
+
+#define GLHOOKS_DECLARE(name) extern decltype(&::gl##name) glhook##name;
+GLHOOKS_GL11(GLHOOKS_DECLARE)
+#undef GLHOOKS_DECLARE
+
+#if !defined(GLHOOKS_IMPLEMENTATION)
+#define glBindTexture glhookBindTexture
+#define glClear glhookClear
+#define glClearColor glhookClearColor
+#define glDeleteTextures glhookDeleteTextures
+#define glDepthFunc glhookDepthFunc
+#define glDisable glhookDisable
+#define glDrawElements glhookDrawElements
+#define glEnable glhookEnable
+#define glFinish glhookFinish
+#define glGenTextures glhookGenTextures
+#define glGetIntegerv glhookGetIntegerv
+#define glGetString glhookGetString
+#define glIsEnabled glhookIsEnabled
+#define glPixelStorei glhookPixelStorei
+#define glPolygonMode glhookPolygonMode
+#define glReadPixels glhookReadPixels
+#define glScissor glhookScissor
+#define glTexImage2D glhookTexImage2D
+#define glTexParameteri glhookTexParameteri
+#define glViewport glhookViewport
+#endif
+
+#endif // __GLHOOKS_H__
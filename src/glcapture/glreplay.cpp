@@ -0,0 +1,558 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <tuple>
+
+#include "glreplay.hpp"
+
+namespace {
+    using GLStream::Call;
+
+    /// Calls without object names: reads the arguments in signature order.
+    template<class R, class... A>
+    void invoke(R (GLAPIENTRY *function)(A...), GLStream::Reader &in, bool execute) {
+        std::tuple<A...> args{ in.Get<A>()... };
+        if(execute && nullptr != function) {
+            std::apply(function, args);
+        }
+    }
+
+    std::vector<GLfloat> floats(const uint8_t *data, size_t size) {
+        std::vector<GLfloat> values(size / sizeof(GLfloat));
+        if(!values.empty()) {
+            std::memcpy(values.data(), data, values.size() * sizeof(GLfloat));
+        }
+        return values;
+    }
+}
+
+bool GLReplay::Open(const std::string &path) {
+    std::ifstream file{ path, std::ios::binary };
+    if(!file) {
+        LOGE << "[GLReplay] Cannot open '" << path << "'";
+        return false;
+    }
+    mData.assign(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+    if(mData.size() < sizeof(GLStream::Magic) || 0 != std::memcmp(mData.data(), GLStream::Magic, sizeof(GLStream::Magic))) {
+        LOGE << "[GLReplay] '" << path << "' is not a GL capture";
+        return false;
+    }
+    GLStream::Reader header{ mData.data() + sizeof(GLStream::Magic), mData.size() - sizeof(GLStream::Magic) };
+    const auto version{ header.Get<uint32_t>() };
+    if(header.Failed() || version < GLStream::MinVersion || version > GLStream::Version) {
+        LOGE << "[GLReplay] Unsupported capture version " << version;
+        return false;
+    }
+    // the version is a single varint byte
+    mBody = sizeof(GLStream::Magic) + 1;
+    LOGI << "[GLReplay] Opened '" << path << "', " << mData.size() << " bytes";
+    return true;
+}
+
+GLCapture::Stats GLReplay::Scan(uint64_t &frames) {
+    GLCapture::Stats stats{};
+    frames = 0;
+    GLStream::Reader in{ mData.data() + mBody, mData.size() - mBody };
+    Call call;
+    bool redundant{ false };
+    while(in.Next(call, redundant)) {
+        if(Call::Frame == call) {
+            ++frames;
+            continue;
+        }
+        auto &entry{ stats[static_cast<size_t>(call)] };
+        ++entry.calls;
+        entry.redundant += redundant ? 1 : 0;
+        Decode(in, call, false);
+    }
+    if(in.Failed()) {
+        LOGW << "[GLReplay] The capture is truncated";
+    }
+    return stats;
+}
+
+bool GLReplay::Run(GLuint target, const FrameCallback &onFrame) {
+    Reset();
+    mTarget = target;
+    GLStream::Reader in{ mData.data() + mBody, mData.size() - mBody };
+    Call call;
+    bool redundant{ false };
+    uint64_t frame{ 0 };
+    while(in.Next(call, redundant)) {
+        if(Call::Frame == call) {
+            onFrame(frame++);
+        } else {
+            Decode(in, call, true);
+        }
+    }
+    if(in.Failed()) {
+        LOGE << "[GLReplay] Corrupt capture after " << frame << " frames";
+        return false;
+    }
+    return true;
+}
+
+uint64_t GLReplay::Skipped() const {
+    return mSkipped;
+}
+
+void GLReplay::Reset() {
+    for(auto &names : mNames) {
+        names.clear();
+    }
+    mLocations.clear();
+    mBlocks.clear();
+    for(const auto &[captured, sync] : mSyncs) {
+        glDeleteSync(sync);
+    }
+    mSyncs.clear();
+    mProgram = 0;
+    mSkipped = 0;
+}
+
+GLuint GLReplay::Map(Namespace space, GLuint name) const {
+    if(0 == name) {
+        return Framebuffers == space ? mTarget : 0;
+    }
+    const auto &names{ mNames[space] };
+    if(const auto it{ names.find(name) }; names.end() != it) {
+        return it->second;
+    }
+    // created before the capture started
+    return Framebuffers == space ? mTarget : name;
+}
+
+GLint GLReplay::Location(GLint location) const {
+    if(location < 0) {
+        return location;
+    }
+    const auto it{ mLocations.find({ mProgram, location }) };
+    return mLocations.end() != it ? it->second : location;
+}
+
+std::vector<GLuint> GLReplay::Names(GLStream::Reader &in) const {
+    std::vector<GLuint> names(std::max<GLsizei>(0, in.Get<GLsizei>()));
+    for(auto &name : names) {
+        name = in.Get<GLuint>();
+    }
+    return names;
+}
+
+void GLReplay::Generate(Namespace space, const std::vector<GLuint> &captured, void (GLAPIENTRY *generate)(GLsizei, GLuint *)) {
+    std::vector<GLuint> created(captured.size());
+    generate(static_cast<GLsizei>(created.size()), created.data());
+    for(size_t i = 0; i < captured.size(); ++i) {
+        mNames[space][captured[i]] = created[i];
+    }
+}
+
+void GLReplay::Delete(Namespace space, const std::vector<GLuint> &captured, void (GLAPIENTRY *destroy)(GLsizei, const GLuint *)) {
+    std::vector<GLuint> names;
+    names.reserve(captured.size());
+    for(const GLuint name : captured) {
+        names.push_back(Map(space, name));
+        mNames[space].erase(name);
+    }
+    destroy(static_cast<GLsizei>(names.size()), names.data());
+}
+
+void GLReplay::Decode(GLStream::Reader &in, Call call, bool execute) {
+    switch(call) {
+        //=========================== STATE ===========================//
+        case Call::ActiveTexture: invoke(glActiveTexture, in, execute); break;
+        case Call::BlendEquation: invoke(glBlendEquation, in, execute); break;
+        case Call::BlendEquationSeparate: invoke(glBlendEquationSeparate, in, execute); break;
+        case Call::BlendFuncSeparate: invoke(glBlendFuncSeparate, in, execute); break;
+        case Call::ClipControl: invoke(glClipControl, in, execute); break;
+        case Call::Clear: invoke(glClear, in, execute); break;
+        case Call::ClearColor: invoke(glClearColor, in, execute); break;
+        case Call::DepthFunc: invoke(glDepthFunc, in, execute); break;
+        case Call::Disable: invoke(glDisable, in, execute); break;
+        case Call::Enable: invoke(glEnable, in, execute); break;
+        case Call::EnableVertexAttribArray: invoke(glEnableVertexAttribArray, in, execute); break;
+        case Call::VertexAttribBinding: invoke(glVertexAttribBinding, in, execute); break;
+        case Call::VertexAttribFormat: invoke(glVertexAttribFormat, in, execute); break;
+        case Call::Finish: invoke(glFinish, in, execute); break;
+        case Call::GenerateMipmap: invoke(glGenerateMipmap, in, execute); break;
+        case Call::MaxShaderCompilerThreadsARB: invoke(glMaxShaderCompilerThreadsARB, in, execute); break;
+        case Call::MaxShaderCompilerThreadsKHR: invoke(glMaxShaderCompilerThreadsKHR, in, execute); break;
+        case Call::PixelStorei: invoke(glPixelStorei, in, execute); break;
+        case Call::PolygonMode: invoke(glPolygonMode, in, execute); break;
+        case Call::RenderbufferStorage: invoke(glRenderbufferStorage, in, execute); break;
+        case Call::Scissor: invoke(glScissor, in, execute); break;
+        case Call::TexParameteri: invoke(glTexParameteri, in, execute); break;
+        case Call::Viewport: invoke(glViewport, in, execute); break;
+
+        //========================== QUERIES ==========================//
+        case Call::CheckFramebufferStatus:
+        case Call::GetActiveAttrib:
+        case Call::GetActiveUniform:
+        case Call::GetAttribLocation:
+        case Call::GetInteger64v:
+        case Call::GetIntegerv:
+        case Call::GetProgramInfoLog:
+        case Call::GetProgramiv:
+        case Call::GetQueryObjectiv:
+        case Call::GetQueryObjectui64v:
+        case Call::GetShaderInfoLog:
+        case Call::GetShaderiv:
+        case Call::GetString:
+        case Call::GetUniformfv:
+        case Call::GetUniformiv:
+        case Call::IsEnabled:
+        case Call::ReadPixels:
+            mSkipped += execute ? 1 : 0;
+            break;
+
+        //========================== OBJECTS ==========================//
+        case Call::GenBuffers: {
+            const auto names{ Names(in) };
+            if(execute) Generate(Buffers, names, glGenBuffers);
+            break;
+        }
+        case Call::GenFramebuffers: {
+            const auto names{ Names(in) };
+            if(execute) Generate(Framebuffers, names, glGenFramebuffers);
+            break;
+        }
+        case Call::GenQueries: {
+            const auto names{ Names(in) };
+            if(execute) Generate(Queries, names, glGenQueries);
+            break;
+        }
+        case Call::GenRenderbuffers: {
+            const auto names{ Names(in) };
+            if(execute) Generate(Renderbuffers, names, glGenRenderbuffers);
+            break;
+        }
+        case Call::GenTextures: {
+            const auto names{ Names(in) };
+            if(execute) Generate(Textures, names, glGenTextures);
+            break;
+        }
+        case Call::GenVertexArrays: {
+            const auto names{ Names(in) };
+            if(execute) Generate(VertexArrays, names, glGenVertexArrays);
+            break;
+        }
+        case Call::DeleteBuffers: {
+            const auto names{ Names(in) };
+            if(execute) Delete(Buffers, names, glDeleteBuffers);
+            break;
+        }
+        case Call::DeleteFramebuffers: {
+            const auto names{ Names(in) };
+            if(execute) Delete(Framebuffers, names, glDeleteFramebuffers);
+            break;
+        }
+        case Call::DeleteRenderbuffers: {
+            const auto names{ Names(in) };
+            if(execute) Delete(Renderbuffers, names, glDeleteRenderbuffers);
+            break;
+        }
+        case Call::DeleteTextures: {
+            const auto names{ Names(in) };
+            if(execute) Delete(Textures, names, glDeleteTextures);
+            break;
+        }
+        case Call::DeleteVertexArrays: {
+            const auto names{ Names(in) };
+            if(execute) Delete(VertexArrays, names, glDeleteVertexArrays);
+            break;
+        }
+        case Call::CreateProgram: {
+            const auto program{ in.Get<GLuint>() };
+            if(execute) mNames[Programs][program] = glCreateProgram();
+            break;
+        }
+        case Call::CreateShader: {
+            const auto type{ in.Get<GLenum>() };
+            const auto shader{ in.Get<GLuint>() };
+            if(execute) mNames[Programs][shader] = glCreateShader(type);
+            break;
+        }
+        case Call::DeleteProgram:
+        case Call::DeleteShader: {
+            const auto name{ in.Get<GLuint>() };
+            if(execute) {
+                if(Call::DeleteProgram == call) {
+                    glDeleteProgram(Map(Programs, name));
+                } else {
+                    glDeleteShader(Map(Programs, name));
+                }
+                mNames[Programs].erase(name);
+            }
+            break;
+        }
+
+        //========================= BINDINGS ==========================//
+        case Call::BindBuffer: {
+            const auto target{ in.Get<GLenum>() };
+            const auto buffer{ in.Get<GLuint>() };
+            if(execute) glBindBuffer(target, Map(Buffers, buffer));
+            break;
+        }
+        case Call::BindBufferRange: {
+            const auto target{ in.Get<GLenum>() };
+            const auto index{ in.Get<GLuint>() };
+            const auto buffer{ in.Get<GLuint>() };
+            const auto offset{ in.Get<GLintptr>() };
+            const auto size{ in.Get<GLsizeiptr>() };
+            if(execute) glBindBufferRange(target, index, Map(Buffers, buffer), offset, size);
+            break;
+        }
+        case Call::BindFramebuffer: {
+            const auto target{ in.Get<GLenum>() };
+            const auto framebuffer{ in.Get<GLuint>() };
+            if(execute) glBindFramebuffer(target, Map(Framebuffers, framebuffer));
+            break;
+        }
+        case Call::BindRenderbuffer: {
+            const auto target{ in.Get<GLenum>() };
+            const auto renderbuffer{ in.Get<GLuint>() };
+            if(execute) glBindRenderbuffer(target, Map(Renderbuffers, renderbuffer));
+            break;
+        }
+        case Call::BindSampler: {
+            const auto unit{ in.Get<GLuint>() };
+            const auto sampler{ in.Get<GLuint>() };
+            if(execute) glBindSampler(unit, Map(Samplers, sampler));
+            break;
+        }
+        case Call::BindTexture: {
+            const auto target{ in.Get<GLenum>() };
+            const auto texture{ in.Get<GLuint>() };
+            if(execute) glBindTexture(target, Map(Textures, texture));
+            break;
+        }
+        case Call::BindVertexBuffer: {
+            const auto bindingIndex{ in.Get<GLuint>() };
+            const auto buffer{ in.Get<GLuint>() };
+            const auto offset{ in.Get<GLintptr>() };
+            const auto stride{ in.Get<GLsizei>() };
+            if(execute && nullptr != glBindVertexBuffer) glBindVertexBuffer(bindingIndex, Map(Buffers, buffer), offset, stride);
+            break;
+        }
+        case Call::BindVertexArray: {
+            const auto array{ in.Get<GLuint>() };
+            if(execute) glBindVertexArray(Map(VertexArrays, array));
+            break;
+        }
+        case Call::FramebufferRenderbuffer: {
+            const auto target{ in.Get<GLenum>() };
+            const auto attachment{ in.Get<GLenum>() };
+            const auto renderbufferTarget{ in.Get<GLenum>() };
+            const auto renderbuffer{ in.Get<GLuint>() };
+            if(execute) glFramebufferRenderbuffer(target, attachment, renderbufferTarget, Map(Renderbuffers, renderbuffer));
+            break;
+        }
+        case Call::FenceSync: {
+            const auto condition{ in.Get<GLenum>() };
+            const auto flags{ in.Get<GLbitfield>() };
+            const auto sync{ in.Get<uintptr_t>() };
+            if(execute) mSyncs[sync] = glFenceSync(condition, flags);
+            break;
+        }
+        case Call::ClientWaitSync: {
+            const auto sync{ in.Get<uintptr_t>() };
+            const auto flags{ in.Get<GLbitfield>() };
+            const auto timeout{ in.Get<GLuint64>() };
+            if(const auto it{ mSyncs.find(sync) }; execute && mSyncs.end() != it) {
+                glClientWaitSync(it->second, flags, timeout);
+            }
+            break;
+        }
+        case Call::DeleteSync: {
+            const auto sync{ in.Get<uintptr_t>() };
+            if(const auto it{ mSyncs.find(sync) }; execute && mSyncs.end() != it) {
+                glDeleteSync(it->second);
+                mSyncs.erase(it);
+            }
+            break;
+        }
+        case Call::QueryCounter: {
+            const auto id{ in.Get<GLuint>() };
+            const auto target{ in.Get<GLenum>() };
+            if(execute) glQueryCounter(Map(Queries, id), target);
+            break;
+        }
+        case Call::TextureParameteri: {
+            const auto texture{ in.Get<GLuint>() };
+            const auto pname{ in.Get<GLenum>() };
+            const auto param{ in.Get<GLint>() };
+            if(execute && nullptr != glTextureParameteri) glTextureParameteri(Map(Textures, texture), pname, param);
+            break;
+        }
+
+        //========================== SHADERS ==========================//
+        case Call::AttachShader:
+        case Call::DetachShader: {
+            const auto program{ in.Get<GLuint>() };
+            const auto shader{ in.Get<GLuint>() };
+            if(execute) {
+                if(Call::AttachShader == call) {
+                    glAttachShader(Map(Programs, program), Map(Programs, shader));
+                } else {
+                    glDetachShader(Map(Programs, program), Map(Programs, shader));
+                }
+            }
+            break;
+        }
+        case Call::CompileShader: {
+            const auto shader{ in.Get<GLuint>() };
+            if(execute) glCompileShader(Map(Programs, shader));
+            break;
+        }
+        case Call::LinkProgram: {
+            const auto program{ in.Get<GLuint>() };
+            if(execute) glLinkProgram(Map(Programs, program));
+            break;
+        }
+        case Call::UseProgram: {
+            mProgram = in.Get<GLuint>();
+            if(execute) glUseProgram(Map(Programs, mProgram));
+            break;
+        }
+        case Call::ShaderSource: {
+            const auto shader{ in.Get<GLuint>() };
+            const auto count{ std::max<GLsizei>(0, in.Get<GLsizei>()) };
+            std::vector<const GLchar *> strings(count);
+            std::vector<GLint> lengths(count);
+            for(GLsizei i = 0; i < count; ++i) {
+                size_t size{ 0 };
+                strings[i] = reinterpret_cast<const GLchar *>(in.Blob(size));
+                lengths[i] = static_cast<GLint>(size);
+            }
+            if(execute) glShaderSource(Map(Programs, shader), count, strings.data(), lengths.data());
+            break;
+        }
+        case Call::GetUniformLocation: {
+            const auto program{ in.Get<GLuint>() };
+            size_t size{ 0 };
+            const auto *name{ in.Blob(size) };
+            const auto location{ in.Get<GLint>() };
+            if(execute && location >= 0) {
+                const std::string uniform{ reinterpret_cast<const char *>(name), size };
+                mLocations[{ program, location }] = glGetUniformLocation(Map(Programs, program), uniform.c_str());
+            }
+            break;
+        }
+        case Call::GetUniformBlockIndex: {
+            const auto program{ in.Get<GLuint>() };
+            size_t size{ 0 };
+            const auto *name{ in.Blob(size) };
+            const auto index{ in.Get<GLuint>() };
+            if(execute && GL_INVALID_INDEX != index) {
+                const std::string block{ reinterpret_cast<const char *>(name), size };
+                mBlocks[{ program, index }] = glGetUniformBlockIndex(Map(Programs, program), block.c_str());
+            }
+            break;
+        }
+        case Call::UniformBlockBinding: {
+            const auto program{ in.Get<GLuint>() };
+            const auto index{ in.Get<GLuint>() };
+            const auto binding{ in.Get<GLuint>() };
+            if(execute) {
+                const auto it{ mBlocks.find({ program, index }) };
+                glUniformBlockBinding(Map(Programs, program), mBlocks.end() != it ? it->second : index, binding);
+            }
+            break;
+        }
+        case Call::Uniform1f: {
+            const auto location{ in.Get<GLint>() };
+            const auto value{ in.Get<GLfloat>() };
+            if(execute) glUniform1f(Location(location), value);
+            break;
+        }
+        case Call::Uniform1i: {
+            const auto location{ in.Get<GLint>() };
+            const auto value{ in.Get<GLint>() };
+            if(execute) glUniform1i(Location(location), value);
+            break;
+        }
+        case Call::Uniform4fv: {
+            const auto location{ in.Get<GLint>() };
+            const auto count{ in.Get<GLsizei>() };
+            size_t size{ 0 };
+            const auto *data{ in.Blob(size) };
+            if(execute) glUniform4fv(Location(location), count, floats(data, size).data());
+            break;
+        }
+        case Call::UniformMatrix4fv: {
+            const auto location{ in.Get<GLint>() };
+            const auto count{ in.Get<GLsizei>() };
+            const auto transpose{ in.Get<GLboolean>() };
+            size_t size{ 0 };
+            const auto *data{ in.Blob(size) };
+            if(execute) glUniformMatrix4fv(Location(location), count, transpose, floats(data, size).data());
+            break;
+        }
+
+        //=========================== DATA ============================//
+        case Call::BufferData: {
+            const auto target{ in.Get<GLenum>() };
+            const auto size{ in.Get<GLsizeiptr>() };
+            const bool hasData{ in.Get<bool>() };
+            size_t length{ 0 };
+            const auto *data{ in.Blob(length) };
+            const auto usage{ in.Get<GLenum>() };
+            if(execute) glBufferData(target, size, hasData ? data : nullptr, usage);
+            break;
+        }
+        case Call::BufferSubData: {
+            const auto target{ in.Get<GLenum>() };
+            const auto offset{ in.Get<GLintptr>() };
+            size_t length{ 0 };
+            const auto *data{ in.Blob(length) };
+            if(execute) glBufferSubData(target, offset, static_cast<GLsizeiptr>(length), data);
+            break;
+        }
+        case Call::TexImage2D: {
+            const auto target{ in.Get<GLenum>() };
+            const auto level{ in.Get<GLint>() };
+            const auto internalFormat{ in.Get<GLint>() };
+            const auto width{ in.Get<GLsizei>() };
+            const auto height{ in.Get<GLsizei>() };
+            const auto border{ in.Get<GLint>() };
+            const auto format{ in.Get<GLenum>() };
+            const auto type{ in.Get<GLenum>() };
+            const bool hasPixels{ in.Get<bool>() };
+            size_t length{ 0 };
+            const auto *pixels{ in.Blob(length) };
+            if(execute) glTexImage2D(target, level, internalFormat, width, height, border, format, type, hasPixels ? pixels : nullptr);
+            break;
+        }
+        case Call::VertexAttribPointer: {
+            const auto index{ in.Get<GLuint>() };
+            const auto size{ in.Get<GLint>() };
+            const auto type{ in.Get<GLenum>() };
+            const auto normalized{ in.Get<GLboolean>() };
+            const auto stride{ in.Get<GLsizei>() };
+            const auto *offset{ in.Offset() };
+            if(execute) glVertexAttribPointer(index, size, type, normalized, stride, offset);
+            break;
+        }
+
+        //=========================== DRAWS ===========================//
+        case Call::DrawElements: {
+            const auto mode{ in.Get<GLenum>() };
+            const auto count{ in.Get<GLsizei>() };
+            const auto type{ in.Get<GLenum>() };
+            const auto *offset{ in.Offset() };
+            if(execute) glDrawElements(mode, count, type, offset);
+            break;
+        }
+        case Call::DrawElementsBaseVertex: {
+            const auto mode{ in.Get<GLenum>() };
+            const auto count{ in.Get<GLsizei>() };
+            const auto type{ in.Get<GLenum>() };
+            const auto *offset{ in.Offset() };
+            const auto baseVertex{ in.Get<GLint>() };
+            if(execute) glDrawElementsBaseVertex(mode, count, type, offset, baseVertex);
+            break;
+        }
+
+        case Call::Frame:
+        case Call::Count:
+            break;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef __GLREPLAY_H__
+#define __GLREPLAY_H__
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glcapture.hpp"
+
+/**
+ * Re-executes a GLCapture file on the current context.
+ * Object names, fences, uniform locations and uniform block indices are remapped to the ones this context
+ * hands out and query calls are skipped. The captured default framebuffer,
+ * and any framebuffer created before the capture started, becomes the
+ * target passed to Run (e.g. the HeadlessWindow FBO).
+ */
+class GLReplay {
+public:
+    using FrameCallback = std::function<void(uint64_t frame)>;
+
+    bool Open(const std::string &path);
+
+    /// Per-call counts and redundancy of the whole capture, without touching GL.
+    GLCapture::Stats Scan(uint64_t &frames);
+
+    /// Executes every call, onFrame runs after each captured frame. False on a corrupt capture.
+    bool Run(GLuint target, const FrameCallback &onFrame);
+
+    /// Query calls Run did not execute.
+    uint64_t Skipped() const;
+
+private:
+    enum Namespace {
+        Buffers,
+        Framebuffers,
+        Programs,       ///< shaders share the program namespace
+        Queries,
+        Renderbuffers,
+        Samplers,
+        Textures,
+        VertexArrays,
+        NamespaceCount
+    };
+
+    std::vector<uint8_t> mData;
+    size_t mBody{ 0 };
+
+    GLuint mTarget{ 0 };
+    std::array<std::unordered_map<GLuint, GLuint>, NamespaceCount> mNames;
+    std::map<std::pair<GLuint, GLint>, GLint> mLocations;   ///< (captured program, captured location)
+    std::map<std::pair<GLuint, GLuint>, GLuint> mBlocks;   ///< (captured program, captured block index)
+    std::unordered_map<uintptr_t, GLsync> mSyncs;            ///< captured fence handle
+    GLuint mProgram{ 0 };                                    ///< captured program in use
+    uint64_t mSkipped{ 0 };
+
+    void Reset();
+    GLuint Map(Namespace space, GLuint name) const;
+    GLint Location(GLint location) const;
+    std::vector<GLuint> Names(GLStream::Reader &in) const;
+
+    void Generate(Namespace space, const std::vector<GLuint> &captured, void (GLAPIENTRY *generate)(GLsizei, GLuint *));
+    void Delete(Namespace space, const std::vector<GLuint> &captured, void (GLAPIENTRY *destroy)(GLsizei, const GLuint *));
+
+    /// Reads one call's arguments and, when execute is set, issues it.
+    void Decode(GLStream::Reader &in, GLStream::Call call, bool execute);
+};
+
+#endif // __GLREPLAY_H__
@@ -0,0 +1,76 @@
+#include "incs.hpp"
+
+#include "glstream.hpp"
+
+namespace {
+    const char *const kNames[]{
+        "Frame",
+#define GLSTREAM_NAME(name) "gl" #name,
+        GLHOOKS_GL11(GLSTREAM_NAME)
+        GLSTREAM_GLEW_CALLS(GLSTREAM_NAME)
+#undef GLSTREAM_NAME
+    };
+    static_assert(sizeof(kNames) / sizeof(kNames[0]) == GLStream::CallCount, "every call needs a name");
+
+    size_t components(GLenum format) {
+        switch(format) {
+            case GL_RG:
+            case GL_RG_INTEGER:
+                return 2;
+            case GL_RGB:
+            case GL_BGR:
+            case GL_RGB_INTEGER:
+                return 3;
+            case GL_RGBA:
+            case GL_BGRA:
+            case GL_RGBA_INTEGER:
+                return 4;
+            default:
+                return 1;
+        }
+    }
+
+    size_t typeSize(GLenum type) {
+        switch(type) {
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT:
+                return 2;
+            case GL_INT:
+            case GL_UNSIGNED_INT:
+            case GL_FLOAT:
+                return 4;
+            default:
+                return 1;
+        }
+    }
+
+    /// Packed types hold a whole pixel.
+    bool packed(GLenum type) {
+        switch(type) {
+            case GL_UNSIGNED_INT_24_8:
+            case GL_UNSIGNED_INT_8_8_8_8:
+            case GL_UNSIGNED_INT_8_8_8_8_REV:
+            case GL_UNSIGNED_INT_2_10_10_10_REV:
+            case GL_UNSIGNED_INT_10F_11F_11F_REV:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+const char *GLStream::Name(Call call) {
+    const size_t index{ static_cast<size_t>(call) };
+    return index < CallCount ? kNames[index] : "unknown";
+}
+
+size_t GLStream::ImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment, GLint rowLength) {
+    if(width <= 0 || height <= 0) {
+        return 0;
+    }
+    const size_t pixel{ packed(type) ? 4 : components(format) * typeSize(type) };
+    const size_t align{ static_cast<size_t>(alignment > 0 ? alignment : 4) };
+    const size_t row{ (static_cast<size_t>(rowLength > 0 ? rowLength : width) * pixel + align - 1) / align * align };
+    return row * (height - 1) + static_cast<size_t>(width) * pixel;
+}
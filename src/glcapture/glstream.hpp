@@ -0,0 +1,256 @@
+#ifndef __GLSTREAM_H__
+#define __GLSTREAM_H__
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "glhooks.hpp"
+
+/**
+ * Binary format of GL captures.
+ *
+ * A capture starts with Magic and a varint Version, followed by one record
+ * per call: a varint (call id << 1 | redundant) and the call's arguments.
+ * Integers are LEB128 varints (signed ones zigzag-encoded), floats are raw
+ * little-endian 32-bit words, buffer offsets are varints and client memory
+ * (buffer and texture data, shader sources, uniform arrays) is a varint
+ * length followed by the bytes. Query entry points keep no arguments: they
+ * only count. A Frame record closes every frame.
+ *
+ * The ids below are the format. The GL 1.1 block is numbered first, so new
+ * GLEW entry points appended to GLSTREAM_GLEW_CALLS leave every existing id
+ * alone: bump Version and a reader still decodes captures back to
+ * MinVersion. Reordering, or adding a GL 1.1 hook, needs MinVersion raised.
+ */
+
+/// Entry points GLEW loads through pointers (everything past OpenGL 1.1).
+#define GLSTREAM_GLEW_CALLS(X) \
+    X(ActiveTexture) \
+    X(AttachShader) \
+    X(BindBuffer) \
+    X(BindFramebuffer) \
+    X(BindRenderbuffer) \
+    X(BindSampler) \
+    X(BindVertexArray) \
+    X(BlendEquation) \
+    X(BlendEquationSeparate) \
+    X(BlendFuncSeparate) \
+    X(BufferData) \
+    X(CheckFramebufferStatus) \
+    X(ClipControl) \
+    X(CompileShader) \
+    X(CreateProgram) \
+    X(CreateShader) \
+    X(DeleteBuffers) \
+    X(DeleteFramebuffers) \
+    X(DeleteProgram) \
+    X(DeleteRenderbuffers) \
+    X(DeleteShader) \
+    X(DeleteVertexArrays) \
+    X(DetachShader) \
+    X(DrawElementsBaseVertex) \
+    X(EnableVertexAttribArray) \
+    X(FramebufferRenderbuffer) \
+    X(GenBuffers) \
+    X(GenFramebuffers) \
+    X(GenQueries) \
+    X(GenRenderbuffers) \
+    X(GenVertexArrays) \
+    X(GenerateMipmap) \
+    X(GetAttribLocation) \
+    X(GetInteger64v) \
+    X(GetProgramInfoLog) \
+    X(GetProgramiv) \
+    X(GetQueryObjectiv) \
+    X(GetQueryObjectui64v) \
+    X(GetShaderInfoLog) \
+    X(GetShaderiv) \
+    X(GetUniformLocation) \
+    X(LinkProgram) \
+    X(QueryCounter) \
+    X(RenderbufferStorage) \
+    X(ShaderSource) \
+    X(TextureParameteri) \
+    X(Uniform1f) \
+    X(Uniform1i) \
+    X(Uniform4fv) \
+    X(UniformMatrix4fv) \
+    X(UseProgram) \
+    X(VertexAttribPointer) \
+    X(BindBufferRange) \
+    X(BufferSubData) \
+    X(GetUniformBlockIndex) \
+    X(UniformBlockBinding) \
+    X(BindVertexBuffer) \
+    X(VertexAttribBinding) \
+    X(VertexAttribFormat) \
+    X(ClientWaitSync) \
+    X(DeleteSync) \
+    X(FenceSync) \
+    X(GetActiveAttrib) \
+    X(GetActiveUniform) \
+    X(GetUniformfv) \
+    X(GetUniformiv) \
+    X(MaxShaderCompilerThreadsARB) \
+    X(MaxShaderCompilerThreadsKHR)
+
+namespace GLStream {
+    constexpr char Magic[4]{ 'G', 'L', 'C', 'P' };
+    /// 2: uniform buffer calls, 3: vertex attribute binding, 4: GL 1.1 ids first, 5: fences,
+    /// 6: shader reflection queries, 7: uniform reads and compiler threads
+    constexpr uint32_t Version{ 7 };
+    /// Oldest capture the reader decodes; later versions only append calls.
+    constexpr uint32_t MinVersion{ 4 };
+
+    enum class Call : uint16_t {
+        Frame,
+#define GLSTREAM_ENUM(name) name,
+        GLHOOKS_GL11(GLSTREAM_ENUM)
+        GLSTREAM_GLEW_CALLS(GLSTREAM_ENUM)
+#undef GLSTREAM_ENUM
+        Count
+    };
+    constexpr size_t CallCount{ static_cast<size_t>(Call::Count) };
+
+    const char *Name(Call call);
+
+    /// Bytes of a glTexImage2D upload under the given unpack state.
+    size_t ImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment, GLint rowLength);
+
+    class Writer {
+    public:
+        void Begin(Call call, bool redundant) {
+            Unsigned((static_cast<uint64_t>(call) << 1) | (redundant ? 1 : 0));
+        }
+
+        template<class T>
+        void Put(T value) {
+            if constexpr(std::is_floating_point_v<T>) {
+                const float narrow{ static_cast<float>(value) };
+                Raw(&narrow, sizeof(narrow));
+            } else if constexpr(std::is_signed_v<T>) {
+                const int64_t wide{ static_cast<int64_t>(value) };
+                Unsigned((static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63));
+            } else {
+                Unsigned(static_cast<uint64_t>(value));
+            }
+        }
+
+        /// Pointer arguments that are offsets into a bound buffer.
+        void Offset(const void *offset) {
+            Unsigned(reinterpret_cast<uintptr_t>(offset));
+        }
+
+        void Blob(const void *data, size_t size) {
+            Unsigned(size);
+            Raw(data, size);
+        }
+
+        const std::vector<uint8_t> &Bytes() const { return mBytes; }
+        void Clear() { mBytes.clear(); }
+
+    private:
+        std::vector<uint8_t> mBytes;
+
+        void Unsigned(uint64_t value) {
+            while(value >= 0x80) {
+                mBytes.push_back(static_cast<uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            mBytes.push_back(static_cast<uint8_t>(value));
+        }
+        void Raw(const void *data, size_t size) {
+            const auto *bytes{ static_cast<const uint8_t *>(data) };
+            mBytes.insert(mBytes.end(), bytes, bytes + size);
+        }
+    };
+
+    /// Reads records back; on truncated input Failed() turns true and values read as zero.
+    class Reader {
+    public:
+        Reader(const uint8_t *data, size_t size) : mAt{ data }, mEnd{ data + size } {}
+
+        bool AtEnd() const { return mAt >= mEnd; }
+        bool Failed() const { return mFailed; }
+
+        bool Next(Call &call, bool &redundant) {
+            if(AtEnd()) {
+                return false;
+            }
+            const uint64_t tag{ Unsigned() };
+            call = static_cast<Call>(tag >> 1);
+            redundant = 0 != (tag & 1);
+            if((tag >> 1) >= CallCount) {
+                mFailed = true;
+            }
+            return !mFailed;
+        }
+
+        template<class T>
+        T Get() {
+            if constexpr(std::is_floating_point_v<T>) {
+                float narrow{ 0.0f };
+                Raw(&narrow, sizeof(narrow));
+                return static_cast<T>(narrow);
+            } else if constexpr(std::is_signed_v<T>) {
+                const uint64_t zigzag{ Unsigned() };
+                return static_cast<T>(static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1));
+            } else {
+                return static_cast<T>(Unsigned());
+            }
+        }
+
+        const void *Offset() {
+            return reinterpret_cast<const void *>(static_cast<uintptr_t>(Unsigned()));
+        }
+
+        /// Points into the capture, valid as long as its bytes are.
+        const uint8_t *Blob(size_t &size) {
+            size = static_cast<size_t>(Unsigned());
+            if(size > static_cast<size_t>(mEnd - mAt)) {
+                mFailed = true;
+                mAt = mEnd;
+                size = 0;
+                return nullptr;
+            }
+            const uint8_t *data{ mAt };
+            mAt += size;
+            return data;
+        }
+
+    private:
+        const uint8_t *mAt;
+        const uint8_t *mEnd;
+        bool mFailed{ false };
+
+        uint64_t Unsigned() {
+            uint64_t value{ 0 };
+            for(int shift = 0; shift < 64; shift += 7) {
+                if(AtEnd()) {
+                    mFailed = true;
+                    return 0;
+                }
+                const uint8_t byte{ *mAt++ };
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if(0 == (byte & 0x80)) {
+                    break;
+                }
+            }
+            return value;
+        }
+        void Raw(void *data, size_t size) {
+            if(size > static_cast<size_t>(mEnd - mAt)) {
+                mFailed = true;
+                mAt = mEnd;
+                return;
+            }
+            std::memcpy(data, mAt, size);
+            mAt += size;
+        }
+    };
+}
+
+#endif // __GLSTREAM_H__
@@ -6,9 +6,11 @@
 #include <imgui_impl_opengl3.h>
 
 #include <GL/glew.h>
+#include "glhooks.hpp"
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <iostream>
@@ -25,6 +27,8 @@
 #include <ctime>
 #include <map>
 
+#include "logmacros.hpp"
+
 #define UNUSED(x) (void)(x)
 
 #endif // __INCS_H__
@@ -0,0 +1,265 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+
+#include "jobsystem.hpp"
+
+namespace {
+    constexpr int kSpinsBeforeSleep{ 64 };
+    constexpr size_t kChunksPerThread{ 4 };
+
+    /// index of the queue owned by the current thread, -1 for foreign threads
+    thread_local int tQueue{ -1 };
+}
+
+struct JobSystem::Job {
+    Task task;
+    Counter *counter;
+};
+
+//================================= COUNTER =================================//
+
+bool JobSystem::Counter::Done() const {
+    return 0 == mValue.load(std::memory_order_acquire);
+}
+
+//=============================== WORK QUEUE ================================//
+// Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models"). Only the owner calls Push/Pop, anyone may Steal.
+
+bool JobSystem::WorkQueue::Push(Job *job) {
+    const int64_t bottom{ mBottom.load(std::memory_order_relaxed) };
+    const int64_t top{ mTop.load(std::memory_order_acquire) };
+    if(bottom - top >= Capacity) {
+        return false;
+    }
+    mJobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+JobSystem::Job *JobSystem::WorkQueue::Pop() {
+    const int64_t bottom{ mBottom.load(std::memory_order_relaxed) - 1 };
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top{ mTop.load(std::memory_order_relaxed) };
+    if(top > bottom) {
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Job *job{ mJobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed) };
+    if(top == bottom) {
+        // last job: race against thieves for it
+        if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job *JobSystem::WorkQueue::Steal() {
+    int64_t top{ mTop.load(std::memory_order_acquire) };
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom{ mBottom.load(std::memory_order_acquire) };
+    if(top >= bottom) {
+        return nullptr;
+    }
+    Job *job{ mJobs[top & (Capacity - 1)].load(std::memory_order_relaxed) };
+    if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+//================================ JOB SYSTEM ===============================//
+
+JobSystem *JobSystem::Instance() {
+    static JobSystem system;
+    return &system;
+}
+
+JobSystem::~JobSystem() {
+    Shutdown();
+}
+
+void JobSystem::Initialize(size_t threads) {
+    if(mRunning) {
+        Shutdown();
+    }
+    if(0 == threads) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for(size_t i = 0; i < threads; ++i) {
+        mQueues.push_back(std::make_unique<WorkQueue>());
+    }
+    tQueue = 0;
+    mRunning = true;
+    for(size_t i = 1; i < threads; ++i) {
+        mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+    LOGI << "[Jobs] Started with " << threads << " threads";
+}
+
+void JobSystem::Shutdown() {
+    if(!mRunning) {
+        return;
+    }
+    mRunning = false;
+    {
+        std::lock_guard<std::mutex> lock{ mSleepLock };
+        mWake.notify_all();
+    }
+    for(auto &worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+
+    // whatever is still queued runs here, so no counter is left hanging
+    while(Job *job{ Find(0) }) {
+        Execute(job);
+    }
+    mQueues.clear();
+    tQueue = -1;
+    LOGI << "[Jobs] Stopped";
+}
+
+size_t JobSystem::Threads() const {
+    return mRunning ? mQueues.size() : 1;
+}
+
+void JobSystem::Run(Task task, Counter *counter, Counter *dependency) {
+    if(!mRunning) {
+        if(nullptr != dependency) {
+            Wait(*dependency);
+        }
+        task();
+        return;
+    }
+    if(nullptr != counter) {
+        counter->mValue.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job *job{ new Job{ std::move(task), counter } };
+    if(nullptr != dependency) {
+        std::lock_guard<std::mutex> lock{ dependency->mLock };
+        if(!dependency->Done()) {
+            dependency->mWaiting.push_back(job);
+            return;
+        }
+    }
+    Schedule(job);
+}
+
+void JobSystem::Wait(Counter &counter) {
+    while(!counter.Done()) {
+        if(mRunning) {
+            if(Job *job{ Find(static_cast<size_t>(tQueue)) }) {
+                Execute(job);
+                continue;
+            }
+        }
+        std::this_thread::yield();
+    }
+    // the last Execute may still be inside the counter's lock: let it leave
+    // before the caller is allowed to destroy the counter
+    std::lock_guard<std::mutex> lock{ counter.mLock };
+}
+
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t grain, const RangeTask &fn) {
+    const size_t count{ end > begin ? end - begin : 0 };
+    grain = std::max<size_t>(1, grain);
+    if(0 == count) {
+        return;
+    }
+    if(!mRunning || count < grain * 2) {
+        fn(begin, end);
+        return;
+    }
+    const size_t chunks{ std::max<size_t>(1, std::min(count / grain, Threads() * kChunksPerThread)) };
+    const size_t step{ (count + chunks - 1) / chunks };
+    Counter counter;
+    for(size_t from = begin + step; from < end; from += step) {
+        Run([&fn, from, to = std::min(from + step, end)] { fn(from, to); }, &counter);
+    }
+    fn(begin, std::min(begin + step, end));
+    Wait(counter);
+}
+
+void JobSystem::Schedule(Job *job) {
+    mQueued.fetch_add(1);
+    const bool own{ tQueue >= 0 && static_cast<size_t>(tQueue) < mQueues.size() };
+    if(!own || !mQueues[tQueue]->Push(job)) {
+        std::lock_guard<std::mutex> lock{ mInjectLock };
+        mInjected.push_back(job);
+    }
+    if(mSleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock{ mSleepLock };
+        mWake.notify_one();
+    }
+}
+
+JobSystem::Job *JobSystem::Find(size_t self) {
+    const size_t queues{ mQueues.size() };
+    Job *job{ nullptr };
+    if(self < queues) {
+        job = mQueues[self]->Pop();
+    }
+    if(nullptr == job) {
+        std::lock_guard<std::mutex> lock{ mInjectLock };
+        if(!mInjected.empty()) {
+            job = mInjected.back();
+            mInjected.pop_back();
+        }
+    }
+    for(size_t i = 1; nullptr == job && i <= queues; ++i) {
+        const size_t victim{ (self + i) % queues };
+        if(victim != self) {
+            job = mQueues[victim]->Steal();
+        }
+    }
+    if(nullptr != job) {
+        mQueued.fetch_sub(1);
+    }
+    return job;
+}
+
+void JobSystem::Execute(Job *job) {
+    job->task();
+    if(Counter *counter{ job->counter }; nullptr != counter) {
+        std::vector<Job *> ready;
+        {
+            std::lock_guard<std::mutex> lock{ counter->mLock };
+            if(1 == counter->mValue.fetch_sub(1, std::memory_order_acq_rel)) {
+                ready.swap(counter->mWaiting);
+            }
+        }
+        for(Job *next : ready) {
+            Schedule(next);
+        }
+    }
+    delete job;
+}
+
+void JobSystem::WorkerLoop(size_t index) {
+    tQueue = static_cast<int>(index);
+    int idle{ 0 };
+    while(mRunning) {
+        if(Job *job{ Find(index) }) {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+        if(++idle < kSpinsBeforeSleep) {
+            std::this_thread::yield();
+            continue;
+        }
+        mSleeping.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock{ mSleepLock };
+            mWake.wait(lock, [this] { return mQueued.load() > 0 || !mRunning; });
+        }
+        mSleeping.fetch_sub(1);
+        idle = 0;
+    }
+    tQueue = -1;
+}
@@ -0,0 +1,97 @@
+#ifndef __JOBSYSTEM_H__
+#define __JOBSYSTEM_H__
+
+#include <atomic>
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing job scheduler.
+ * Every worker (and the thread that called Initialize) owns a lock-free
+ * deque: it pushes and pops its own jobs at the bottom, idle workers steal
+ * from the top of the others. Jobs submitted from any other thread go to a
+ * shared injection queue. Completion is tracked with Counters, which can also
+ * hold jobs back until another counter drops to zero.
+ *
+ * Until Initialize is called (or after Shutdown) every job runs inline.
+ */
+class JobSystem {
+    struct Job;
+
+public:
+    using Task = std::function<void()>;
+    using RangeTask = std::function<void(size_t, size_t)>;
+
+    class Counter {
+    public:
+        Counter() = default;
+        Counter(const Counter &) = delete;
+        Counter &operator=(const Counter &) = delete;
+
+        bool Done() const;
+
+    private:
+        friend class JobSystem;
+        std::atomic<int> mValue{ 0 };
+        std::mutex mLock;
+        std::vector<Job *> mWaiting;   ///< jobs that depend on this counter
+    };
+
+    static JobSystem *Instance();
+    ~JobSystem();
+
+    void Initialize(size_t threads = 0);
+    void Shutdown();
+    size_t Threads() const;
+
+    /// Queues task; counter (if any) is incremented now and decremented once
+    /// the task has finished. The task starts only after dependency is done.
+    void Run(Task task, Counter *counter = nullptr, Counter *dependency = nullptr);
+
+    /// Blocks until counter is done, running queued jobs meanwhile.
+    void Wait(Counter &counter);
+
+    /// Calls fn(chunkBegin, chunkEnd) over [begin, end) split into chunks of
+    /// at least grain items, on all workers; returns when every chunk is done.
+    void ParallelFor(size_t begin, size_t end, size_t grain, const RangeTask &fn);
+
+private:
+    class WorkQueue {
+    public:
+        static constexpr int64_t Capacity{ 4096 };
+
+        bool Push(Job *job);
+        Job *Pop();
+        Job *Steal();
+
+    private:
+        alignas(64) std::atomic<int64_t> mTop{ 0 };
+        alignas(64) std::atomic<int64_t> mBottom{ 0 };
+        std::array<std::atomic<Job *>, Capacity> mJobs{};
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> mQueues;   ///< [0] belongs to the initializing thread
+    std::vector<std::thread> mWorkers;
+    std::mutex mInjectLock;
+    std::vector<Job *> mInjected;
+
+    std::mutex mSleepLock;
+    std::condition_variable mWake;
+    std::atomic<int> mSleeping{ 0 };
+    std::atomic<size_t> mQueued{ 0 };
+    std::atomic<bool> mRunning{ false };
+
+    JobSystem() = default;
+
+    void Schedule(Job *job);
+    Job *Find(size_t self);
+    void Execute(Job *job);
+    void WorkerLoop(size_t index);
+};
+
+#endif // __JOBSYSTEM_H__
@@ -0,0 +1,220 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <chrono>
+
+#include "asyncappender.hpp"
+
+namespace {
+    /// longest the writer sleeps; bounds the delay of a wake-up lost to a race
+    constexpr auto kIdleWait{ std::chrono::milliseconds(5) };
+
+    size_t roundUpPow2(size_t value) {
+        size_t result{ 1 };
+        while(result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /// Record replayed on the writer thread with the producer's time, thread and message.
+    class ReplayedRecord : public plog::Record {
+    public:
+        ReplayedRecord(plog::Severity severity, const plog::util::Time &time, unsigned int tid, const char *func,
+                size_t line, const char *file, const void *object, int instanceId, const plog::util::nchar *message)
+            : plog::Record{ severity, func, line, file, object, instanceId }
+            , mTime{ time }
+            , mTid{ tid }
+            , mFunc{ func }
+            , mMessage{ message }
+        {}
+
+        const plog::util::Time &getTime() const override { return mTime; }
+        unsigned int getTid() const override { return mTid; }
+        const char *getFunc() const override { return mFunc; }
+        const plog::util::nchar *getMessage() const override { return mMessage; }
+
+    private:
+        const plog::util::Time mTime;
+        const unsigned int mTid;
+        const char *mFunc;
+        const plog::util::nchar *mMessage;
+    };
+}
+
+namespace plog {
+
+struct AsyncAppender::Slot {
+    std::atomic<size_t> sequence{ 0 };
+    Severity severity{ none };
+    util::Time time{};
+    unsigned int tid{ 0 };
+    size_t line{ 0 };
+    const char *file{ nullptr };    ///< __FILE__ literal, outlives the record
+    const void *object{ nullptr };
+    int instanceId{ 0 };
+    std::string func;
+    util::nstring message;
+};
+
+AsyncAppender::AsyncAppender(size_t capacity, Overflow overflow)
+    : mSlots{ new Slot[roundUpPow2(std::max<size_t>(capacity, 2))] }
+    , mMask{ roundUpPow2(std::max<size_t>(capacity, 2)) - 1 }
+    , mOverflow{ overflow }
+{
+    for(size_t i = 0; i <= mMask; ++i) {
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mWriter = std::thread{ &AsyncAppender::Run, this };
+}
+
+AsyncAppender::~AsyncAppender() {
+    {
+        std::lock_guard<std::mutex> lock{ mWakeLock };
+        mRunning.store(false, std::memory_order_release);
+    }
+    mWake.notify_one();
+    mWriter.join();
+}
+
+AsyncAppender &AsyncAppender::addAppender(IAppender *appender) {
+    mAppenders.push_back(appender);
+    return *this;
+}
+
+void AsyncAppender::write(const Record &record) {
+    const Severity severity{ record.getSeverity() };
+    const bool mayDrop{ fatal != severity && (Overflow::Drop == mOverflow
+        || (Overflow::DropVerbose == mOverflow && severity > warning)) };
+    while(!Push(record)) {
+        if(mayDrop) {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Wake();
+        std::this_thread::yield();
+    }
+    Wake();
+    if(fatal == severity) {
+        Flush();
+    }
+}
+
+void AsyncAppender::Flush() {
+    if(std::this_thread::get_id() == mWriter.get_id()) {
+        return;
+    }
+    const size_t target{ mEnqueue.load(std::memory_order_acquire) };
+    while(mWritten.load(std::memory_order_acquire) < target) {
+        mWake.notify_one();
+        std::this_thread::yield();
+    }
+}
+
+uint64_t AsyncAppender::Dropped() const {
+    return mDropped.load(std::memory_order_relaxed);
+}
+
+//================================ RING ================================//
+// Bounded MPMC queue of D. Vyukov, used with a single consumer: each slot's
+// sequence says whose turn it is. Producers claim a position with a CAS on
+// mEnqueue and publish the slot by advancing its sequence.
+
+bool AsyncAppender::Push(const Record &record) {
+    size_t position{ mEnqueue.load(std::memory_order_relaxed) };
+    Slot *slot{ nullptr };
+    for(;;) {
+        slot = &mSlots[position & mMask];
+        const size_t sequence{ slot->sequence.load(std::memory_order_acquire) };
+        const intptr_t diff{ static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position) };
+        if(0 == diff) {
+            if(mEnqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if(diff < 0) {
+            return false;
+        } else {
+            position = mEnqueue.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->severity = record.getSeverity();
+    slot->time = record.getTime();
+    slot->tid = record.getTid();
+    slot->line = record.getLine();
+    slot->file = record.getFile();
+    slot->object = record.getObject();
+    slot->instanceId = record.getInstanceId();
+    slot->func.assign(record.getFunc());
+    slot->message.assign(record.getMessage());
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncAppender::Pop() {
+    Slot &slot{ mSlots[mDequeue & mMask] };
+    if(slot.sequence.load(std::memory_order_acquire) != mDequeue + 1) {
+        return false;
+    }
+
+    const ReplayedRecord record{ slot.severity, slot.time, slot.tid, slot.func.c_str(), slot.line, slot.file,
+        slot.object, slot.instanceId, slot.message.c_str() };
+    for(IAppender *appender : mAppenders) {
+        appender->write(record);
+    }
+
+    slot.sequence.store(mDequeue + mMask + 1, std::memory_order_release);
+    ++mDequeue;
+    mWritten.store(mDequeue, std::memory_order_release);
+    return true;
+}
+
+//=============================== WRITER ===============================//
+
+void AsyncAppender::Wake() {
+    if(mIdle.load()) {
+        mWake.notify_one();
+    }
+}
+
+void AsyncAppender::ReportDropped() {
+    const uint64_t dropped{ mDropped.load(std::memory_order_relaxed) };
+    if(dropped == mReported) {
+        return;
+    }
+    util::nostringstream message;
+    message << PLOG_NSTR("[Log] ") << dropped - mReported << PLOG_NSTR(" records dropped, the async queue was full");
+    const util::nstring text{ message.str() };
+    util::Time time;
+    util::ftime(&time);
+    const ReplayedRecord record{ warning, time, util::gettid(), "AsyncAppender", 0, __FILE__, this, 0, text.c_str() };
+    for(IAppender *appender : mAppenders) {
+        appender->write(record);
+    }
+    mReported = dropped;
+}
+
+void AsyncAppender::Run() {
+    for(;;) {
+        bool busy{ false };
+        while(Pop()) {
+            busy = true;
+        }
+        ReportDropped();
+        if(!mRunning.load(std::memory_order_acquire)) {
+            while(Pop()) {}
+            return;
+        }
+        if(busy) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{ mWakeLock };
+        mIdle.store(true);
+        if(mRunning.load(std::memory_order_acquire)
+            && mSlots[mDequeue & mMask].sequence.load(std::memory_order_acquire) != mDequeue + 1) {
+            mWake.wait_for(lock, kIdleWait);
+        }
+        mIdle.store(false);
+    }
+}
+
+} // namespace plog
@@ -0,0 +1,80 @@
+#ifndef __ASYNCAPPENDER_H__
+#define __ASYNCAPPENDER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <plog/Appenders/IAppender.h>
+#include <plog/Record.h>
+
+namespace plog {
+
+/**
+ * Appender that takes formatting and I/O off the logging thread.
+ * write() copies the record into a bounded lock-free MPSC ring and returns;
+ * a background thread replays each record, with its original time and
+ * thread id, to the appenders added with addAppender.
+ *
+ * The caller still builds its message (the LOG stream), the appender adds
+ * one claim on the ring and a copy into a slot. Slots keep their string
+ * capacity, so once warm a push does not allocate. What happens when the
+ * ring is full is the Overflow policy; fatal records are always written
+ * out before write() returns.
+ */
+class AsyncAppender : public IAppender {
+public:
+    enum class Overflow {
+        Block,          ///< wait for the writer thread to free a slot
+        Drop,           ///< discard the new record
+        DropVerbose     ///< discard info and below, block for warnings and worse
+    };
+
+    explicit AsyncAppender(size_t capacity = 8192, Overflow overflow = Overflow::Block);
+    ~AsyncAppender() override;
+
+    /// Not thread safe, add every appender before the first record arrives.
+    AsyncAppender &addAppender(IAppender *appender);
+
+    void write(const Record &record) override;
+
+    /// Blocks until every record pushed so far has been written.
+    void Flush();
+
+    /// Records discarded by the overflow policy since construction.
+    uint64_t Dropped() const;
+
+private:
+    struct Slot;
+
+    std::unique_ptr<Slot[]> mSlots;
+    const size_t mMask;
+    const Overflow mOverflow;
+
+    alignas(64) std::atomic<size_t> mEnqueue{ 0 };
+    alignas(64) size_t mDequeue{ 0 };           ///< writer thread only
+    std::atomic<uint64_t> mWritten{ 0 };
+    std::atomic<uint64_t> mDropped{ 0 };
+    uint64_t mReported{ 0 };                    ///< drops already announced, writer thread only
+
+    std::vector<IAppender *> mAppenders;
+    std::atomic<bool> mRunning{ true };
+    std::atomic<bool> mIdle{ false };
+    std::mutex mWakeLock;
+    std::condition_variable mWake;
+    std::thread mWriter;
+
+    bool Push(const Record &record);
+    bool Pop();
+    void Wake();
+    void ReportDropped();
+    void Run();
+};
+
+} // namespace plog
+
+#endif // __ASYNCAPPENDER_H__
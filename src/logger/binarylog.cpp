@@ -0,0 +1,431 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "binarylog.hpp"
+
+namespace {
+    /// magic, version, time base in microseconds
+    constexpr size_t kHeaderSize{ sizeof(BinaryLog::Magic) + sizeof(uint32_t) + sizeof(uint64_t) };
+    constexpr size_t kMinCapacity{ 64 * 1024 };
+
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+#ifdef _WIN32
+    /// UTF-8 copy of a wide plog message, reused per thread.
+    std::string_view narrow(const wchar_t *text) {
+        thread_local std::string buffer;
+        const int size{ WideCharToMultiByte(CP_UTF8, 0, text, -1, nullptr, 0, nullptr, nullptr) };
+        buffer.resize(size > 0 ? size - 1 : 0);
+        WideCharToMultiByte(CP_UTF8, 0, text, -1, buffer.data(), size, nullptr, nullptr);
+        return buffer;
+    }
+#else
+    std::string_view narrow(const char *text) {
+        return text;
+    }
+#endif
+}
+
+//================================= WRITER ==================================//
+
+BinaryLog *BinaryLog::Instance() {
+    static BinaryLog log;
+    return &log;
+}
+
+BinaryLog::~BinaryLog() {
+    Close();
+}
+
+bool BinaryLog::Open(const std::string &path, size_t capacity) {
+    {
+        std::lock_guard<std::mutex> lock{ mLock };
+        Release();
+#ifdef _WIN32
+        HANDLE file{ CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        mFile = INVALID_HANDLE_VALUE == file ? nullptr : file;
+        const bool opened{ nullptr != mFile };
+#else
+        mFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        const bool opened{ mFile >= 0 };
+#endif
+        if(opened && Map(std::max(capacity, kMinCapacity))) {
+            mPath = path;
+            ++mGeneration;
+            mLastTime = Now();
+            char *out{ mBase };
+            std::memcpy(out, Magic, sizeof(Magic));
+            std::memcpy(out + sizeof(Magic), &Version, sizeof(Version));
+            std::memcpy(out + sizeof(Magic) + sizeof(Version), &mLastTime, sizeof(mLastTime));
+            mUsed = kHeaderSize;
+            mOpen.store(true, std::memory_order_release);
+        } else {
+            Release();
+        }
+    }
+    return IsOpen();
+}
+
+void BinaryLog::Close() {
+    std::lock_guard<std::mutex> lock{ mLock };
+    Release();
+}
+
+bool BinaryLog::IsOpen() const {
+    return mOpen.load(std::memory_order_acquire);
+}
+
+size_t BinaryLog::Size() const {
+    std::lock_guard<std::mutex> lock{ mLock };
+    return mUsed;
+}
+
+void BinaryLog::Write(const plog::Record &record) {
+    if(!mOpen.load(std::memory_order_acquire)) {
+        return;
+    }
+    const std::string_view text{ narrow(record.getMessage()) };
+    std::lock_guard<std::mutex> lock{ mLock };
+    if(nullptr == mBase) {
+        return;
+    }
+    RecordSite &entry{ mRecordSites[record.getFile()][record.getLine()] };
+    if(nullptr == entry.site.file) {
+        entry.func = record.getFunc();
+        entry.site = Site{ record.getSeverity(), record.getFile(), record.getLine(), entry.func.c_str(), "{}", "s" };
+    }
+    if(entry.site.generation != mGeneration) {
+        Define(entry.site);
+    }
+    const plog::util::Time &time{ record.getTime() };
+    char *out{ Begin(entry.site.id, MaxVarint + text.size(),
+        static_cast<uint64_t>(time.time) * 1000000 + time.millitm * 1000, record.getTid()) };
+    if(nullptr == out) {
+        return;
+    }
+    Put(out, text);
+    mUsed = out - mBase;
+}
+
+uint64_t BinaryLog::Now() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+bool BinaryLog::Map(size_t capacity) {
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(capacity);
+    if(!SetFilePointerEx(mFile, size, nullptr, FILE_BEGIN) || !SetEndOfFile(mFile)) {
+        return false;
+    }
+    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    void *base{ nullptr != mMapping ? MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, capacity) : nullptr };
+    if(nullptr == base) {
+        Unmap();
+        return false;
+    }
+#else
+    if(0 != ::ftruncate(mFile, static_cast<off_t>(capacity))) {
+        return false;
+    }
+    void *base{ ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0) };
+    if(MAP_FAILED == base) {
+        return false;
+    }
+#endif
+    mBase = static_cast<char *>(base);
+    mCapacity = capacity;
+    return true;
+}
+
+void BinaryLog::Unmap() {
+#ifdef _WIN32
+    if(nullptr != mBase) {
+        UnmapViewOfFile(mBase);
+    }
+    if(nullptr != mMapping) {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+#else
+    if(nullptr != mBase) {
+        ::munmap(mBase, mCapacity);
+    }
+#endif
+    mBase = nullptr;
+    mCapacity = 0;
+}
+
+void BinaryLog::Release() {
+    mOpen.store(false, std::memory_order_release);
+    Unmap();
+#ifdef _WIN32
+    if(nullptr != mFile) {
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(mUsed);
+        SetFilePointerEx(mFile, size, nullptr, FILE_BEGIN);
+        SetEndOfFile(mFile);
+        CloseHandle(mFile);
+        mFile = nullptr;
+    }
+#else
+    if(mFile >= 0) {
+        if(0 != ::ftruncate(mFile, static_cast<off_t>(mUsed))) {
+            std::fprintf(stderr, "[BinaryLog] Cannot trim %s\n", mPath.c_str());
+        }
+        ::close(mFile);
+        mFile = -1;
+    }
+#endif
+    mUsed = 0;
+}
+
+bool BinaryLog::Reserve(size_t bytes) {
+    // one spare byte keeps an End tag after the last entry
+    if(mUsed + bytes < mCapacity) {
+        return true;
+    }
+    size_t capacity{ mCapacity };
+    while(mUsed + bytes >= capacity) {
+        capacity *= 2;
+    }
+    Unmap();
+    if(Map(capacity)) {
+        return true;
+    }
+    std::fprintf(stderr, "[BinaryLog] Cannot grow %s to %zu bytes, logging stopped\n", mPath.c_str(), capacity);
+    Release();
+    return false;
+}
+
+void BinaryLog::Define(Site &site) {
+    if(0 == site.id) {
+        site.id = ++mSites;
+    }
+    // the same short name plog prints for the function
+    const plog::Record record{ site.severity, site.func, site.line, site.file, nullptr, 0 };
+    const std::string_view strings[]{ site.file, record.getFunc(), site.format, site.signature };
+    size_t bytes{ 2 + 2 * MaxVarint };
+    for(const auto &string : strings) {
+        bytes += MaxVarint + string.size();
+    }
+    if(!Reserve(bytes)) {
+        return;
+    }
+
+    char *out{ mBase + mUsed };
+    *out++ = static_cast<char>(SiteTag);
+    PutVarint(out, site.id);
+    *out++ = static_cast<char>(site.severity);
+    PutVarint(out, site.line);
+    for(const auto &string : strings) {
+        Put(out, string);
+    }
+    mUsed = out - mBase;
+    site.generation = mGeneration;
+}
+
+char *BinaryLog::Begin(uint32_t site, size_t bound, uint64_t time, uint32_t tid) {
+    if(nullptr == mBase || !Reserve(1 + 3 * MaxVarint + bound)) {
+        return nullptr;
+    }
+    char *out{ mBase + mUsed };
+    *out++ = static_cast<char>(RecordTag);
+    PutVarint(out, site);
+    PutVarint(out, zigzag(static_cast<int64_t>(time - mLastTime)));
+    PutVarint(out, tid);
+    mLastTime = time;
+    return out;
+}
+
+//================================= READER ==================================//
+
+bool BinaryLogReader::Open(const std::string &path) {
+    std::ifstream file{ path, std::ios::binary };
+    if(!file) {
+        LOGE << "[BinaryLog] Cannot open " << path;
+        return false;
+    }
+    mData.assign(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+    uint32_t version{ 0 };
+    if(mData.size() < kHeaderSize || 0 != std::memcmp(mData.data(), BinaryLog::Magic, sizeof(BinaryLog::Magic))) {
+        LOGE << "[BinaryLog] " << path << " is not a binary log";
+        return false;
+    }
+    std::memcpy(&version, mData.data() + sizeof(BinaryLog::Magic), sizeof(version));
+    if(BinaryLog::Version != version) {
+        LOGE << "[BinaryLog] " << path << " has version " << version << ", expected " << BinaryLog::Version;
+        return false;
+    }
+    std::memcpy(&mTime, mData.data() + sizeof(BinaryLog::Magic) + sizeof(version), sizeof(mTime));
+    mAt = kHeaderSize;
+    mFailed = false;
+    mSites.clear();
+    return true;
+}
+
+bool BinaryLogReader::Next(Entry &entry) {
+    while(mAt < mData.size()) {
+        const uint8_t tag{ static_cast<uint8_t>(mData[mAt++]) };
+        if(BinaryLog::End == tag) {
+            return false;
+        }
+        uint64_t id{ 0 };
+        if(BinaryLog::SiteTag == tag) {
+            Site site;
+            uint64_t line{ 0 };
+            if(!Varint(id) || mAt >= mData.size()) {
+                break;
+            }
+            site.severity = static_cast<plog::Severity>(mData[mAt++]);
+            if(!Varint(line) || !String(site.file) || !String(site.func) || !String(site.format) || !String(site.signature)) {
+                break;
+            }
+            site.line = line;
+            mSites[static_cast<uint32_t>(id)] = std::move(site);
+            continue;
+        }
+
+        uint64_t delta{ 0 }, tid{ 0 };
+        if(BinaryLog::RecordTag != tag || !Varint(id) || !Varint(delta) || !Varint(tid)) {
+            break;
+        }
+        const auto site{ mSites.find(static_cast<uint32_t>(id)) };
+        if(mSites.end() == site) {
+            break;
+        }
+        mTime += unzigzag(delta);
+        entry.time = mTime;
+        entry.tid = static_cast<uint32_t>(tid);
+        entry.site = &site->second;
+        entry.text.clear();
+
+        const std::string &format{ site->second.format };
+        const std::string &signature{ site->second.signature };
+        size_t argument{ 0 };
+        bool ok{ true };
+        for(size_t i = 0; i < format.size() && ok; ++i) {
+            const char c{ format[i] };
+            const char next{ i + 1 < format.size() ? format[i + 1] : '\0' };
+            if('{' == c && '}' == next && argument < signature.size()) {
+                ok = Argument(signature[argument++], entry.text);
+                ++i;
+            } else {
+                entry.text += c;
+                i += ('{' == c && '{' == next) || ('}' == c && '}' == next) ? 1 : 0;
+            }
+        }
+        // arguments without a placeholder are appended
+        while(ok && argument < signature.size()) {
+            entry.text += ' ';
+            ok = Argument(signature[argument++], entry.text);
+        }
+        if(!ok) {
+            break;
+        }
+        return true;
+    }
+    mFailed = mAt < mData.size();
+    return false;
+}
+
+bool BinaryLogReader::Failed() const {
+    return mFailed;
+}
+
+bool BinaryLogReader::Varint(uint64_t &value) {
+    value = 0;
+    for(int shift = 0; shift < 64 && mAt < mData.size(); shift += 7) {
+        const uint8_t byte{ static_cast<uint8_t>(mData[mAt++]) };
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if(0 == (byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BinaryLogReader::String(std::string &value) {
+    uint64_t size{ 0 };
+    if(!Varint(size) || size > mData.size() - mAt) {
+        return false;
+    }
+    value.assign(mData.data() + mAt, size);
+    mAt += size;
+    return true;
+}
+
+bool BinaryLogReader::Argument(char code, std::string &out) {
+    uint64_t value{ 0 };
+    char text[32];
+    switch(code) {
+        case 'b':
+        case 'c':
+            if(mAt >= mData.size()) {
+                return false;
+            }
+            if('b' == code) {
+                out += 0 != mData[mAt++] ? "true" : "false";
+            } else {
+                out += mData[mAt++];
+            }
+            return true;
+        case 'i':
+            if(!Varint(value)) {
+                return false;
+            }
+            out += std::to_string(unzigzag(value));
+            return true;
+        case 'u':
+            if(!Varint(value)) {
+                return false;
+            }
+            out += std::to_string(value);
+            return true;
+        case 'p':
+            if(!Varint(value)) {
+                return false;
+            }
+            std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(value));
+            out += text;
+            return true;
+        case 'd': {
+            double number{ 0.0 };
+            if(mData.size() - mAt < sizeof(number)) {
+                return false;
+            }
+            std::memcpy(&number, mData.data() + mAt, sizeof(number));
+            mAt += sizeof(number);
+            std::snprintf(text, sizeof(text), "%g", number);
+            out += text;
+            return true;
+        }
+        case 's': {
+            std::string string;
+            if(!String(string)) {
+                return false;
+            }
+            out += string;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
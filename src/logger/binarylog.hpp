@@ -0,0 +1,341 @@
+#ifndef __BINARYLOG_H__
+#define __BINARYLOG_H__
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <plog/Appenders/IAppender.h>
+#include <plog/Log.h>
+#include <plog/Record.h>
+
+#include "logmacros.hpp"
+
+/**
+ * Binary log file: records are a call-site id, a timestamp, a thread id and
+ * the raw argument bytes, appended to a memory-mapped file. Each call site
+ * (severity, file, line, function, format string and argument types) is
+ * written once per file, the first time it logs, so the file decodes on its
+ * own (see BinaryLogReader and tools/logdecode).
+ *
+ *   BLOGI("[Mash] {} vertices, {} indices from {}", vertices, indices, path);
+ *
+ * The file gets a lock, a few varints and a copy of the string arguments.
+ * BLOG records also go to the other plog appenders (console, ImGui, the text
+ * file when no binary log is open): for those the text is expanded on the
+ * calling thread, with plain appends instead of an ostream, and the binary
+ * appender skips them. Pages hit the file through the OS, so what was logged
+ * before a crash is still there.
+ *
+ * Plain LOG records reach the file through BinaryAppender as their finished
+ * message, one "{}" string per record: only BLOG sites store arguments
+ * instead of text, so hot paths should use BLOG.
+ *
+ * Format strings use "{}" for each argument in order, "{{" and "}}" for
+ * braces. Arguments may be integers, enums, floating point, bool, char,
+ * pointers and strings.
+ */
+class BinaryLog {
+public:
+    static constexpr char Magic[4]{ 'B', 'L', 'O', 'G' };
+    static constexpr uint32_t Version{ 1 };
+
+    enum Tag : uint8_t {
+        End,        ///< unused tail of the mapping
+        SiteTag,
+        RecordTag
+    };
+
+    /// Static state of one BLOG statement.
+    struct Site {
+        plog::Severity severity;
+        const char *file;
+        size_t line;
+        const char *func;
+        const char *format{ nullptr };
+        const char *signature{ nullptr };   ///< one type code per argument
+        uint32_t id{ 0 };                   ///< 0 until first use
+        uint32_t generation{ 0 };           ///< file the definition was last written to
+    };
+
+    static BinaryLog *Instance();
+    ~BinaryLog();
+
+    /// Maps path, initially capacity bytes; it grows by doubling. Logs nothing,
+    /// it runs before plog is set up: the caller reports the result.
+    bool Open(const std::string &path, size_t capacity = 16u << 20);
+    /// Trims the file to what was written and unmaps it.
+    void Close();
+    bool IsOpen() const;
+    /// Bytes written to the current file.
+    size_t Size() const;
+
+    template<size_t N, class... Args>
+    void Write(Site &site, const char (&format)[N], const Args &...args) {
+        static constexpr char signature[]{ TypeCode<Args>()..., '\0' };
+        if(!mOpen.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock{ mLock };
+        if(nullptr == mBase) {
+            return;
+        }
+        if(site.generation != mGeneration) {
+            site.format = format;
+            site.signature = signature;
+            Define(site);
+        }
+        char *out{ Begin(site.id, (0 + ... + Bound(args)), Now(), plog::util::gettid()) };
+        if(nullptr == out) {
+            return;
+        }
+        (Put(out, args), ...);
+        mUsed = out - mBase;
+    }
+
+    /// A plog record: its message becomes the single argument of a "{}" site
+    /// keyed by file and line, time and thread are the record's.
+    void Write(const plog::Record &record);
+
+    /// Sends a BLOG record as text to the logger's appenders, the way
+    /// BinaryLogReader prints it. The record's object marks it for BinaryAppender.
+    template<int instanceId, class... Args>
+    static void Forward(const Site &site, const char *format, const Args &...args) {
+        thread_local std::string text;
+        text.clear();
+        Expand(text, format, args...);
+        plog::Record record{ site.severity, site.func, site.line, site.file, Instance(), instanceId };
+        record << text;
+        *plog::get<instanceId>() += record;
+    }
+
+    //================================ ENCODING =================================//
+
+    template<class T>
+    static constexpr char TypeCode() {
+        using U = std::decay_t<T>;
+        if constexpr(std::is_same_v<U, bool>) {
+            return 'b';
+        } else if constexpr(std::is_same_v<U, char>) {
+            return 'c';
+        } else if constexpr(std::is_enum_v<U> || (std::is_integral_v<U> && std::is_signed_v<U>)) {
+            return 'i';
+        } else if constexpr(std::is_integral_v<U>) {
+            return 'u';
+        } else if constexpr(std::is_floating_point_v<U>) {
+            return 'd';
+        } else if constexpr(std::is_convertible_v<const U &, std::string_view>) {
+            return 's';
+        } else if constexpr(std::is_pointer_v<U>) {
+            return 'p';
+        } else {
+            static_assert(std::is_void_v<U>, "BLOG takes integers, enums, floats, bool, char, pointers and strings");
+            return '\0';
+        }
+    }
+
+    static void PutVarint(char *&out, uint64_t value) {
+        while(value >= 0x80) {
+            *out++ = static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<char>(value);
+    }
+
+private:
+    static constexpr size_t MaxVarint{ 10 };
+
+    static void Expand(std::string &out, const char *format) {
+        for(; '\0' != *format; ++format) {
+            out += *format;
+            format += ('{' == format[0] && '{' == format[1]) || ('}' == format[0] && '}' == format[1]) ? 1 : 0;
+        }
+    }
+
+    template<class T, class... Rest>
+    static void Expand(std::string &out, const char *format, const T &value, const Rest &...rest) {
+        for(; '\0' != *format; ++format) {
+            if('{' == format[0] && '}' == format[1]) {
+                Append(out, value);
+                Expand(out, format + 2, rest...);
+                return;
+            }
+            out += *format;
+            format += ('{' == format[0] && '{' == format[1]) || ('}' == format[0] && '}' == format[1]) ? 1 : 0;
+        }
+        // arguments without a placeholder are appended
+        out += ' ';
+        Append(out, value);
+        Expand(out, format, rest...);
+    }
+
+    template<class T>
+    static void Append(std::string &out, const T &value) {
+        constexpr char code{ TypeCode<T>() };
+        char text[32];
+        if constexpr('b' == code) {
+            out += value ? "true" : "false";
+        } else if constexpr('c' == code) {
+            out += value;
+        } else if constexpr('i' == code) {
+            out += std::to_string(static_cast<int64_t>(value));
+        } else if constexpr('u' == code) {
+            out += std::to_string(static_cast<uint64_t>(value));
+        } else if constexpr('d' == code) {
+            std::snprintf(text, sizeof(text), "%g", static_cast<double>(value));
+            out += text;
+        } else if constexpr('s' == code) {
+            out += std::string_view{ value };
+        } else {
+            std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(value)));
+            out += text;
+        }
+    }
+
+    mutable std::mutex mLock;
+    std::atomic<bool> mOpen{ false };   ///< lets writes skip the lock while no file is open
+    std::string mPath;
+    char *mBase{ nullptr };
+    size_t mCapacity{ 0 };
+    size_t mUsed{ 0 };
+    uint64_t mLastTime{ 0 };        ///< microseconds, records store the delta
+    uint32_t mGeneration{ 0 };      ///< bumped by Open, sites are redefined per file
+    uint32_t mSites{ 0 };
+
+    struct RecordSite {
+        Site site;
+        std::string func;
+    };
+    std::unordered_map<const char *, std::unordered_map<size_t, RecordSite>> mRecordSites;   ///< plog records, by file then line
+
+#ifdef _WIN32
+    void *mFile{ nullptr };
+    void *mMapping{ nullptr };
+#else
+    int mFile{ -1 };
+#endif
+
+    BinaryLog() = default;
+
+    static uint64_t Now();
+
+    /// Sizes the file to capacity and maps all of it.
+    bool Map(size_t capacity);
+    void Unmap();
+    /// Unmaps, trims the file to mUsed and closes it.
+    void Release();
+    /// Room for bytes more, growing the mapping if needed.
+    bool Reserve(size_t bytes);
+    void Define(Site &site);
+    /// Reserves a record of up to bound argument bytes and writes its header,
+    /// nullptr when the file cannot grow. time in microseconds since the epoch.
+    char *Begin(uint32_t site, size_t bound, uint64_t time, uint32_t tid);
+
+    template<class T>
+    static size_t Bound(const T &value) {
+        if constexpr('s' == TypeCode<T>()) {
+            return MaxVarint + std::string_view{ value }.size();
+        } else {
+            return MaxVarint;
+        }
+    }
+
+    template<class T>
+    static void Put(char *&out, const T &value) {
+        constexpr char code{ TypeCode<T>() };
+        if constexpr('b' == code || 'c' == code) {
+            *out++ = static_cast<char>(value);
+        } else if constexpr('i' == code) {
+            const int64_t signedValue{ static_cast<int64_t>(value) };
+            PutVarint(out, (static_cast<uint64_t>(signedValue) << 1) ^ static_cast<uint64_t>(signedValue >> 63));
+        } else if constexpr('u' == code) {
+            PutVarint(out, static_cast<uint64_t>(value));
+        } else if constexpr('d' == code) {
+            const double number{ static_cast<double>(value) };
+            std::memcpy(out, &number, sizeof(number));
+            out += sizeof(number);
+        } else if constexpr('s' == code) {
+            const std::string_view text{ value };
+            PutVarint(out, text.size());
+            std::memcpy(out, text.data(), text.size());
+            out += text.size();
+        } else {
+            PutVarint(out, reinterpret_cast<uintptr_t>(value));
+        }
+    }
+};
+
+/**
+ * Reads a BinaryLog file back. Records come out in file order with their
+ * site and the format string already expanded.
+ */
+class BinaryLogReader {
+public:
+    struct Site {
+        plog::Severity severity;
+        size_t line;
+        std::string file;
+        std::string func;
+        std::string format;
+        std::string signature;
+    };
+    struct Entry {
+        uint64_t time;      ///< microseconds since the epoch
+        uint32_t tid;
+        const Site *site;
+        std::string text;
+    };
+
+    bool Open(const std::string &path);
+    /// False at the end of the file or on a corrupt record (see Failed).
+    bool Next(Entry &entry);
+    bool Failed() const;
+
+private:
+    std::vector<char> mData;
+    size_t mAt{ 0 };
+    bool mFailed{ false };
+    uint64_t mTime{ 0 };
+    std::unordered_map<uint32_t, Site> mSites;
+
+    bool Varint(uint64_t &value);
+    bool String(std::string &value);
+    bool Argument(char code, std::string &out);
+};
+
+namespace plog {
+
+/// Sends plog records to the binary log instead of a text file.
+class BinaryAppender : public IAppender {
+public:
+    void write(const Record &record) override {
+        // BLOG wrote those itself, with their arguments
+        if(BinaryLog::Instance() != record.getObject()) {
+            BinaryLog::Instance()->Write(record);
+        }
+    }
+};
+
+} // namespace plog
+
+// one `if(...) {;} else` like IF_PLOG_, so an else after BLOG binds to the caller's if
+#define BLOG_(instanceId, severity, ...) \
+    if(static BinaryLog::Site blogSite{ severity, __FILE__, __LINE__, PLOG_GET_FUNC() }; \
+            !LOG_ENABLED_(instanceId, severity)) {;} else \
+        BinaryLog::Instance()->Write(blogSite, __VA_ARGS__), BinaryLog::Forward<instanceId>(blogSite, __VA_ARGS__)
+#define BLOG(severity, ...) BLOG_(PLOG_DEFAULT_INSTANCE_ID, severity, __VA_ARGS__)
+
+#define BLOGV(...) BLOG(plog::verbose, __VA_ARGS__)
+#define BLOGD(...) BLOG(plog::debug, __VA_ARGS__)
+#define BLOGI(...) BLOG(plog::info, __VA_ARGS__)
+#define BLOGW(...) BLOG(plog::warning, __VA_ARGS__)
+#define BLOGE(...) BLOG(plog::error, __VA_ARGS__)
+#define BLOGF(...) BLOG(plog::fatal, __VA_ARGS__)
+
+#endif // __BINARYLOG_H__
@@ -0,0 +1,215 @@
+#ifndef __IMGUIAPPENDER_H__
+#define __IMGUIAPPENDER_H__
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <string_view>
+#include <plog/Appenders/IAppender.h>
+#include <plog/Record.h>
+
+#include "logutilites.hpp"
+
+namespace plog {
+
+/**
+ * "[hh:mm:ss.mmm][SEVER][Name] message\n" as UTF-8, built without streams
+ * or heap allocations: Size measures the text and Write fills a buffer the
+ * caller provides (the log window writes straight into its arena). The
+ * clock part is formatted once per second per thread.
+ */
+class SimpleFormatter {
+public:
+    static size_t Size(const Record &record) {
+        Counter out;
+        Emit(record, out);
+        return out.size;
+    }
+
+    /// Writes at most size bytes, the text is cut there.
+    static void Write(const Record &record, char *buffer, size_t size) {
+        Writer out{ buffer, buffer + size };
+        Emit(record, out);
+    }
+
+private:
+    struct Counter {
+        size_t size{ 0 };
+        void Put(char) { ++size; }
+        void Put(std::string_view text) { size += text.size(); }
+    };
+    struct Writer {
+        char *at;
+        char *end;
+        void Put(char c) {
+            if (at < end) {
+                *at++ = c;
+            }
+        }
+        void Put(std::string_view text) {
+            const size_t count{ std::min(text.size(), static_cast<size_t>(end - at)) };
+            std::memcpy(at, text.data(), count);
+            at += count;
+        }
+    };
+
+    template<class Out>
+    static void Emit(const Record &record, Out &out) {
+        out.Put(Clock(record.getTime()));
+        const std::string_view severity{ severityToString(record.getSeverity()) };
+        out.Put('[');
+        out.Put(severity);
+        for (size_t i = severity.size(); i < 5; ++i) {
+            out.Put(' ');
+        }
+        out.Put(']');
+        EmitName(record, out);
+        out.Put(' ');
+        EmitText(record.getMessage(), out);
+        out.Put('\n');
+    }
+
+    template<class Out>
+    static void EmitName(const Record &record, Out &out) {
+        const std::string_view name{ record.getFunc() };
+        out.Put('[');
+        if (name.find("::") == std::string_view::npos) {
+            out.Put(name);
+        } else if (name.find("anon") != 0) {
+            out.Put("Anonymous@");
+            EmitNumber(record.getLine(), 10, out);
+        } else {
+            if (nullptr != record.getObject()) {
+                out.Put("0x");
+            }
+            EmitNumber(reinterpret_cast<uintptr_t>(record.getObject()), 16, out);
+            EmitNumber(record.getLine(), 10, out);
+        }
+        out.Put(']');
+    }
+
+    template<class Out>
+    static void EmitNumber(uint64_t value, int base, Out &out) {
+        char digits[24];
+        const auto result{ std::to_chars(digits, digits + sizeof(digits), value, base) };
+        out.Put(std::string_view{ digits, static_cast<size_t>(result.ptr - digits) });
+    }
+
+    template<class Out>
+    static void EmitText(const char *text, Out &out) {
+        out.Put(std::string_view{ text });
+    }
+
+    /// UTF-16 (wchar_t builds) to UTF-8, lone surrogates become U+FFFD.
+    template<class Out>
+    static void EmitText(const wchar_t *text, Out &out) {
+        while (*text) {
+            uint32_t code{ static_cast<uint32_t>(*text++) };
+            if (sizeof(wchar_t) == 2 && code >= 0xD800 && code <= 0xDFFF) {
+                const uint32_t low{ static_cast<uint32_t>(*text) };
+                if (code <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    ++text;
+                } else {
+                    code = 0xFFFD;
+                }
+            }
+            if (code < 0x80) {
+                out.Put(static_cast<char>(code));
+            } else if (code < 0x800) {
+                out.Put(static_cast<char>(0xC0 | code >> 6));
+                out.Put(static_cast<char>(0x80 | (code & 0x3F)));
+            } else if (code < 0x10000) {
+                out.Put(static_cast<char>(0xE0 | code >> 12));
+                out.Put(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+                out.Put(static_cast<char>(0x80 | (code & 0x3F)));
+            } else {
+                out.Put(static_cast<char>(0xF0 | code >> 18));
+                out.Put(static_cast<char>(0x80 | (code >> 12 & 0x3F)));
+                out.Put(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+                out.Put(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+        }
+    }
+
+    /// "[hh:mm:ss.mmm]", valid until the next call on this thread.
+    static std::string_view Clock(const util::Time &time) {
+        thread_local time_t second{ -1 };
+        thread_local char text[]{ "[00:00:00.000]" };
+        auto put2 = [](char *at, int value) {
+            at[0] = static_cast<char>('0' + value / 10 % 10);
+            at[1] = static_cast<char>('0' + value % 10);
+        };
+        if (time.time != second) {
+            tm t;
+            util::localtime_s(&t, &time.time);
+            put2(text + 1, t.tm_hour);
+            put2(text + 4, t.tm_min);
+            put2(text + 7, t.tm_sec);
+            second = time.time;
+        }
+        text[10] = static_cast<char>('0' + time.millitm / 100 % 10);
+        put2(text + 11, time.millitm % 100);
+        return { text, sizeof(text) - 1 };
+    }
+};
+
+/**
+ * Feeds the log window. Each record is measured and then formatted straight
+ * into the window's arena, so after warm-up a record costs no allocation.
+ * Records that arrive before the window exists are kept until it does.
+ */
+template<class Formatter>
+class ImGuiAppender : public IAppender {
+public:
+    explicit ImGuiAppender(Utilites::ImGuiLogVisualizer::Ref visualizer)
+        : mVisualizer{ visualizer }
+    {}
+
+    void write(const Record &record) override {
+        std::lock_guard<std::mutex> lock{ mLock };
+        auto visualizer{ mVisualizer.lock() };
+        const std::string_view tag{ GetTag(record.getMessage()) };
+        if (nullptr == visualizer) {
+            std::string text(Formatter::Size(record), '\0');
+            Formatter::Write(record, text.data(), text.size());
+            mCache.push({ record.getSeverity(), std::string{ tag }, std::move(text) });
+            return;
+        }
+        while (!mCache.empty()) {
+            const auto &log{ mCache.front() };
+            visualizer->Roll(log.severity, log.tag, log.text);
+            mCache.pop();
+        }
+        visualizer->Emplace(record.getSeverity(), tag, Formatter::Size(record), [&record](char *out, size_t size) {
+            Formatter::Write(record, out, size);
+        });
+    }
+
+private:
+    std::mutex mLock;
+    Utilites::ImGuiLogVisualizer::WeakRef mVisualizer;
+    std::queue<Utilites::ImGuiLogVisualizer::Log> mCache;
+    std::array<char, 32> mTag;
+
+    /// "[Mash]" of "[Mash] Loaded ...", empty when the message has no such prefix.
+    template<class Char>
+    std::string_view GetTag(const Char *message) {
+        if (static_cast<Char>('[') != message[0]) {
+            return {};
+        }
+        for (size_t i = 0; i < mTag.size() && static_cast<uint32_t>(message[i]) - 0x21 < 0x5E; ++i) {
+            mTag[i] = static_cast<char>(message[i]);
+            if (']' == mTag[i]) {
+                return { mTag.data(), i + 1 };
+            }
+        }
+        return {};
+    }
+};
+
+} // namespace plog
+
+#endif // __IMGUIAPPENDER_H__
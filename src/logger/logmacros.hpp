@@ -0,0 +1,135 @@
+#ifndef __LOGMACROS_H__
+#define __LOGMACROS_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <plog/Log.h>
+
+/**
+ * Compile-time log level. Statements less severe than LOG_MIN_SEVERITY
+ * (plog::info means debug and verbose go) become `if(false)`: their stream
+ * and arguments are dead code and the optimizer drops them, strings and all.
+ * CMake sets it per configuration, see LOG_MIN_SEVERITY there.
+ *
+ * Every plog macro goes through IF_PLOG_, and BLOG* and the site macros
+ * below test LOG_ENABLED_ themselves, so they all honour it. incs.hpp
+ * includes this header ahead of any plog use.
+ *
+ * Each macro is a single `if (!enabled) {;} else statement` like plog's, so
+ * `if (x) LOG_EVERY_N(...) << ...; else ...` binds the way it reads.
+ */
+#ifndef LOG_MIN_SEVERITY
+#define LOG_MIN_SEVERITY plog::verbose
+#endif
+
+#define LOG_ENABLED_(instanceId, severity) \
+    ((severity) <= LOG_MIN_SEVERITY && plog::get<instanceId>() && plog::get<instanceId>()->checkSeverity(severity))
+
+#undef IF_PLOG_
+#define IF_PLOG_(instanceId, severity) if (!LOG_ENABLED_(instanceId, severity)) {;} else
+
+namespace Utilites {
+
+/**
+ * State of one rate-limited or sampled log statement, a function-local
+ * static created by the macros below. Lock free, the statement may run on
+ * any thread; only statements that pass the severity check touch it.
+ */
+class LogSite {
+public:
+    /// The 1st, (n+1)th, (2n+1)th... call; every call for n of 0 or 1.
+    bool EveryN(uint32_t n) {
+        return n <= 1 || 0 == mCount.fetch_add(1, std::memory_order_relaxed) % n;
+    }
+
+    /// The first n calls, then never again.
+    bool FirstN(uint32_t n) {
+        return mCount.load(std::memory_order_relaxed) < n && mCount.fetch_add(1, std::memory_order_relaxed) < n;
+    }
+
+    /// At most one call per interval; the rest are counted and reported by
+    /// the next call let through (see Suppressed).
+    bool Every(std::chrono::milliseconds interval) {
+        const int64_t now{ std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count() };
+        int64_t next{ mNext.load(std::memory_order_relaxed) };
+        if (now < next || !mNext.compare_exchange_strong(next, now + interval.count(), std::memory_order_relaxed)) {
+            mCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        mSuppressed.store(mCount.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Calls skipped by Every before the one that went through.
+    uint32_t Suppressed() const {
+        return mSuppressed.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> mCount{ 0 };
+    std::atomic<int64_t> mNext{ 0 };
+    std::atomic<uint32_t> mSuppressed{ 0 };
+};
+
+/// Record of LOG_EVERY_MS: streams into the plog record and appends the
+/// suppressed count once the statement's message is complete.
+class SuppressedRecord {
+public:
+    SuppressedRecord(uint32_t suppressed, plog::Severity severity, const char *func, size_t line, const char *file,
+            const void *object, int instanceId)
+        : mSuppressed{ suppressed }
+        , mRecord{ severity, func, line, file, object, instanceId }
+    {}
+
+    SuppressedRecord &ref() {
+        return *this;
+    }
+
+    template<class T>
+    SuppressedRecord &operator<<(const T &value) {
+        mRecord << value;
+        return *this;
+    }
+
+    operator plog::Record &() {
+        if (0 != mSuppressed) {
+            mRecord << " (" << mSuppressed << " suppressed)";
+            mSuppressed = 0;
+        }
+        return mRecord;
+    }
+
+private:
+    uint32_t mSuppressed;
+    plog::Record mRecord;
+};
+
+} // namespace Utilites
+
+/// The site is only asked to admit a call that passes the severity check.
+#define IF_LOG_SITE_(instanceId, severity, admit) \
+    if (static Utilites::LogSite logSite; !LOG_ENABLED_(instanceId, severity) || !logSite.admit) {;} else
+
+#define LOG_SITE_RECORD_(instanceId, severity) \
+    (*plog::get<instanceId>()) += plog::Record(severity, PLOG_GET_FUNC(), __LINE__, __FILE__, PLOG_GET_THIS(), instanceId).ref()
+
+/// Sampling: logs one call in n, starting with the first.
+///   LOG_EVERY_N(plog::debug, 100) << "[Jobs] Queue depth " << depth;
+#define LOG_EVERY_N_(instanceId, severity, n) IF_LOG_SITE_(instanceId, severity, EveryN(n)) LOG_SITE_RECORD_(instanceId, severity)
+#define LOG_EVERY_N(severity, n) LOG_EVERY_N_(PLOG_DEFAULT_INSTANCE_ID, severity, n)
+
+/// Logs the first n calls only.
+#define LOG_FIRST_N_(instanceId, severity, n) IF_LOG_SITE_(instanceId, severity, FirstN(n)) LOG_SITE_RECORD_(instanceId, severity)
+#define LOG_FIRST_N(severity, n) LOG_FIRST_N_(PLOG_DEFAULT_INSTANCE_ID, severity, n)
+
+/// Rate limit: at most one record per ms milliseconds; a record that follows
+/// skipped calls ends with "(N suppressed)".
+#define LOG_EVERY_MS_(instanceId, severity, ms) \
+    IF_LOG_SITE_(instanceId, severity, Every(std::chrono::milliseconds(ms))) \
+        (*plog::get<instanceId>()) += Utilites::SuppressedRecord{ logSite.Suppressed(), \
+            severity, PLOG_GET_FUNC(), __LINE__, __FILE__, PLOG_GET_THIS(), instanceId }.ref()
+#define LOG_EVERY_MS(severity, ms) LOG_EVERY_MS_(PLOG_DEFAULT_INSTANCE_ID, severity, ms)
+
+#endif // __LOGMACROS_H__
@@ -1,68 +1,18 @@
 #include <incs.hpp>
-#include <locale>
-#include <codecvt>
 
 #include <filesystem>
 #include <plog/Appenders/ColorConsoleAppender.h>
 #include <plog/Record.h>
 
+#include "asyncappender.hpp"
+#include "binarylog.hpp"
+#include "imguiappender.hpp"
 #include "logutilites.hpp"
 
 namespace fs = std::filesystem;
 
 namespace plog {
 
-template<class Formatter>
-class ImGuiAppender : public IAppender {
-public:
-    explicit ImGuiAppender(Utilites::ImGuiLogVisualizer::Ref visualizer)
-        : mVisualizer{ visualizer }
-    {}
-
-    void write(const Record &record) {
-        auto visualizer{ mVisualizer.lock() };
-        if (nullptr == visualizer) {
-            mCache.emplace(
-                GetSeverityColor(record.getSeverity()),
-                convert(Formatter::format(record))
-            );
-            return;
-        }
-        while (!mCache.empty()) {
-            auto [clr, msg] { mCache.front() };
-            mCache.pop();
-            visualizer->Roll(
-                std::move(clr),
-                std::move(msg)
-            );
-        }
-        visualizer->Roll(
-            GetSeverityColor(record.getSeverity()),
-            convert(Formatter::format(record))
-        );
-    }
-
-private:
-    Utilites::ImGuiLogVisualizer::WeakRef mVisualizer;
-    std::queue<Utilites::ImGuiLogVisualizer::Log> mCache;
-
-    ImVec4 GetSeverityColor(Severity severity) {
-        switch (severity) {
-            case fatal: return ImVec4{ 0.9, 0.0, 0.1, 1.0 };
-            case error: return ImVec4{ 0.7, 0.2, 0.3, 1.0 };
-            case warning: return ImVec4{ 0.9, 0.5, 0.1, 1.0 };
-            case info: return ImVec4{ 0.1, 0.7, 0.3, 1.0 };
-            default: return ImVec4{ 0.9, 0.9, 0.9, 1.0};
-        }
-        return {};
-    }
-    std::string convert(const util::nstring &str) const {
-        using codec = std::codecvt_utf8<util::nchar>;
-        std::wstring_convert<codec, util::nchar> conv;
-        return conv.to_bytes(str);
-    }
-};
-
 class DefaultFormatter {
 public:
     static util::nstring header() { return {}; }
@@ -80,86 +30,404 @@ public:
     }
 };
 
-class SimpleFormatter {
-public:
-    static util::nstring header() { return {}; }
-    static util::nstring format(const Record &record) {
-        tm t;
-        util::localtime_s(&t, &record.getTime().time);
-        util::nostringstream ss;
-        ss << PLOG_NSTR("[") << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_hour << PLOG_NSTR(":") << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_min << PLOG_NSTR(":") << std::setfill(PLOG_NSTR('0')) << std::setw(2) << t.tm_sec << PLOG_NSTR(".") << std::setfill(PLOG_NSTR('0')) << std::setw(3) << record.getTime().millitm << PLOG_NSTR("]");
-        ss << PLOG_NSTR("[") << std::setfill(PLOG_NSTR(' ')) << std::setw(5) << std::left << severityToString(record.getSeverity()) << PLOG_NSTR("]");
-        ss << GetName(record) << PLOG_NSTR(" ");
-        ss << record.getMessage() << PLOG_NSTR("\n");
-        return ss.str();
-    }
+} // namespace plog
 
-private:
-    static util::nstring GetName(const Record &record) {
-        util::nostringstream ss;
-        ss << record.getFunc();
-        util::nstring name{ ss.str() };
-        util::nostringstream result;
-        if (auto cur{ name.find(PLOG_NSTR("::")) }; cur != util::nstring::npos) {
-            if (name.find(PLOG_NSTR("anon"))) {
-                result << PLOG_NSTR("[Anonymous@");
-            } else {
-                result << PLOG_NSTR("[") << record.getObject();
-            }
-            result << record.getLine() << PLOG_NSTR("]");
-        } else {
-            result << PLOG_NSTR("[") << name << PLOG_NSTR("]");
+namespace Utilites {
+
+namespace {
+    constexpr auto kFilterBudget{ std::chrono::milliseconds(4) };
+    constexpr size_t kScanChunk{ 1024 };    ///< rows checked between two looks at the clock
+
+    constexpr plog::Severity kShownSeverities[]{ plog::fatal, plog::error, plog::warning, plog::info, plog::debug, plog::verbose };
+
+    ImVec4 severityColor(plog::Severity severity) {
+        switch (severity) {
+            case plog::fatal: return ImVec4{ 0.9, 0.0, 0.1, 1.0 };
+            case plog::error: return ImVec4{ 0.7, 0.2, 0.3, 1.0 };
+            case plog::warning: return ImVec4{ 0.9, 0.5, 0.1, 1.0 };
+            case plog::info: return ImVec4{ 0.1, 0.7, 0.3, 1.0 };
+            default: return ImVec4{ 0.9, 0.9, 0.9, 1.0};
         }
-        return result.str();
     }
-};
 
-} // namespace plog
+    /// True when every row narrower keeps is also kept by filter.
+    bool narrows(const ImGuiLogVisualizer::Filter &narrower, const ImGuiLogVisualizer::Filter &filter) {
+        return (narrower.severities & ~filter.severities) == 0
+            && (filter.tag.empty() || narrower.tag == filter.tag)
+            && (filter.text.empty() || (!filter.regex && !narrower.regex
+                && narrower.text.find(filter.text) != std::string::npos));
+    }
+}
 
-namespace Utilites {
+ImGuiLogVisualizer::ImGuiLogVisualizer()
+    : ImGuiLogVisualizer{ Limits{} }
+{}
 
-void ImGuiLogVisualizer::Roll(ImVec4 &&clr, std::string &&msg) {
-    mRollingLog.emplace_back(clr, msg);
-    mUpdated = true;
+ImGuiLogVisualizer::ImGuiLogVisualizer(const Limits &limits)
+    : mArena(std::max<size_t>(limits.bytes, 1))
+    , mLines(std::max<size_t>(limits.lines, 1))
+{}
+
+void ImGuiLogVisualizer::Roll(plog::Severity severity, std::string_view tag, std::string_view msg) {
+    Emplace(severity, tag, msg.size(), [msg](char *out, size_t size) {
+        std::copy_n(msg.data(), size, out);
+    });
 }
 void ImGuiLogVisualizer::Clear() {
-    mRollingLog = {};
+    std::lock_guard<std::mutex> lock{ mLock };
+    while (mFirst < mNext) {
+        Evict();
+    }
+    mCandidates.clear();
+    mScanAll = false;
 }
 void ImGuiLogVisualizer::Draw() {
     ImGui::Begin("Logs");
-    for (const auto &[clr, msg] : mRollingLog) {
-        ImGui::TextColored(clr, "%s", msg.c_str());
+    std::lock_guard<std::mutex> lock{ mLock };
+    DrawFilter();
+    Scan(std::chrono::steady_clock::now() + kFilterBudget);
+
+    ImGui::BeginChild("Rows");
+    // only the visible rows are submitted, the cost does not depend on the row count
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(mFiltered ? mView.size() : mNext - mFirst));
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            const uint64_t id{ mFiltered ? mView[i] : mFirst + i };
+            const Line &line{ mLines[id % mLines.size()] };
+            const char *text{ mArena.data() + line.begin % mArena.size() };
+            ImGui::PushStyleColor(ImGuiCol_Text, severityColor(line.severity));
+            ImGui::TextUnformatted(text, text + line.length);
+            ImGui::PopStyleColor();
+        }
     }
+    clipper.End();
     if (mUpdated) {
         ImGui::SetScrollY(ImGui::GetScrollMaxY());
         mUpdated = false;
     }
+    ImGui::EndChild();
     ImGui::End();
 
 }
 
+void ImGuiLogVisualizer::SetFilter(const Filter &filter) {
+    std::lock_guard<std::mutex> lock{ mLock };
+    ApplyFilter(filter);
+}
+
+ImGuiLogVisualizer::Filter ImGuiLogVisualizer::GetFilter() const {
+    std::lock_guard<std::mutex> lock{ mLock };
+    return mFilter;
+}
+
+size_t ImGuiLogVisualizer::Lines() const {
+    std::lock_guard<std::mutex> lock{ mLock };
+    return mNext - mFirst;
+}
+
+size_t ImGuiLogVisualizer::Matches() const {
+    std::lock_guard<std::mutex> lock{ mLock };
+    return mFiltered ? mView.size() : mNext - mFirst;
+}
+
+bool ImGuiLogVisualizer::Filtering() const {
+    std::lock_guard<std::mutex> lock{ mLock };
+    return Scanning();
+}
+
+//================================ STORAGE ================================//
+
+uint16_t ImGuiLogVisualizer::TagIndex(std::string_view tag) {
+    if (tag.empty()) {
+        return 0;
+    }
+    for (size_t i = 1; i < mTags.size(); ++i) {
+        if (mTags[i] == tag) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    if (mTags.size() >= MaxTags) {
+        return 0;
+    }
+    if (mFilter.tag == tag) {
+        mFilterTag = static_cast<int>(mTags.size());
+    }
+    mTags.emplace_back(tag);
+    mTagRows.emplace_back();
+    return static_cast<uint16_t>(mTags.size() - 1);
+}
+
+uint64_t ImGuiLogVisualizer::Reserve(size_t size) {
+    const size_t capacity{ mArena.size() };
+    // a record never wraps around the arena end, so each row can be drawn in one piece
+    uint64_t begin{ mEnd };
+    if (begin % capacity + size > capacity) {
+        begin += capacity - begin % capacity;
+    }
+    while (mFirst < mNext && begin + size - mLines[mFirst % mLines.size()].begin > capacity) {
+        Evict();
+    }
+    mEnd = begin + size;
+    return begin;
+}
+
+void ImGuiLogVisualizer::Commit(plog::Severity severity, uint16_t tag, uint64_t begin, size_t size) {
+    // one row per text line: rows share a height and the view can skip to any of them
+    const char *text{ mArena.data() + begin % mArena.size() };
+    size_t from{ 0 };
+    do {
+        const void *newline{ std::memchr(text + from, '\n', size - from) };
+        const size_t to{ newline ? static_cast<size_t>(static_cast<const char *>(newline) - text) : size };
+        Append(severity, tag, begin + from, to - from);
+        from = to + 1;
+    } while (from < size);
+    mUpdated = true;
+}
+
+void ImGuiLogVisualizer::Append(plog::Severity severity, uint16_t tag, uint64_t begin, size_t length) {
+    if (mNext - mFirst == mLines.size()) {
+        Evict();
+    }
+    const uint64_t id{ mNext++ };
+    const Line &line{ mLines[id % mLines.size()] = Line{ begin, length, severity, tag } };
+
+    mSeverityRows[std::min(severity, plog::verbose)].push_back(id);
+    mTagRows[tag].push_back(id);
+    if (mFiltered) {
+        // behind a running rescan the row waits its turn, otherwise it is decided now
+        if (mScanAll) {
+            // the scanned range runs up to mNext and already covers it
+        } else if (!mCandidates.empty()) {
+            mCandidates.push_back(id);
+        } else if (Matches(line)) {
+            mView.push_back(id);
+        }
+    }
+}
+
+void ImGuiLogVisualizer::Evict() {
+    const Line &line{ mLines[mFirst % mLines.size()] };
+    mSeverityRows[std::min(line.severity, plog::verbose)].pop_front();
+    mTagRows[line.tag].pop_front();
+    if (!mView.empty() && mView.front() == mFirst) {
+        mView.pop_front();
+    }
+    ++mFirst;
+}
+
+//================================ FILTER =================================//
+
+void ImGuiLogVisualizer::ApplyFilter(const Filter &filter) {
+    const bool incremental{ mFiltered && !Scanning() && narrows(filter, mFilter) };
+    mFilter = filter;
+    mFiltered = filter.severities != Filter{}.severities || !filter.tag.empty() || !filter.text.empty();
+    mFilterTag = -1;
+    for (size_t i = 1; i < mTags.size() && !filter.tag.empty(); ++i) {
+        if (mTags[i] == filter.tag) {
+            mFilterTag = static_cast<int>(i);
+        }
+    }
+    const size_t length{ std::min(filter.text.size(), mSearch.size() - 1) };
+    std::copy_n(filter.text.begin(), length, mSearch.begin());
+    mSearch[length] = '\0';
+    mRegexError.clear();
+    mSearcher.reset();
+    if (!filter.regex && !filter.text.empty()) {
+        mSearcher.emplace(mFilter.text.begin(), mFilter.text.end());
+    } else if (filter.regex && !filter.text.empty()) {
+        try {
+            mRegex.assign(filter.text, std::regex::ECMAScript | std::regex::optimize);
+        } catch (const std::regex_error &e) {
+            mRegexError = e.what();
+        }
+    }
+
+    mCandidates.clear();
+    mScanAll = false;
+    if (!mFiltered) {
+        mView.clear();
+        return;
+    }
+    if (incremental) {
+        // the new matches are a subset of the current ones
+        mCandidates.swap(mView);
+    } else if (!filter.tag.empty()) {
+        if (mFilterTag >= 0) {
+            mCandidates = mTagRows[mFilterTag];
+        }
+    } else if ((filter.severities & AllSeverities) == AllSeverities) {
+        // every row is a candidate, walk the ring instead of listing the ids
+        mScanAll = true;
+        mScanNext = mFirst;
+    } else {
+        // merge the id lists of the wanted severities, they are sorted already
+        std::vector<std::pair<std::deque<uint64_t>::const_iterator, std::deque<uint64_t>::const_iterator>> lists;
+        for (size_t severity = 0; severity < mSeverityRows.size(); ++severity) {
+            if (filter.severities & (1u << severity) && !mSeverityRows[severity].empty()) {
+                lists.emplace_back(mSeverityRows[severity].begin(), mSeverityRows[severity].end());
+            }
+        }
+        while (!lists.empty()) {
+            auto next{ std::min_element(lists.begin(), lists.end(), [](const auto &a, const auto &b) {
+                return *a.first < *b.first;
+            }) };
+            mCandidates.push_back(*next->first);
+            if (++next->first == next->second) {
+                lists.erase(next);
+            }
+        }
+    }
+    mView.clear();
+}
+
+bool ImGuiLogVisualizer::Candidate(const Line &line) const {
+    return (mFilter.severities & (1u << line.severity))
+        && (mFilter.tag.empty() || static_cast<int>(line.tag) == mFilterTag);
+}
+
+bool ImGuiLogVisualizer::Matches(const Line &line) const {
+    if (!Candidate(line)) {
+        return false;
+    }
+    if (mFilter.text.empty()) {
+        return true;
+    }
+    const char *text{ mArena.data() + line.begin % mArena.size() };
+    if (mSearcher) {
+        return std::search(text, text + line.length, *mSearcher) != text + line.length;
+    }
+    return mRegexError.empty() && std::regex_search(text, text + line.length, mRegex);
+}
+
+bool ImGuiLogVisualizer::Scanning() const {
+    return mScanAll || !mCandidates.empty();
+}
+
+void ImGuiLogVisualizer::Scan(std::chrono::steady_clock::time_point deadline) {
+    while (mScanAll) {
+        mScanNext = std::max(mScanNext, mFirst);
+        const uint64_t end{ std::min(mScanNext + kScanChunk, mNext) };
+        for (; mScanNext < end; ++mScanNext) {
+            if (Matches(mLines[mScanNext % mLines.size()])) {
+                mView.push_back(mScanNext);
+            }
+        }
+        mScanAll = mScanNext < mNext;
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return;
+        }
+    }
+    while (!mCandidates.empty()) {
+        for (size_t i = 0; i < kScanChunk && !mCandidates.empty(); ++i) {
+            const uint64_t id{ mCandidates.front() };
+            mCandidates.pop_front();
+            if (id >= mFirst && Matches(mLines[id % mLines.size()])) {
+                mView.push_back(id);
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return;
+        }
+    }
+}
+
+void ImGuiLogVisualizer::DrawFilter() {
+    Filter filter{ mFilter };
+    bool changed{ false };
+    for (const plog::Severity severity : kShownSeverities) {
+        bool shown{ (filter.severities & (1u << severity)) != 0 };
+        ImGui::PushStyleColor(ImGuiCol_Text, severityColor(severity));
+        if (ImGui::Checkbox(plog::severityToString(severity), &shown)) {
+            filter.severities ^= 1u << severity;
+            changed = true;
+        }
+        ImGui::PopStyleColor();
+        ImGui::SameLine();
+    }
+
+    ImGui::SetNextItemWidth(120.0f);
+    if (ImGui::BeginCombo("Tag", filter.tag.empty() ? "Any" : filter.tag.c_str())) {
+        for (size_t i = 0; i < mTags.size(); ++i) {
+            // index 0 is the untagged bucket, selecting it clears the tag filter
+            if (ImGui::Selectable(0 == i ? "Any" : mTags[i].c_str(), filter.tag == mTags[i])) {
+                filter.tag = mTags[i];
+                changed = true;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(240.0f);
+    if (ImGui::InputText("Search", mSearch.data(), mSearch.size())) {
+        filter.text = mSearch.data();
+        changed = true;
+    }
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("Regex", &filter.regex);
+    if (changed) {
+        ApplyFilter(filter);
+    }
+
+    if (!mRegexError.empty()) {
+        ImGui::TextColored(severityColor(plog::error), "%s", mRegexError.c_str());
+    } else if (mFiltered) {
+        ImGui::Text("%zu of %llu rows%s", mView.size(), static_cast<unsigned long long>(mNext - mFirst),
+            Scanning() ? ", filtering..." : "");
+    }
+    ImGui::Separator();
+}
+
 LogHelper *LogHelper::Instance() {
     static LogHelper helper;
     return &helper;
 }
 
 void LogHelper::Initialize(plog::Severity level) {
+    Initialize(level, Options{});
+}
+
+void LogHelper::Initialize(plog::Severity level, const Options &options) {
     if (!fs::exists(sLoggerDirectory)) {
         fs::create_directories(sLoggerDirectory);
     }
 
     std::string logfile{ sLoggerDirectory + GenerateLogFileName() };
 
-    mVisualizer = std::make_shared<ImGuiLogVisualizer>();
+    mVisualizer = std::make_shared<ImGuiLogVisualizer>(options.window);
+
+    // opened first so the binary log outlives the appenders that write to it
+    const bool binary{ options.binary && BinaryLog::Instance()->Open(logfile + ".blog") };
 
     static plog::ColorConsoleAppender<plog::DefaultFormatter> Console;
     static plog::RollingFileAppender<plog::TxtFormatter> File{ logfile.c_str() };
+    static plog::BinaryAppender Binary;
     static plog::ImGuiAppender<plog::SimpleFormatter> ImGuiWidget{ mVisualizer };
+    // declared last so it is destroyed (and drained) before the appenders it feeds
+    static plog::AsyncAppender Async{ AsyncCapacity, options.overflow };
+    mAsync = &Async;
 
-    plog::init(level, logfile.c_str())
-        .addAppender(&Console)
-        .addAppender(&File)
+    Async.addAppender(&Console)
+        .addAppender(binary ? static_cast<plog::IAppender *>(&Binary) : &File)
         .addAppender(&ImGuiWidget);
+    plog::init(level, &Async);
+    if (options.binary) {
+        if (binary) {
+            LOGI << "[Log] Writing binary log " << logfile << ".blog";
+        } else {
+            LOGE << "[Log] Cannot map binary log " << logfile << ".blog, using the text file";
+        }
+    }
+    if (level > LOG_MIN_SEVERITY) {
+        LOGW << "[Log] Level " << plog::severityToString(level) << " requested, records below "
+             << plog::severityToString(LOG_MIN_SEVERITY) << " are compiled out";
+    }
+}
+
+void LogHelper::Flush() {
+    if (nullptr != mAsync) {
+        mAsync->Flush();
+    }
 }
 
 ImGuiLogVisualizer::Ref LogHelper::Visualizer() const {
@@ -1,35 +1,161 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <queue>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <string_view>
 #include <plog/Log.h>
 #include <plog/Severity.h>
 
+#include "asyncappender.hpp"
+
 namespace Utilites {
 
+/**
+ * Log window storage: a fixed ring of lines over one contiguous text arena,
+ * both allocated up front. When either cap is reached the oldest lines are
+ * evicted, so memory stays constant and Roll never reallocates.
+ * Records are stored one row per text line and Draw only submits the rows
+ * in view, so a frame costs the same with a thousand or a million lines.
+ *
+ * Rows are indexed by severity and by tag (the "[Mash]" style prefix of the
+ * message). A filter starts from those indices, a search that extends the
+ * previous one only rechecks the previous matches, and new rows are tested
+ * as they arrive. Draw spends at most a few milliseconds per frame on a
+ * rescan and shows partial results meanwhile.
+ */
 class ImGuiLogVisualizer {
 public:
     using Ref = std::shared_ptr<ImGuiLogVisualizer>;
     using WeakRef = std::weak_ptr<ImGuiLogVisualizer>;
-    using Log = std::pair<ImVec4, std::string>;
 
-    void Roll(ImVec4 &&clr, std::string &&msg);
+    struct Log {
+        plog::Severity severity;
+        std::string tag;
+        std::string text;
+    };
+
+    struct Limits {
+        size_t lines{ 65536 };
+        size_t bytes{ 8u << 20 };   ///< longer records are truncated to this
+    };
+
+    struct Filter {
+        uint32_t severities{ ~0u };     ///< bit per plog::Severity
+        std::string tag;                ///< e.g. "[Mash]", empty for any
+        std::string text;               ///< substring, or ECMAScript regex
+        bool regex{ false };
+    };
+
+    ImGuiLogVisualizer();
+    explicit ImGuiLogVisualizer(const Limits &limits);
+
+    /// tag is the record's "[Module]" prefix, empty if it has none.
+    void Roll(plog::Severity severity, std::string_view tag, std::string_view msg);
+
+    /// Roll without a staging copy: write(char *out, size_t size) fills the
+    /// record in place. size is clamped to the arena, write must honour the
+    /// value it is given.
+    template<class Write>
+    void Emplace(plog::Severity severity, std::string_view tag, size_t size, Write &&write) {
+        std::lock_guard<std::mutex> lock{ mLock };
+        const uint16_t tagIndex{ TagIndex(tag) };
+        size = std::min(size, mArena.size());
+        const uint64_t begin{ Reserve(size) };
+        write(mArena.data() + begin % mArena.size(), size);
+        Commit(severity, tagIndex, begin, size);
+    }
+
     void Clear();
     void Draw();
 
+    void SetFilter(const Filter &filter);
+    Filter GetFilter() const;
+    /// Rows currently stored.
+    size_t Lines() const;
+    /// Rows that passed the filter so far, Lines() when there is none.
+    size_t Matches() const;
+    /// True while a rescan is still spread over the coming frames.
+    bool Filtering() const;
+
 private:
-    std::vector<Log> mRollingLog;
+    static constexpr size_t MaxTags{ 64 };     ///< further tags are indexed as untagged
+    static constexpr uint32_t AllSeverities{ (1u << (plog::verbose + 1)) - 1 };
+
+    struct Line {
+        uint64_t begin;     ///< position in the arena, counted from the first byte ever written
+        size_t length;
+        plog::Severity severity;
+        uint16_t tag;       ///< index into mTags
+    };
+
+    mutable std::mutex mLock;   ///< records arrive from worker threads as well
+    std::vector<char> mArena;
+    std::vector<Line> mLines;   ///< row id % size
+    uint64_t mFirst{ 0 };       ///< id of the oldest row
+    uint64_t mNext{ 0 };        ///< id of the next row
+    uint64_t mEnd{ 0 };         ///< arena position after the newest line
     bool mUpdated{ false };
+
+    std::array<std::deque<uint64_t>, plog::verbose + 1> mSeverityRows;
+    std::vector<std::string> mTags{ std::string{} };
+    std::vector<std::deque<uint64_t>> mTagRows{ 1 };
+
+    Filter mFilter;
+    bool mFiltered{ false };    ///< mFilter is not the pass-everything default
+    int mFilterTag{ -1 };       ///< index of mFilter.tag, -1 if no row had it yet
+    std::optional<std::boyer_moore_horspool_searcher<std::string::const_iterator>> mSearcher;
+    std::regex mRegex;
+    std::string mRegexError;
+    std::deque<uint64_t> mView;         ///< ids of the matching rows
+    std::deque<uint64_t> mCandidates;   ///< ids still to check against the filter
+    bool mScanAll{ false };             ///< instead, check every row from mScanNext on
+    uint64_t mScanNext{ 0 };
+    std::array<char, 256> mSearch{};
+
+    uint16_t TagIndex(std::string_view tag);
+    /// Arena position for size bytes, evicting the rows in the way.
+    uint64_t Reserve(size_t size);
+    /// Splits the reserved record into rows.
+    void Commit(plog::Severity severity, uint16_t tag, uint64_t begin, size_t size);
+    void Append(plog::Severity severity, uint16_t tag, uint64_t begin, size_t length);
+    void Evict();
+
+    void ApplyFilter(const Filter &filter);
+    bool Candidate(const Line &line) const;
+    bool Matches(const Line &line) const;
+    bool Scanning() const;
+    void Scan(std::chrono::steady_clock::time_point deadline);
+    void DrawFilter();
 };
 
 class LogHelper : public plog::util::Singleton<LogHelper> {
 public:
     static LogHelper *Instance();
 
+    struct Options {
+        plog::AsyncAppender::Overflow overflow{ plog::AsyncAppender::Overflow::Block };
+        ImGuiLogVisualizer::Limits window;
+        bool binary{ false };   ///< write <log>.blog through BinaryLog instead of the text file
+    };
+
+    /// Records are formatted and written by a background thread, see AsyncAppender.
     void Initialize(plog::Severity level);
+    void Initialize(plog::Severity level, const Options &options);
+    /// Waits until everything logged so far has reached the console, file and widget.
+    void Flush();
     ImGuiLogVisualizer::Ref Visualizer() const;
 
 private:
+    static constexpr size_t AsyncCapacity{ 8192 };
+
     ImGuiLogVisualizer::Ref mVisualizer;
+    plog::AsyncAppender *mAsync{ nullptr };
     const std::string sLoggerDirectory{ "logs/" };
 
     std::string GenerateLogFileName() const;
@@ -1,50 +1,147 @@
 #include "incs.hpp"
+#include <filesystem>
+
 #include "logutilites.hpp"
 #include "window.hpp"
+#include "headless.hpp"
 #include "mash.hpp"
 #include "templates.hpp"
 #include "vertex.hpp"
 #include "shader.hpp"
+#include "shadervariants.hpp"
+#include "shaderwatcher.hpp"
 #include "texturegen.hpp"
 #include "texture.hpp"
+#include "transform.hpp"
+#include "jobsystem.hpp"
+#include "entities.hpp"
+#include "components.hpp"
+#include "commandbuffer.hpp"
+#include "glbackend.hpp"
+#include "framepipeline.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
+#include "glcapture.hpp"
 
 template<class T>
 using Param = std::pair<bool, T>;
 
+/// Feature bits of the quad's shader variants, see fs.glsl.
+enum QuadFeature : uint32_t {
+    TextureSampler0 = 1 << 0,
+    TextureSampler1 = 1 << 1,
+    TextureOnly = 1 << 2,
+    ColorOnly = 1 << 3,
+};
+
+struct Options {
+    bool headless{ false };
+    uint64_t frames{ 300 };
+    glm::ivec2 size{ 1370, 900 };
+    std::string capture;
+    std::string glCapture;
+    std::string trace;
+    bool binaryLog{ false };
+    plog::Severity logLevel{ plog::debug };
+    std::vector<std::string> unknown;
+};
+
 void onGlfwError(int error, const char *descr) {
     LOGE << "[GLFW] Code: " << error << ", Description: " << descr;
 }
 
-int main() {
-    Utilites::LogHelper::Instance()->Initialize(plog::debug);
-    glfwSetErrorCallback(onGlfwError);
-    if(!glfwInit()) {
-        return 1;
+/// --headless [--frames N] [--size WxH] [--capture image.ppm] [--gl-capture calls.glc] [--binary-log]
+///   [--trace session.json|session.pftrace] [--log-level error|warning|info|debug|verbose]
+/// Parsed before the logger exists, unknown arguments are reported by main.
+Options parseOptions(int argc, char **argv) {
+    Options options;
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg{ argv[i] };
+        const bool hasValue{ i + 1 < argc };
+        if("--headless" == arg) {
+            options.headless = true;
+        } else if("--frames" == arg && hasValue) {
+            options.frames = std::stoull(argv[++i]);
+        } else if("--size" == arg && hasValue) {
+            std::sscanf(argv[++i], "%dx%d", &options.size.x, &options.size.y);
+        } else if("--capture" == arg && hasValue) {
+            options.capture = argv[++i];
+        } else if("--gl-capture" == arg && hasValue) {
+            options.glCapture = argv[++i];
+        } else if("--trace" == arg && hasValue) {
+            options.trace = argv[++i];
+        } else if("--binary-log" == arg) {
+            options.binaryLog = true;
+        } else if("--log-level" == arg && hasValue && plog::none != plog::severityFromString(argv[i + 1])) {
+            options.logLevel = plog::severityFromString(argv[++i]);
+        } else {
+            options.unknown.push_back(arg);
+        }
     }
+    return options;
+}
 
-    Window::Ref window{ new Window{ {1370, 900}, "OpenGLRem" } }; // windowed screen
-    // Window::Ref window{ new Window{ glfwGetPrimaryMonitor(), "OpenGLRem" } }; // fullscreen
-    if(!window->isActive()) {
-        return 2;
+int main(int argc, char **argv) {
+    const Options options{ parseOptions(argc, argv) };
+    Utilites::LogHelper::Options logOptions;
+    logOptions.binary = options.binaryLog;
+    Utilites::LogHelper::Instance()->Initialize(options.logLevel, logOptions);
+    for(const auto &arg : options.unknown) {
+        LOGW << "[main] Unknown argument: " << arg;
+    }
+    JobSystem::Instance()->Initialize();
+    Trace::Instance()->SetThreadName("Main");
+    // from the start, so texture decoding and shader builds are in the trace
+    if(!options.trace.empty()) {
+        Trace::Instance()->Start();
     }
-    const float scaleCoef{ window->height() / static_cast<float>(window->width()) };
-    LOGI << "[main] scaleCoef coef: " << scaleCoef;
 
-    if(auto rc{ glewInit() }; GL_NO_ERROR != rc) {
-        LOGE << "[GLEW] Cannot initialize GLEW: " << rc;
-        return 3;
+    Window::Ref window;
+    if(options.headless) {
+        // loads the GL entry points itself
+        window.reset(new HeadlessWindow{ options.size, options.frames });
+        if(!window->isActive()) {
+            return 2;
+        }
+    } else {
+        glfwSetErrorCallback(onGlfwError);
+        if(!glfwInit()) {
+            return 1;
+        }
+        window.reset(new Window{ glm::vec2{ options.size }, "OpenGLRem" }); // windowed screen
+        // window.reset(new Window{ glfwGetPrimaryMonitor(), "OpenGLRem" }); // fullscreen
+        if(!window->isActive()) {
+            return 2;
+        }
+        if(auto rc{ glewInit() }; GL_NO_ERROR != rc) {
+            LOGE << "[GLEW] Cannot initialize GLEW: " << rc;
+            return 3;
+        }
     }
+    GLCapture::Instance()->Install();
+    if(!options.glCapture.empty() && !GLCapture::Instance()->Start(options.glCapture)) {
+        return 5;
+    }
+    const float scaleCoef{ window->height() / static_cast<float>(window->width()) };
+    LOGI << "[main] scaleCoef coef: " << scaleCoef;
 
-    std::shared_ptr<Shader> shader{ new Shader {
-        "resources/shaders/vs.glsl",
-        "resources/shaders/fs.glsl"
+    ShaderVariants variants{ "resources/shaders/vs.glsl", "resources/shaders/fs.glsl", {
+        "TEXTURE_SAMPLER sample_0",
+        "TEXTURE_SAMPLER sample_1",
+        "TEXTURE_ONLY",
+        "COLOR_ONLY"
     } };
+    const Shader::Ref shader{ variants.Base() };
 
     if(!shader->Valide()) {
         auto error{ shader->GetLastError() };
         LOGE << "[main] Cannot create shader: " << error->what;
         return error->code;
     }
+    // edits to the sources take effect between frames; headless runs stay fixed
+    if(!options.headless) {
+        variants.Watch();
+    }
 
     TemplateGenerator::Template triangleTemplate {
         TemplateGenerator::Generate(TemplateType::SQUARE, 5)
@@ -52,46 +149,41 @@ int main() {
     Mash triangle(triangleTemplate.first, triangleTemplate.second, shader);
 
     shader->Use();
-    std::vector<Texture::Ref> textures {
-        TextureGenerator::Gen("resources/textures/texture_0.jpeg", shader),
-        TextureGenerator::Gen("resources/textures/texture_1.png", shader)
-    };
+    std::vector<Texture::Ref> textures{ TextureGenerator::Gen(std::vector<std::string>{
+        "resources/textures/texture_0.jpeg",
+        "resources/textures/texture_1.png"
+    }, shader) };
 
     glm::vec4 bgcolor{.3f, .2f, .4f, 1.0f};
     Param<float> mixValue{ true, 0.8f };
     Param<float> angle{ true, 0.0f };
     Param<float> xAngle{ true, 0.0f };
     Param<float> yAngle{ true, 0.0f };
-    int texId{};
 
-    while(window->isActive()) {
-        window->poll_events();
-        window->clear(bgcolor);
+    TransformHierarchy transforms;
+    const auto triangleNode{ transforms.Create() };
+    transforms.SetScale(triangleNode, glm::vec3{scaleCoef, 1, 0});
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame(); 
+    EntityRegistry scene;
+    const Entity quad{ scene.Create(
+        TransformComponent{ triangleNode },
+        MeshComponent{ &triangle },
+        TextureComponent{ textures[0].get(), 0 }
+    ) };
 
-        shader->Use();
-        if (angle.first || xAngle.first || yAngle.first) {
-            glm::mat4 transformation{ 1.0f };
-            transformation = glm::rotate(transformation, angle.second, glm::vec3{0, 0, 1});
-            transformation = glm::rotate(transformation, xAngle.second, glm::vec3{1, 0, 0});
-            transformation = glm::rotate(transformation, yAngle.second, glm::vec3{0, 1, 0});
-            transformation = glm::scale(transformation, glm::vec3{scaleCoef, 1, 0});
-            shader->Set("transform", transformation);
-        }
-        if (mixValue.first) {
-            shader->Set("mix_value", mixValue.second);
-        }
-        shader->Set("texId", texId);
-        shader->UnUse();
+    GLBackend backend;
 
-        textures[texId]->Bind();
-        triangle.Bind();
-        triangle.Draw();
-        triangle.Unbind();
-        textures[texId]->Unbind();
+    // GLFW events and the platform/renderer halves of ImGui stay on the main
+    // thread; ImGui::NewFrame..Render and scene work run on a job worker.
+    auto prepare = [&](FrameData &) {
+        PROFILE_CPU("Prepare");
+        window->poll_events();
+        window->new_frame();
+    };
+
+    auto simulate = [&](FrameData &frame) {
+        PROFILE_CPU("Simulate");
+        ImGui::NewFrame();
 
        {ImGui::Begin("Settings");
             ImGui::TextWrapped("Shader settings:");
@@ -106,23 +198,130 @@ int main() {
             ImGui::TextWrapped("Information:");
             auto framerate{ ImGui::GetIO().Framerate };
             ImGui::TextWrapped("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / framerate, framerate);
+            ImGui::Separator();
+            ImGui::TextWrapped("Frame pacing:");
+            static const char *modes[]{ "VSync", "Adaptive", "Uncapped", "Limited" };
+            int mode{ static_cast<int>(window->presentMode()) };
+            float fps{ static_cast<float>(window->frameRateLimit()) };
+            const bool modeChanged{ ImGui::Combo("Present mode", &mode, modes, IM_ARRAYSIZE(modes)) };
+            const bool fpsChanged{ PresentMode::Limited == static_cast<PresentMode>(mode) && ImGui::SliderFloat("FPS limit", &fps, 10.0f, 240.0f, "%.0f") };
+            if(modeChanged || fpsChanged) {
+                window->setPresentMode(static_cast<PresentMode>(mode), fps);
+            }
+            bool lowLatency{ window->lowLatency() };
+            if(ImGui::Checkbox("Low latency (finish after swap)", &lowLatency)) {
+                window->setLowLatency(lowLatency);
+            }
+            const auto pacing{ window->pacing() };
+            ImGui::TextWrapped("Frame %.2f ms (work %.2f, wait %.2f), target %.2f ms", pacing.frame, pacing.work, pacing.wait, pacing.target);
+            ImGui::TextWrapped("Last %zu: avg %.2f ms, peak %.2f ms, jitter %.2f ms, missed %llu",
+                Window::PacingHistory, pacing.average, pacing.peak, pacing.jitter, static_cast<unsigned long long>(pacing.missed));
         ImGui::End();}
 
         ImGui::Begin("Textures");
             for(size_t i = 0; i < textures.size(); ++i) {
                 auto id{ reinterpret_cast<ImTextureID>(textures[i]->id()) };
                 if(ImGui::ImageButton(id, ImVec2{128, 128}, ImVec2{0, 1}, ImVec2{1, 0})) {
-                    LOGI << "[Main] Update texture id: " << i;
-                    texId = i;
+                    LOG_EVERY_MS(plog::info, 1000) << "[Main] Update texture id: " << i;
+                    *scene.Get<TextureComponent>(quad) = { textures[i].get(), static_cast<int>(i) };
                 }
             }
         ImGui::End();
 
         Utilites::LogHelper::Instance()->Visualizer()->Draw();
+        Profiler::Instance()->Draw();
+        GLCapture::Instance()->Draw();
+
+        if (angle.first || xAngle.first || yAngle.first) {
+            transforms.SetRotation(triangleNode,
+                glm::angleAxis(angle.second, glm::vec3{0, 0, 1}) *
+                glm::angleAxis(xAngle.second, glm::vec3{1, 0, 0}) *
+                glm::angleAxis(yAngle.second, glm::vec3{0, 1, 0}));
+        }
+        {
+            PROFILE_CPU("Transforms");
+            transforms.Update();
+        }
+
+        // scene traversal records in parallel, one buffer per chunk so the
+        // replay order stays deterministic; GL calls happen only in submit
+        frame.clearColor = bgcolor;
+        frame.uniforms.time = static_cast<float>(ImGui::GetTime());
+        frame.commands.resize(scene.Chunks<TransformComponent, MeshComponent, TextureComponent>());
+        for(auto &buffer : frame.commands) {
+            buffer.Reset();
+        }
+        const float mix{ mixValue.second };
+        {
+            PROFILE_CPU("Record");
+            scene.ParallelChunks<TransformComponent, MeshComponent, TextureComponent>(
+                [&](size_t chunk, Entity, TransformComponent &transform, MeshComponent &mesh, TextureComponent &texture) {
+                    auto &buffer{ frame.commands[chunk] };
+                    // a variant without the texture switch and, at either end
+                    // of the slider, without the mix
+                    uint32_t features{ 0 == texture.unit ? TextureSampler0 : 1 == texture.unit ? TextureSampler1 : 0u };
+                    features = mix <= 0.0f ? ColorOnly : mix >= 1.0f ? features | TextureOnly : features;
+                    buffer.BindShader(variants.Get(features));
+                    ObjectBlock object;
+                    object.transform = transforms.World(transform.node);
+                    object.mixValue = mix;
+                    object.texId = texture.unit;
+                    buffer.SetObject(object);
+                    buffer.BindTexture(texture.texture);
+                    buffer.Draw(mesh.mash);
+                });
+        }
 
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        frame.ui.Capture(ImGui::GetDrawData());
+    };
 
+    auto submit = [&](FrameData &frame) {
+        PROFILE_CPU("Submit");
+        ShaderWatcher::Instance()->Update();
+        window->clear(frame.clearColor);
+        {
+            PROFILE_GPU("Scene");
+            backend.Begin(frame.uniforms);
+            for(const auto &buffer : frame.commands) {
+                backend.Execute(buffer);
+            }
+            backend.End();
+        }
+        if(auto *data{ frame.ui.Data() }) {
+            PROFILE_GPU("UI");
+            ImGui_ImplOpenGL3_RenderDrawData(data);
+        }
+        PROFILE_CPU("Present");
         window->update();
+    };
+
+    FramePipeline pipeline{ prepare, simulate, submit };
+    while(window->isActive()) {
+        Profiler::Instance()->BeginFrame();
+        pipeline.Frame();
+        Profiler::Instance()->EndFrame();
+        GLCapture::Instance()->EndFrame();
+    }
+    pipeline.Flush();
+    ShaderWatcher::Instance()->Stop();
+    GLCapture::Instance()->EndFrame();
+    GLCapture::Instance()->Stop();
+    if(!options.trace.empty()) {
+        Trace::Instance()->Stop();
+        const bool perfetto{ std::filesystem::path{ options.trace }.extension() == ".pftrace" };
+        if(!Trace::Instance()->Save(options.trace, perfetto ? Trace::Format::Perfetto : Trace::Format::ChromeJson)) {
+            LOGE << "[main] Cannot save the trace to " << options.trace;
+        }
+    }
+    Utilites::LogHelper::Instance()->Flush();
+
+    if(auto *headless{ dynamic_cast<HeadlessWindow *>(window.get()) }) {
+        const auto report{ headless->report() };
+        std::printf("frames: %llu, total: %.3f ms, avg: %.3f ms, min: %.3f ms, max: %.3f ms, p99: %.3f ms\n",
+            static_cast<unsigned long long>(report.frames), report.total, report.average, report.min, report.max, report.p99);
+        if(!options.capture.empty() && !headless->save(options.capture)) {
+            return 4;
+        }
     }
 }
@@ -16,13 +16,20 @@ public:
     void Unbind();
     void Draw();
 
+    /// The mesh's own VAO, or the shared one of its format (see VertexFormats).
+    GLuint Vao() const;
+    /// With a shared VAO, bound: attaches this mesh's buffers to it.
+    void BindBuffers() const;
+    bool SharesVao() const;
+
 private:
     size_t mDrawCount;
     Shader::Ref shader;
+    const VertexFormat *mFormat{ nullptr };
 
-    GLuint VAO;
-    GLuint VBO;
-    GLuint EBO;
+    GLuint VAO{ 0 };
+    GLuint VBO{ 0 };
+    GLuint EBO{ 0 };
 
     bool ArgsValid(const Vertices &vertices, const std::vector<GLuint> &indices,
                 Shader::Ref &mashShader) const;
@@ -49,3 +49,14 @@ size_t Vertex::GetTexCount() {
 size_t Vertex::GetStride() {
     return GetPosSize() + GetClrSize() + GetTexSize();
 }
+
+//================================ LAYOUT ================================//
+
+const VertexLayout &Vertex::Layout() {
+    static const VertexLayout layout{ {
+        { "position", static_cast<GLint>(GetPosCount()), GL_FLOAT, GL_FALSE, GetPosOffset() },
+        { "color", static_cast<GLint>(GetClrCount()), GL_FLOAT, GL_FALSE, GetClrOffset() },
+        { "texCoord", static_cast<GLint>(GetTexCount()), GL_FLOAT, GL_FALSE, GetTexOffset() },
+    }, static_cast<GLsizei>(GetStride()) };
+    return layout;
+}
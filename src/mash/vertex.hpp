@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "vertexformat.hpp"
+
 struct Vertex {
     glm::vec3 position;
     glm::vec4 color;
@@ -21,6 +23,9 @@ struct Vertex {
     static size_t GetTexCount();
 
     static size_t GetStride();
+
+    /// position, color and texCoord, as vs.glsl names them
+    static const VertexLayout &Layout();
 };
 
 using Vertices = std::vector<Vertex>;
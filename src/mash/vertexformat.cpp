@@ -0,0 +1,92 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+
+#include "vertexformat.hpp"
+#include "binarylog.hpp"
+
+void VertexFormat::Apply() const {
+    for(const auto &binding : bindings) {
+        glVertexAttribPointer(binding.location, binding.count, binding.type, binding.normalized,
+                              stride, reinterpret_cast<const void *>(binding.offset));
+        glEnableVertexAttribArray(binding.location);
+    }
+}
+
+void VertexFormat::Bind(GLuint vertices, GLuint indices) const {
+    glBindVertexBuffer(0, vertices, 0, stride);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
+}
+
+bool VertexFormat::SameLayout(const VertexFormat &other) const {
+    const auto same = [](const Binding &a, const Binding &b) {
+        return a.location == b.location && a.count == b.count && a.type == b.type
+            && a.normalized == b.normalized && a.offset == b.offset;
+    };
+    return stride == other.stride
+        && std::equal(bindings.begin(), bindings.end(), other.bindings.begin(), other.bindings.end(), same);
+}
+
+VertexFormats *VertexFormats::Instance() {
+    static VertexFormats formats;
+    return &formats;
+}
+
+const VertexFormat &VertexFormats::Get(const VertexLayout &layout, const Shader &shader) {
+    const auto &reflection{ shader.GetReflection() };
+    const auto [it, inserted]{ mFormats.try_emplace({ &layout, reflection.id }) };
+    VertexFormat &format{ it->second };
+    if(!inserted) {
+        return format;
+    }
+
+    format.stride = layout.stride;
+    for(const auto &attribute : layout.attributes) {
+        const auto input{ reflection.attributes.find(attribute.name) };
+        if(reflection.attributes.end() == input || input->second.location < 0) {
+            LOGD << "[VertexFormat] '" << attribute.name << "' is not an input of program " << reflection.id << ", skipped";
+            continue;
+        }
+        const GLuint location{ static_cast<GLuint>(input->second.location) };
+        format.bindings.push_back({ location, attribute.count, attribute.type, attribute.normalized, attribute.offset });
+        BLOGI("[VertexFormat] {}: location {}, count {}, offset {}, stride {}",
+              attribute.name, location, attribute.count, attribute.offset, layout.stride);
+    }
+    for(const auto &[name, input] : reflection.attributes) {
+        const bool fed{ std::any_of(layout.attributes.begin(), layout.attributes.end(), [&name = name](const auto &attribute) {
+            return attribute.name == name;
+        }) };
+        if(!fed && input.location >= 0) {
+            LOGW << "[VertexFormat] Input '" << name << "' of program " << reflection.id << " has no vertex data";
+        }
+    }
+    if(Shared()) {
+        format.vao = SharedVao(format);
+    }
+    return format;
+}
+
+bool VertexFormats::Shared() {
+    static const bool supported{ GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding };
+    return supported;
+}
+
+GLuint VertexFormats::SharedVao(const VertexFormat &format) const {
+    for(const auto &entry : mFormats) {
+        const VertexFormat &other{ entry.second };
+        if(0 != other.vao && other.SameLayout(format)) {
+            return other.vao;
+        }
+    }
+    GLuint vao{ 0 };
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    for(const auto &binding : format.bindings) {
+        glVertexAttribFormat(binding.location, binding.count, binding.type, binding.normalized, static_cast<GLuint>(binding.offset));
+        glVertexAttribBinding(binding.location, 0);
+        glEnableVertexAttribArray(binding.location);
+    }
+    glBindVertexArray(0);
+    BLOGI("[VertexFormat] Shared VAO {} for {} attributes, stride {}", vao, format.bindings.size(), format.stride);
+    return vao;
+}
@@ -0,0 +1,78 @@
+#ifndef __VERTEXFORMAT_H__
+#define __VERTEXFORMAT_H__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "shader.hpp"
+
+/// What a vertex struct holds, attribute by attribute (see Vertex::Layout).
+struct VertexLayout {
+    struct Attribute {
+        std::string name;       ///< the vertex shader input it feeds
+        GLint count;
+        GLenum type;
+        GLboolean normalized;
+        size_t offset;
+    };
+    std::vector<Attribute> attributes;
+    GLsizei stride;
+};
+
+/// A layout resolved against a program: the attribute pointers a VAO needs.
+struct VertexFormat {
+    struct Binding {
+        GLuint location;
+        GLint count;
+        GLenum type;
+        GLboolean normalized;
+        size_t offset;
+    };
+    std::vector<Binding> bindings;
+    GLsizei stride;
+    /// With attribute binding: the VAO of this format, shared by its meshes,
+    /// which attach their buffers with Bind. 0 otherwise.
+    GLuint vao{ 0 };
+
+    /// Points and enables the attributes of the bound VAO at the bound array buffer.
+    void Apply() const;
+    /// Attaches a mesh's buffers to the shared VAO, which must be bound.
+    void Bind(GLuint vertices, GLuint indices) const;
+
+    bool SameLayout(const VertexFormat &other) const;
+};
+
+/**
+ * Formats keyed by (layout, program), resolved from the program's reflection
+ * the first time a pair is seen; meshes sharing a format reuse it without
+ * asking the driver for attribute locations.
+ *
+ * With GL 4.3 or ARB_vertex_attrib_binding the attributes are described
+ * once with glVertexAttribFormat in a VAO shared by every format with the
+ * same bindings (e.g. the same program before and after a reload), and a
+ * mesh switch is glBindVertexBuffer instead of a VAO of its own. On plain
+ * GL 3.3 every mesh keeps a VAO and applies the format to it.
+ * GL thread only; the shared VAOs live as long as the context.
+ */
+class VertexFormats {
+public:
+    static VertexFormats *Instance();
+
+    /// The shader must be built. The reference stays valid.
+    const VertexFormat &Get(const VertexLayout &layout, const Shader &shader);
+    /// Attribute binding is available; checked once, after GLEW is initialised.
+    static bool Shared();
+
+private:
+    std::map<std::pair<const VertexLayout *, uint64_t>, VertexFormat> mFormats;
+
+    VertexFormats() = default;
+
+    /// The VAO of an existing format with the same bindings, or a new one.
+    GLuint SharedVao(const VertexFormat &format) const;
+};
+
+#endif // __VERTEXFORMAT_H__
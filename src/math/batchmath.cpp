@@ -0,0 +1,329 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+
+#include "batchmath.hpp"
+#include "batchmath_lanes.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define BATCHMATH_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+    #define BATCHMATH_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace {
+    using namespace BatchMath;
+
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+    static_assert(sizeof(glm::quat) == 4 * sizeof(float), "glm::quat must be tightly packed");
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "glm::mat4 must be tightly packed");
+    static_assert(sizeof(AABB) == 6 * sizeof(float), "AABB must be tightly packed");
+
+    inline const float *asFloats(const void *ptr) {
+        return static_cast<const float *>(ptr);
+    }
+    inline float *asFloats(void *ptr) {
+        return static_cast<float *>(ptr);
+    }
+
+#if defined(BATCHMATH_X86)
+    struct LaneSse {
+        static constexpr size_t Width{ 4 };
+        __m128 v;
+
+        static LaneSse Load(const float *p) { return { _mm_load_ps(p) }; }
+        static LaneSse Splat(float f) { return { _mm_set1_ps(f) }; }
+        void Store(float *p) const { _mm_store_ps(p, v); }
+
+        // minps/maxps return the second operand on ties, glm::min/max the first
+        static LaneSse Min(LaneSse a, LaneSse b) { return { _mm_min_ps(b.v, a.v) }; }
+        static LaneSse Max(LaneSse a, LaneSse b) { return { _mm_max_ps(b.v, a.v) }; }
+
+        friend LaneSse operator+(LaneSse a, LaneSse b) { return { _mm_add_ps(a.v, b.v) }; }
+        friend LaneSse operator-(LaneSse a, LaneSse b) { return { _mm_sub_ps(a.v, b.v) }; }
+        friend LaneSse operator*(LaneSse a, LaneSse b) { return { _mm_mul_ps(a.v, b.v) }; }
+        friend LaneSse operator/(LaneSse a, LaneSse b) { return { _mm_div_ps(a.v, b.v) }; }
+        friend LaneSse operator-(LaneSse a) { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; }
+    };
+
+    void multiplySse(const float *lhs, const float *rhs, float *out, size_t count) {
+        for(size_t i = 0; i < count; ++i, lhs += 16, rhs += 16, out += 16) {
+            const __m128 a0{ _mm_loadu_ps(lhs + 0) };
+            const __m128 a1{ _mm_loadu_ps(lhs + 4) };
+            const __m128 a2{ _mm_loadu_ps(lhs + 8) };
+            const __m128 a3{ _mm_loadu_ps(lhs + 12) };
+            for(size_t col = 0; col < 4; ++col) {
+                const __m128 b{ _mm_loadu_ps(rhs + col * 4) };
+                __m128 r{ _mm_mul_ps(a0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0))) };
+                r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+                r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+                r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+                _mm_storeu_ps(out + col * 4, r);
+            }
+        }
+    }
+
+    bool cpuHasAvx2() {
+    #if defined(_MSC_VER)
+        int info[4]{};
+        __cpuid(info, 0);
+        if(info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool osxsave{ (info[2] & (1 << 27)) != 0 };
+        const bool avx{ (info[2] & (1 << 28)) != 0 };
+        if(!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+#endif // BATCHMATH_X86
+
+#if defined(BATCHMATH_NEON)
+    struct LaneNeon {
+        static constexpr size_t Width{ 4 };
+        float32x4_t v;
+
+        static LaneNeon Load(const float *p) { return { vld1q_f32(p) }; }
+        static LaneNeon Splat(float f) { return { vdupq_n_f32(f) }; }
+        void Store(float *p) const { vst1q_f32(p, v); }
+
+        // explicit compare + select keeps glm's tie and signed zero behaviour
+        static LaneNeon Min(LaneNeon a, LaneNeon b) { return { vbslq_f32(vcltq_f32(b.v, a.v), b.v, a.v) }; }
+        static LaneNeon Max(LaneNeon a, LaneNeon b) { return { vbslq_f32(vcltq_f32(a.v, b.v), b.v, a.v) }; }
+
+        friend LaneNeon operator+(LaneNeon a, LaneNeon b) { return { vaddq_f32(a.v, b.v) }; }
+        friend LaneNeon operator-(LaneNeon a, LaneNeon b) { return { vsubq_f32(a.v, b.v) }; }
+        friend LaneNeon operator*(LaneNeon a, LaneNeon b) { return { vmulq_f32(a.v, b.v) }; }
+    #if defined(__aarch64__) || defined(_M_ARM64)
+        friend LaneNeon operator/(LaneNeon a, LaneNeon b) { return { vdivq_f32(a.v, b.v) }; }
+    #else
+        friend LaneNeon operator/(LaneNeon a, LaneNeon b) {
+            // ARMv7 NEON has no exact division: fall back to per-lane scalar division
+            alignas(16) float x[4], y[4];
+            vst1q_f32(x, a.v);
+            vst1q_f32(y, b.v);
+            for(size_t i = 0; i < 4; ++i) {
+                x[i] /= y[i];
+            }
+            return { vld1q_f32(x) };
+        }
+    #endif
+        friend LaneNeon operator-(LaneNeon a) { return { vnegq_f32(a.v) }; }
+    };
+
+    void multiplyNeon(const float *lhs, const float *rhs, float *out, size_t count) {
+        for(size_t i = 0; i < count; ++i, lhs += 16, rhs += 16, out += 16) {
+            const float32x4_t a0{ vld1q_f32(lhs + 0) };
+            const float32x4_t a1{ vld1q_f32(lhs + 4) };
+            const float32x4_t a2{ vld1q_f32(lhs + 8) };
+            const float32x4_t a3{ vld1q_f32(lhs + 12) };
+            for(size_t col = 0; col < 4; ++col) {
+                const float *b{ rhs + col * 4 };
+                // separate mul and add: vmlaq/vfmaq would fuse and break bit-exactness
+                float32x4_t r{ vmulq_n_f32(a0, b[0]) };
+                r = vaddq_f32(r, vmulq_n_f32(a1, b[1]));
+                r = vaddq_f32(r, vmulq_n_f32(a2, b[2]));
+                r = vaddq_f32(r, vmulq_n_f32(a3, b[3]));
+                vst1q_f32(out + col * 4, r);
+            }
+        }
+    }
+#endif // BATCHMATH_NEON
+
+    bool isSupported(Backend backend) {
+        switch(backend) {
+            case Backend::Scalar:
+                return true;
+        #if defined(BATCHMATH_X86)
+            case Backend::SSE:
+                return true;
+            case Backend::AVX2: {
+                static const bool avx2{ cpuHasAvx2() };
+                return avx2;
+            }
+        #endif
+        #if defined(BATCHMATH_NEON)
+            case Backend::NEON:
+                return true;
+        #endif
+            default:
+                return false;
+        }
+    }
+
+    Backend &activeBackend() {
+        static Backend backend{ Detect() };
+        return backend;
+    }
+} // anon namespace
+
+namespace BatchMath {
+
+Backend Detect() {
+    for(const auto backend : { Backend::AVX2, Backend::NEON, Backend::SSE }) {
+        if(isSupported(backend)) {
+            return backend;
+        }
+    }
+    return Backend::Scalar;
+}
+
+Backend Active() {
+    return activeBackend();
+}
+
+bool Select(Backend backend) {
+    if(!isSupported(backend)) {
+        LOGW << "[BatchMath] Backend " << Name(backend) << " is not supported by this CPU";
+        return false;
+    }
+    activeBackend() = backend;
+    return true;
+}
+
+const char *Name(Backend backend) {
+    switch(backend) {
+        case Backend::Scalar: return "scalar";
+        case Backend::SSE: return "sse";
+        case Backend::AVX2: return "avx2";
+        case Backend::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+void Multiply(const glm::mat4 *lhs, const glm::mat4 *rhs, glm::mat4 *out, size_t count) {
+    const float *a{ asFloats(lhs) };
+    const float *b{ asFloats(rhs) };
+    float *r{ asFloats(out) };
+    switch(Active()) {
+    #if defined(BATCHMATH_X86)
+        case Backend::AVX2:
+            Kernels::MultiplyAvx2(a, b, r, count);
+            return;
+        case Backend::SSE:
+            multiplySse(a, b, r, count);
+            return;
+    #endif
+    #if defined(BATCHMATH_NEON)
+        case Backend::NEON:
+            multiplyNeon(a, b, r, count);
+            return;
+    #endif
+        default:
+            Lanes::Multiply<Lanes::Scalar>(a, b, r, count);
+            return;
+    }
+}
+
+void ComposeTRS(const glm::vec3 *t, const glm::quat *r, const glm::vec3 *s, glm::mat4 *out, size_t count) {
+    const float *tt{ asFloats(t) };
+    const float *qq{ asFloats(r) };
+    const float *ss{ asFloats(s) };
+    float *m{ asFloats(out) };
+    size_t done{ 0 };
+    switch(Active()) {
+    #if defined(BATCHMATH_X86)
+        case Backend::AVX2:
+            done = Kernels::ComposeTRSAvx2(tt, qq, ss, m, count);
+            break;
+        case Backend::SSE:
+            done = Lanes::ComposeTRS<LaneSse>(tt, qq, ss, m, count);
+            break;
+    #endif
+    #if defined(BATCHMATH_NEON)
+        case Backend::NEON:
+            done = Lanes::ComposeTRS<LaneNeon>(tt, qq, ss, m, count);
+            break;
+    #endif
+        default:
+            break;
+    }
+    Lanes::ComposeTRS<Lanes::Scalar>(tt + done * 3, qq + done * 4, ss + done * 3, m + done * 16, count - done);
+}
+
+void InverseTranspose(const glm::mat4 *in, glm::mat4 *out, size_t count) {
+    const float *src{ asFloats(in) };
+    float *dst{ asFloats(out) };
+    size_t done{ 0 };
+    switch(Active()) {
+    #if defined(BATCHMATH_X86)
+        case Backend::AVX2:
+            done = Kernels::InverseTransposeAvx2(src, dst, count);
+            break;
+        case Backend::SSE:
+            done = Lanes::InverseTranspose<LaneSse>(src, dst, count);
+            break;
+    #endif
+    #if defined(BATCHMATH_NEON)
+        case Backend::NEON:
+            done = Lanes::InverseTranspose<LaneNeon>(src, dst, count);
+            break;
+    #endif
+        default:
+            break;
+    }
+    Lanes::InverseTranspose<Lanes::Scalar>(src + done * 16, dst + done * 16, count - done);
+}
+
+void TransformPoints(const glm::mat4 &m, const glm::vec3 *in, glm::vec3 *out, size_t count) {
+    const float *mat{ glm::value_ptr(m) };
+    const float *src{ asFloats(in) };
+    float *dst{ asFloats(out) };
+    size_t done{ 0 };
+    switch(Active()) {
+    #if defined(BATCHMATH_X86)
+        case Backend::AVX2:
+            done = Kernels::TransformPointsAvx2(mat, src, dst, count);
+            break;
+        case Backend::SSE:
+            done = Lanes::TransformPoints<LaneSse>(mat, src, dst, count);
+            break;
+    #endif
+    #if defined(BATCHMATH_NEON)
+        case Backend::NEON:
+            done = Lanes::TransformPoints<LaneNeon>(mat, src, dst, count);
+            break;
+    #endif
+        default:
+            break;
+    }
+    Lanes::TransformPoints<Lanes::Scalar>(mat, src + done * 3, dst + done * 3, count - done);
+}
+
+void TransformAABBs(const glm::mat4 *m, const AABB *in, AABB *out, size_t count) {
+    const float *mat{ asFloats(m) };
+    const float *src{ asFloats(in) };
+    float *dst{ asFloats(out) };
+    size_t done{ 0 };
+    switch(Active()) {
+    #if defined(BATCHMATH_X86)
+        case Backend::AVX2:
+            done = Kernels::TransformAABBsAvx2(mat, src, dst, count);
+            break;
+        case Backend::SSE:
+            done = Lanes::TransformAABBs<LaneSse>(mat, src, dst, count);
+            break;
+    #endif
+    #if defined(BATCHMATH_NEON)
+        case Backend::NEON:
+            done = Lanes::TransformAABBs<LaneNeon>(mat, src, dst, count);
+            break;
+    #endif
+        default:
+            break;
+    }
+    Lanes::TransformAABBs<Lanes::Scalar>(mat + done * 16, src + done * 6, dst + done * 6, count - done);
+}
+
+} // namespace BatchMath
@@ -0,0 +1,44 @@
+#ifndef __BATCHMATH_H__
+#define __BATCHMATH_H__
+
+#include <cstddef>
+
+/**
+ * Batched matrix/vector kernels over arrays of glm types.
+ * Every kernel has a scalar, SSE, AVX2 and NEON path; the best one supported
+ * by the running CPU is picked once at startup. All paths do the very same
+ * float operations in the same order as the glm expression noted next to
+ * each kernel, so results are bit-for-bit equal to a plain glm loop.
+ */
+namespace BatchMath {
+
+enum class Backend { Scalar, SSE, AVX2, NEON };
+
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+Backend Detect();
+Backend Active();
+bool Select(Backend backend);
+const char *Name(Backend backend);
+
+/// out[i] = lhs[i] * rhs[i]
+void Multiply(const glm::mat4 *lhs, const glm::mat4 *rhs, glm::mat4 *out, size_t count);
+
+/// out[i] = mat4_cast(r[i]) with columns scaled by s[i] and translation t[i]
+void ComposeTRS(const glm::vec3 *t, const glm::quat *r, const glm::vec3 *s, glm::mat4 *out, size_t count);
+
+/// out[i] = glm::inverseTranspose(in[i])
+void InverseTranspose(const glm::mat4 *in, glm::mat4 *out, size_t count);
+
+/// out[i] = glm::vec3(m * glm::vec4(in[i], 1.0f))
+void TransformPoints(const glm::mat4 &m, const glm::vec3 *in, glm::vec3 *out, size_t count);
+
+/// out[i] = min/max over the eight corners of in[i] transformed by m[i]
+void TransformAABBs(const glm::mat4 *m, const AABB *in, AABB *out, size_t count);
+
+} // namespace BatchMath
+
+#endif // __BATCHMATH_H__
@@ -0,0 +1,69 @@
+// This unit is compiled with AVX2 enabled (see CMakeLists.txt) and is only
+// entered after BatchMath has checked the CPU. Keep it free of glm and other
+// inline library code so no AVX2-encoded copy of a shared inline function
+// can leak into the rest of the program.
+#include "batchmath_lanes.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+    struct LaneAvx {
+        static constexpr size_t Width{ 8 };
+        __m256 v;
+
+        static LaneAvx Load(const float *p) { return { _mm256_load_ps(p) }; }
+        static LaneAvx Splat(float f) { return { _mm256_set1_ps(f) }; }
+        void Store(float *p) const { _mm256_store_ps(p, v); }
+
+        static LaneAvx Min(LaneAvx a, LaneAvx b) { return { _mm256_min_ps(b.v, a.v) }; }
+        static LaneAvx Max(LaneAvx a, LaneAvx b) { return { _mm256_max_ps(b.v, a.v) }; }
+
+        friend LaneAvx operator+(LaneAvx a, LaneAvx b) { return { _mm256_add_ps(a.v, b.v) }; }
+        friend LaneAvx operator-(LaneAvx a, LaneAvx b) { return { _mm256_sub_ps(a.v, b.v) }; }
+        friend LaneAvx operator*(LaneAvx a, LaneAvx b) { return { _mm256_mul_ps(a.v, b.v) }; }
+        friend LaneAvx operator/(LaneAvx a, LaneAvx b) { return { _mm256_div_ps(a.v, b.v) }; }
+        friend LaneAvx operator-(LaneAvx a) { return { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) }; }
+    };
+}
+
+namespace BatchMath::Kernels {
+
+void MultiplyAvx2(const float *lhs, const float *rhs, float *out, size_t count) {
+    // two result columns per register: lhs columns are duplicated into both
+    // halves, the matching rhs elements are splatted within each half
+    for(size_t i = 0; i < count; ++i, lhs += 16, rhs += 16, out += 16) {
+        const __m256 a0{ _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(lhs + 0)) };
+        const __m256 a1{ _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(lhs + 4)) };
+        const __m256 a2{ _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(lhs + 8)) };
+        const __m256 a3{ _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(lhs + 12)) };
+        for(size_t col = 0; col < 4; col += 2) {
+            const __m256 b{ _mm256_loadu_ps(rhs + col * 4) };
+            __m256 r{ _mm256_mul_ps(a0, _mm256_permute_ps(b, _MM_SHUFFLE(0, 0, 0, 0))) };
+            r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(b, _MM_SHUFFLE(1, 1, 1, 1))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(b, _MM_SHUFFLE(2, 2, 2, 2))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(b, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm256_storeu_ps(out + col * 4, r);
+        }
+    }
+}
+
+size_t ComposeTRSAvx2(const float *t, const float *q, const float *s, float *out, size_t count) {
+    return Lanes::ComposeTRS<LaneAvx>(t, q, s, out, count);
+}
+
+size_t InverseTransposeAvx2(const float *in, float *out, size_t count) {
+    return Lanes::InverseTranspose<LaneAvx>(in, out, count);
+}
+
+size_t TransformPointsAvx2(const float *m, const float *in, float *out, size_t count) {
+    return Lanes::TransformPoints<LaneAvx>(m, in, out, count);
+}
+
+size_t TransformAABBsAvx2(const float *m, const float *in, float *out, size_t count) {
+    return Lanes::TransformAABBs<LaneAvx>(m, in, out, count);
+}
+
+} // namespace BatchMath::Kernels
+
+#endif // __AVX2__
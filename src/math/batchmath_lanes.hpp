@@ -0,0 +1,300 @@
+#ifndef __BATCHMATH_LANES_H__
+#define __BATCHMATH_LANES_H__
+
+#include <cstddef>
+
+/**
+ * Lane-generic kernel bodies shared by every BatchMath backend.
+ * A lane type V holds Width floats and provides Load/Splat/Store, the four
+ * arithmetic operators, unary minus and glm-compatible Min/Max. Kernels
+ * transpose Width items to structure-of-arrays, run the same formula glm
+ * uses on all lanes at once and transpose back. Each kernel returns how many
+ * items it processed (a multiple of Width); the caller finishes the tail.
+ *
+ * Only raw float pointers here: this header is compiled with extra ISA flags.
+ */
+namespace BatchMath::Lanes {
+
+template<size_t Elems, size_t Width>
+inline void gather(const float *src, size_t stride, float *soa) {
+    for(size_t lane = 0; lane < Width; ++lane) {
+        for(size_t e = 0; e < Elems; ++e) {
+            soa[e * Width + lane] = src[lane * stride + e];
+        }
+    }
+}
+
+template<size_t Elems, size_t Width>
+inline void scatter(const float *soa, float *dst, size_t stride) {
+    for(size_t lane = 0; lane < Width; ++lane) {
+        for(size_t e = 0; e < Elems; ++e) {
+            dst[lane * stride + e] = soa[e * Width + lane];
+        }
+    }
+}
+
+/// glm: Result[j] = SrcA0 * SrcB[j][0] + SrcA1 * SrcB[j][1] + SrcA2 * SrcB[j][2] + SrcA3 * SrcB[j][3]
+template<class V>
+size_t Multiply(const float *lhs, const float *rhs, float *out, size_t count) {
+    constexpr size_t W{ V::Width };
+    alignas(32) float a[16 * W];
+    alignas(32) float b[16 * W];
+    size_t i{ 0 };
+    for(; i + W <= count; i += W) {
+        gather<16, W>(lhs + i * 16, 16, a);
+        gather<16, W>(rhs + i * 16, 16, b);
+        V r[16];
+        for(size_t col = 0; col < 4; ++col) {
+            const V b0{ V::Load(b + (col * 4 + 0) * W) };
+            const V b1{ V::Load(b + (col * 4 + 1) * W) };
+            const V b2{ V::Load(b + (col * 4 + 2) * W) };
+            const V b3{ V::Load(b + (col * 4 + 3) * W) };
+            for(size_t row = 0; row < 4; ++row) {
+                r[col * 4 + row] =
+                    V::Load(a + (0 * 4 + row) * W) * b0 +
+                    V::Load(a + (1 * 4 + row) * W) * b1 +
+                    V::Load(a + (2 * 4 + row) * W) * b2 +
+                    V::Load(a + (3 * 4 + row) * W) * b3;
+            }
+        }
+        for(size_t e = 0; e < 16; ++e) {
+            r[e].Store(a + e * W);
+        }
+        scatter<16, W>(a, out + i * 16, 16);
+    }
+    return i;
+}
+
+/// glm: mat4_cast(q), columns 0..2 scaled by s.x/s.y/s.z, column 3 = vec4(t, 1)
+template<class V>
+size_t ComposeTRS(const float *t, const float *q, const float *s, float *out, size_t count) {
+    constexpr size_t W{ V::Width };
+    alignas(32) float tt[3 * W];
+    alignas(32) float qq[4 * W];
+    alignas(32) float ss[3 * W];
+    alignas(32) float m[16 * W];
+    const V one{ V::Splat(1.0f) };
+    const V two{ V::Splat(2.0f) };
+    const V zero{ V::Splat(0.0f) };
+    size_t i{ 0 };
+    for(; i + W <= count; i += W) {
+        gather<3, W>(t + i * 3, 3, tt);
+        gather<4, W>(q + i * 4, 4, qq);
+        gather<3, W>(s + i * 3, 3, ss);
+        const V x{ V::Load(qq + 0 * W) };
+        const V y{ V::Load(qq + 1 * W) };
+        const V z{ V::Load(qq + 2 * W) };
+        const V w{ V::Load(qq + 3 * W) };
+
+        const V qxx{ x * x };
+        const V qyy{ y * y };
+        const V qzz{ z * z };
+        const V qxz{ x * z };
+        const V qxy{ x * y };
+        const V qyz{ y * z };
+        const V qwx{ w * x };
+        const V qwy{ w * y };
+        const V qwz{ w * z };
+
+        const V sx{ V::Load(ss + 0 * W) };
+        const V sy{ V::Load(ss + 1 * W) };
+        const V sz{ V::Load(ss + 2 * W) };
+
+        ((one - two * (qyy + qzz)) * sx).Store(m + 0 * W);
+        ((two * (qxy + qwz)) * sx).Store(m + 1 * W);
+        ((two * (qxz - qwy)) * sx).Store(m + 2 * W);
+        (zero * sx).Store(m + 3 * W);
+
+        ((two * (qxy - qwz)) * sy).Store(m + 4 * W);
+        ((one - two * (qxx + qzz)) * sy).Store(m + 5 * W);
+        ((two * (qyz + qwx)) * sy).Store(m + 6 * W);
+        (zero * sy).Store(m + 7 * W);
+
+        ((two * (qxz + qwy)) * sz).Store(m + 8 * W);
+        ((two * (qyz - qwx)) * sz).Store(m + 9 * W);
+        ((one - two * (qxx + qyy)) * sz).Store(m + 10 * W);
+        (zero * sz).Store(m + 11 * W);
+
+        V::Load(tt + 0 * W).Store(m + 12 * W);
+        V::Load(tt + 1 * W).Store(m + 13 * W);
+        V::Load(tt + 2 * W).Store(m + 14 * W);
+        one.Store(m + 15 * W);
+
+        scatter<16, W>(m, out + i * 16, 16);
+    }
+    return i;
+}
+
+/// glm: inverseTranspose(m), cofactors via SubFactorNN and division by the determinant
+template<class V>
+size_t InverseTranspose(const float *in, float *out, size_t count) {
+    constexpr size_t W{ V::Width };
+    alignas(32) float soa[16 * W];
+    size_t i{ 0 };
+    for(; i + W <= count; i += W) {
+        gather<16, W>(in + i * 16, 16, soa);
+        V m[4][4];
+        for(size_t col = 0; col < 4; ++col) {
+            for(size_t row = 0; row < 4; ++row) {
+                m[col][row] = V::Load(soa + (col * 4 + row) * W);
+            }
+        }
+
+        const V SubFactor00{ m[2][2] * m[3][3] - m[3][2] * m[2][3] };
+        const V SubFactor01{ m[2][1] * m[3][3] - m[3][1] * m[2][3] };
+        const V SubFactor02{ m[2][1] * m[3][2] - m[3][1] * m[2][2] };
+        const V SubFactor03{ m[2][0] * m[3][3] - m[3][0] * m[2][3] };
+        const V SubFactor04{ m[2][0] * m[3][2] - m[3][0] * m[2][2] };
+        const V SubFactor05{ m[2][0] * m[3][1] - m[3][0] * m[2][1] };
+        const V SubFactor06{ m[1][2] * m[3][3] - m[3][2] * m[1][3] };
+        const V SubFactor07{ m[1][1] * m[3][3] - m[3][1] * m[1][3] };
+        const V SubFactor08{ m[1][1] * m[3][2] - m[3][1] * m[1][2] };
+        const V SubFactor09{ m[1][0] * m[3][3] - m[3][0] * m[1][3] };
+        const V SubFactor10{ m[1][0] * m[3][2] - m[3][0] * m[1][2] };
+        const V SubFactor11{ m[1][1] * m[3][3] - m[3][1] * m[1][3] };
+        const V SubFactor12{ m[1][0] * m[3][1] - m[3][0] * m[1][1] };
+        const V SubFactor13{ m[1][2] * m[2][3] - m[2][2] * m[1][3] };
+        const V SubFactor14{ m[1][1] * m[2][3] - m[2][1] * m[1][3] };
+        const V SubFactor15{ m[1][1] * m[2][2] - m[2][1] * m[1][2] };
+        const V SubFactor16{ m[1][0] * m[2][3] - m[2][0] * m[1][3] };
+        const V SubFactor17{ m[1][0] * m[2][2] - m[2][0] * m[1][2] };
+        const V SubFactor18{ m[1][0] * m[2][1] - m[2][0] * m[1][1] };
+
+        V r[4][4];
+        r[0][0] =  (m[1][1] * SubFactor00 - m[1][2] * SubFactor01 + m[1][3] * SubFactor02);
+        r[0][1] = -(m[1][0] * SubFactor00 - m[1][2] * SubFactor03 + m[1][3] * SubFactor04);
+        r[0][2] =  (m[1][0] * SubFactor01 - m[1][1] * SubFactor03 + m[1][3] * SubFactor05);
+        r[0][3] = -(m[1][0] * SubFactor02 - m[1][1] * SubFactor04 + m[1][2] * SubFactor05);
+
+        r[1][0] = -(m[0][1] * SubFactor00 - m[0][2] * SubFactor01 + m[0][3] * SubFactor02);
+        r[1][1] =  (m[0][0] * SubFactor00 - m[0][2] * SubFactor03 + m[0][3] * SubFactor04);
+        r[1][2] = -(m[0][0] * SubFactor01 - m[0][1] * SubFactor03 + m[0][3] * SubFactor05);
+        r[1][3] =  (m[0][0] * SubFactor02 - m[0][1] * SubFactor04 + m[0][2] * SubFactor05);
+
+        r[2][0] =  (m[0][1] * SubFactor06 - m[0][2] * SubFactor07 + m[0][3] * SubFactor08);
+        r[2][1] = -(m[0][0] * SubFactor06 - m[0][2] * SubFactor09 + m[0][3] * SubFactor10);
+        r[2][2] =  (m[0][0] * SubFactor11 - m[0][1] * SubFactor09 + m[0][3] * SubFactor12);
+        r[2][3] = -(m[0][0] * SubFactor08 - m[0][1] * SubFactor10 + m[0][2] * SubFactor12);
+
+        r[3][0] = -(m[0][1] * SubFactor13 - m[0][2] * SubFactor14 + m[0][3] * SubFactor15);
+        r[3][1] =  (m[0][0] * SubFactor13 - m[0][2] * SubFactor16 + m[0][3] * SubFactor17);
+        r[3][2] = -(m[0][0] * SubFactor14 - m[0][1] * SubFactor16 + m[0][3] * SubFactor18);
+        r[3][3] =  (m[0][0] * SubFactor15 - m[0][1] * SubFactor17 + m[0][2] * SubFactor18);
+
+        const V determinant{
+            m[0][0] * r[0][0] +
+            m[0][1] * r[0][1] +
+            m[0][2] * r[0][2] +
+            m[0][3] * r[0][3]
+        };
+
+        for(size_t col = 0; col < 4; ++col) {
+            for(size_t row = 0; row < 4; ++row) {
+                (r[col][row] / determinant).Store(soa + (col * 4 + row) * W);
+            }
+        }
+        scatter<16, W>(soa, out + i * 16, 16);
+    }
+    return i;
+}
+
+/// glm: vec3(m * vec4(p, 1)) == (m[0] * p.x + m[1] * p.y) + (m[2] * p.z + m[3] * 1)
+template<class V>
+size_t TransformPoints(const float *m, const float *in, float *out, size_t count) {
+    constexpr size_t W{ V::Width };
+    alignas(32) float soa[3 * W];
+    size_t i{ 0 };
+    for(; i + W <= count; i += W) {
+        gather<3, W>(in + i * 3, 3, soa);
+        const V x{ V::Load(soa + 0 * W) };
+        const V y{ V::Load(soa + 1 * W) };
+        const V z{ V::Load(soa + 2 * W) };
+        V r[3];
+        for(size_t row = 0; row < 3; ++row) {
+            r[row] = (V::Splat(m[0 * 4 + row]) * x + V::Splat(m[1 * 4 + row]) * y) +
+                     (V::Splat(m[2 * 4 + row]) * z + V::Splat(m[3 * 4 + row]));
+        }
+        for(size_t row = 0; row < 3; ++row) {
+            r[row].Store(soa + row * W);
+        }
+        scatter<3, W>(soa, out + i * 3, 3);
+    }
+    return i;
+}
+
+/// glm: for corners c = 0..7 (bit 0 -> x, bit 1 -> y, bit 2 -> z picks max),
+/// w = vec3(m * vec4(corner, 1)); lo = min(lo, w); hi = max(hi, w)
+template<class V>
+size_t TransformAABBs(const float *m, const float *in, float *out, size_t count) {
+    constexpr size_t W{ V::Width };
+    alignas(32) float mat[16 * W];
+    alignas(32) float box[6 * W];
+    size_t i{ 0 };
+    for(; i + W <= count; i += W) {
+        gather<16, W>(m + i * 16, 16, mat);
+        gather<6, W>(in + i * 6, 6, box);
+        const V bmin[3]{ V::Load(box + 0 * W), V::Load(box + 1 * W), V::Load(box + 2 * W) };
+        const V bmax[3]{ V::Load(box + 3 * W), V::Load(box + 4 * W), V::Load(box + 5 * W) };
+        V lo[3];
+        V hi[3];
+        for(size_t row = 0; row < 3; ++row) {
+            const V c0{ V::Load(mat + (0 * 4 + row) * W) };
+            const V c1{ V::Load(mat + (1 * 4 + row) * W) };
+            const V c2{ V::Load(mat + (2 * 4 + row) * W) };
+            const V c3{ V::Load(mat + (3 * 4 + row) * W) };
+            const V mx[2]{ c0 * bmin[0], c0 * bmax[0] };
+            const V my[2]{ c1 * bmin[1], c1 * bmax[1] };
+            const V mz[2]{ c2 * bmin[2], c2 * bmax[2] };
+            const V xy[4]{ mx[0] + my[0], mx[1] + my[0], mx[0] + my[1], mx[1] + my[1] };
+            const V zw[2]{ mz[0] + c3, mz[1] + c3 };
+            lo[row] = hi[row] = xy[0] + zw[0];
+            for(size_t corner = 1; corner < 8; ++corner) {
+                const V value{ xy[corner & 3] + zw[corner >> 2] };
+                lo[row] = V::Min(lo[row], value);
+                hi[row] = V::Max(hi[row], value);
+            }
+        }
+        for(size_t row = 0; row < 3; ++row) {
+            lo[row].Store(box + row * W);
+            hi[row].Store(box + (row + 3) * W);
+        }
+        scatter<6, W>(box, out + i * 6, 6);
+    }
+    return i;
+}
+
+/// One float per lane: the reference path, also used for the tails.
+struct Scalar {
+    static constexpr size_t Width{ 1 };
+    float v;
+
+    static Scalar Load(const float *p) { return { *p }; }
+    static Scalar Splat(float f) { return { f }; }
+    void Store(float *p) const { *p = v; }
+
+    /// glm::min(a, b) == (b < a) ? b : a
+    static Scalar Min(Scalar a, Scalar b) { return { b.v < a.v ? b.v : a.v }; }
+    /// glm::max(a, b) == (a < b) ? b : a
+    static Scalar Max(Scalar a, Scalar b) { return { a.v < b.v ? b.v : a.v }; }
+
+    friend Scalar operator+(Scalar a, Scalar b) { return { a.v + b.v }; }
+    friend Scalar operator-(Scalar a, Scalar b) { return { a.v - b.v }; }
+    friend Scalar operator*(Scalar a, Scalar b) { return { a.v * b.v }; }
+    friend Scalar operator/(Scalar a, Scalar b) { return { a.v / b.v }; }
+    friend Scalar operator-(Scalar a) { return { -a.v }; }
+};
+
+} // namespace BatchMath::Lanes
+
+namespace BatchMath::Kernels {
+
+// Implemented in batchmath_avx2.cpp, which is the only unit built with AVX2 enabled.
+void MultiplyAvx2(const float *lhs, const float *rhs, float *out, size_t count);
+size_t ComposeTRSAvx2(const float *t, const float *q, const float *s, float *out, size_t count);
+size_t InverseTransposeAvx2(const float *in, float *out, size_t count);
+size_t TransformPointsAvx2(const float *m, const float *in, float *out, size_t count);
+size_t TransformAABBsAvx2(const float *m, const float *in, float *out, size_t count);
+
+} // namespace BatchMath::Kernels
+
+#endif // __BATCHMATH_LANES_H__
@@ -0,0 +1,422 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#include "profiler.hpp"
+#include "trace.hpp"
+
+namespace {
+    constexpr size_t kKeptFrames{ Profiler::Latency + 4 };
+    constexpr float kMinTimelineMs{ 1.0f };
+
+    struct CpuOpen {
+        const char *name;
+        double begin;
+        bool recorded;
+        int64_t traceBegin;   ///< -1 when no trace capture was running
+        uint64_t frame;
+    };
+
+    thread_local std::vector<CpuOpen> tCpuStack;
+    thread_local uint16_t tLane{ 0 };
+
+    const Profiler::Clock::time_point kEpoch{ Profiler::Clock::now() };
+
+    double nowMs() {
+        return std::chrono::duration<double, std::milli>(Profiler::Clock::now() - kEpoch).count();
+    }
+
+    ImU32 colorOf(const char *name, bool gpu) {
+        uint32_t hash{ 2166136261u };
+        for(const char *c = name; *c; ++c) {
+            hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+        }
+        const int r{ gpu ? 90 + static_cast<int>(hash % 60) : 150 + static_cast<int>(hash % 90) };
+        const int g{ 100 + static_cast<int>((hash >> 8) % 100) };
+        const int b{ gpu ? 160 + static_cast<int>((hash >> 16) % 80) : 60 + static_cast<int>((hash >> 16) % 60) };
+        return IM_COL32(r, g, b, 255);
+    }
+
+    void sumByName(const std::vector<Profiler::Event> &events, bool gpu, std::unordered_map<std::string, double> &sums) {
+        for(const auto &event : events) {
+            if((0 == event.lane) == gpu) {
+                sums[std::string{ gpu ? "GPU " : "CPU " } + event.name] += event.end - event.begin;
+            }
+        }
+    }
+}
+
+Profiler *Profiler::Instance() {
+    static Profiler profiler;
+    return &profiler;
+}
+
+void Profiler::SetEnabled(bool enabled) {
+    mEnabled = enabled;
+}
+
+bool Profiler::Enabled() const {
+    return mEnabled;
+}
+
+//================================ FRAMES ===================================//
+
+void Profiler::BeginFrame() {
+    mInFrame = mEnabled;
+    if(!mInFrame) {
+        return;
+    }
+    for(auto &frame : mGpuFrames) {
+        ResolveGpu(frame);
+    }
+    auto &gpu{ mGpuFrames[mFrameIndex % mGpuFrames.size()] };
+    if(gpu.pending) {
+        // still not finished after Latency frames: drop rather than wait
+        if(0 == mGpuDropped++) {
+            LOGW << "[Profiler] GPU results late, dropping frame " << gpu.index;
+        }
+    }
+    gpu.index = mFrameIndex;
+    gpu.pending = false;
+    gpu.traceOffset = 0;
+    if(Trace::Instance()->Capturing()) {
+        // pairs the GPU clock with the trace clock once per frame; the GL time
+        // query only waits for the commands to reach the server, not the GPU
+        GLint64 gpuNow{ 0 };
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpu.traceOffset = Trace::Now() - gpuNow;
+    }
+    gpu.used = 0;
+    gpu.scopes.clear();
+    mGpuStack.clear();
+    {
+        std::lock_guard<std::mutex> lock{ mLock };
+        mCurrent.index = mFrameIndex;
+        mCurrent.start = nowMs();
+    }
+    mOpenFrame = mFrameIndex;
+    PushGpu("Frame");
+}
+
+void Profiler::EndFrame() {
+    if(!mInFrame) {
+        return;
+    }
+    while(!mGpuStack.empty()) {
+        PopGpu();
+    }
+    auto &gpu{ mGpuFrames[mFrameIndex % mGpuFrames.size()] };
+    gpu.pending = gpu.used > 0;
+    mInFrame = false;
+
+    std::lock_guard<std::mutex> lock{ mLock };
+    const double start{ mCurrent.start };
+    mCurrent.cpu = nowMs() - start;
+    for(auto &event : mCurrent.events) {
+        event.begin -= start;
+        event.end -= start;
+    }
+    std::unordered_map<std::string, double> sums;
+    sumByName(mCurrent.events, false, sums);
+    sums["CPU Frame"] = mCurrent.cpu;
+    for(const auto &[key, ms] : sums) {
+        AddSample(key, ms, mCurrent.index);
+    }
+    mHistory.push_back(std::move(mCurrent));
+    while(mHistory.size() > kKeptFrames) {
+        mHistory.pop_front();
+    }
+    mCurrent = Frame{};
+    mCurrent.index = ++mFrameIndex;
+}
+
+//================================ SCOPES ===================================//
+
+void Profiler::PushCpu(const char *name) {
+    tCpuStack.push_back({ name, nowMs(), mEnabled, Trace::Instance()->Capturing() ? Trace::Now() : -1, mOpenFrame });
+}
+
+void Profiler::PopCpu() {
+    if(tCpuStack.empty()) {
+        return;
+    }
+    const CpuOpen open{ tCpuStack.back() };
+    tCpuStack.pop_back();
+    if(open.traceBegin >= 0) {
+        Trace::Instance()->Record("frame", open.name, open.traceBegin, Trace::Now());
+    }
+    if(!open.recorded) {
+        return;
+    }
+    if(0 == tLane) {
+        tLane = mLanes.fetch_add(1);
+    }
+    const double end{ nowMs() };
+    const uint16_t depth{ static_cast<uint16_t>(tCpuStack.size()) };
+    std::lock_guard<std::mutex> lock{ mLock };
+    if(open.frame == mCurrent.index) {
+        // made relative to the frame start by EndFrame
+        mCurrent.events.push_back({ open.name, open.begin, end, depth, tLane });
+        return;
+    }
+    // opened in a frame that has ended already, e.g. by a pipelined job
+    for(auto &kept : mHistory) {
+        if(kept.index == open.frame) {
+            kept.events.push_back({ open.name, open.begin - kept.start, end - kept.start, depth, tLane });
+            AddSample(std::string{ "CPU " } + open.name, end - open.begin, kept.index);
+            break;
+        }
+    }
+}
+
+void Profiler::PushGpu(const char *name) {
+    if(!mInFrame) {
+        return;
+    }
+    auto &gpu{ mGpuFrames[mFrameIndex % mGpuFrames.size()] };
+    const size_t begin{ gpu.used };
+    glQueryCounter(NextQuery(gpu), GL_TIMESTAMP);
+    mGpuStack.push_back(gpu.scopes.size());
+    gpu.scopes.push_back({ name, static_cast<uint16_t>(mGpuStack.size() - 1), begin, begin });
+}
+
+void Profiler::PopGpu() {
+    if(!mInFrame || mGpuStack.empty()) {
+        return;
+    }
+    auto &gpu{ mGpuFrames[mFrameIndex % mGpuFrames.size()] };
+    gpu.scopes[mGpuStack.back()].end = gpu.used;
+    glQueryCounter(NextQuery(gpu), GL_TIMESTAMP);
+    mGpuStack.pop_back();
+}
+
+unsigned Profiler::NextQuery(GpuFrame &frame) {
+    if(frame.used == frame.queries.size()) {
+        const size_t grow{ std::max<size_t>(16, frame.queries.size()) };
+        frame.queries.resize(frame.queries.size() + grow);
+        glGenQueries(static_cast<GLsizei>(grow), frame.queries.data() + frame.used);
+    }
+    return frame.queries[frame.used++];
+}
+
+void Profiler::ResolveGpu(GpuFrame &frame) {
+    if(!frame.pending) {
+        return;
+    }
+    // queries complete in order: the last one being ready means all are
+    GLint available{ 0 };
+    glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available) {
+        return;
+    }
+    std::vector<GLuint64> stamps(frame.used);
+    for(size_t i = 0; i < frame.used; ++i) {
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &stamps[i]);
+    }
+    frame.pending = false;
+
+    std::vector<Event> events;
+    events.reserve(frame.scopes.size());
+    const GLuint64 origin{ stamps.front() };
+    for(const auto &scope : frame.scopes) {
+        events.push_back({ scope.name, (stamps[scope.begin] - origin) * 1e-6, (stamps[scope.end] - origin) * 1e-6, scope.depth, 0 });
+        if(0 != frame.traceOffset) {
+            Trace::Instance()->RecordGpu(scope.name,
+                static_cast<int64_t>(stamps[scope.begin]) + frame.traceOffset,
+                static_cast<int64_t>(stamps[scope.end]) + frame.traceOffset);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock{ mLock };
+    std::unordered_map<std::string, double> sums;
+    sumByName(events, true, sums);
+    for(const auto &[key, ms] : sums) {
+        AddSample(key, ms, frame.index);
+    }
+    for(auto &kept : mHistory) {
+        if(kept.index == frame.index) {
+            kept.gpu = (stamps.back() - origin) * 1e-6;
+            kept.gpuResolved = true;
+            kept.events.insert(kept.events.end(), events.begin(), events.end());
+            break;
+        }
+    }
+}
+
+//================================ STATS ====================================//
+
+void Profiler::AddSample(const std::string &key, double ms, uint64_t frame) {
+    auto &sample{ mSamples[key] };
+    // a scope that ends after its frame was filed joins that frame's total;
+    // values are in frame order, so in-order frames stop at the newest one
+    for(size_t back = 1; back <= std::min(sample.count, HistoryFrames); ++back) {
+        const size_t slot{ (sample.count - back) % HistoryFrames };
+        if(sample.frames[slot] < frame) {
+            break;
+        }
+        if(sample.frames[slot] == frame) {
+            sample.values[slot] += ms;
+            return;
+        }
+    }
+    sample.values[sample.count % HistoryFrames] = ms;
+    sample.frames[sample.count % HistoryFrames] = frame;
+    ++sample.count;
+}
+
+Profiler::ScopeStats Profiler::Stats(const std::string &scope) const {
+    std::lock_guard<std::mutex> lock{ mLock };
+    const auto it{ mSamples.find(scope) };
+    if(mSamples.end() == it || 0 == it->second.count) {
+        return {};
+    }
+    const auto &sample{ it->second };
+    const size_t count{ std::min(sample.count, HistoryFrames) };
+    std::vector<double> values(sample.values.begin(), sample.values.begin() + count);
+
+    ScopeStats stats;
+    stats.last = sample.values[(sample.count - 1) % HistoryFrames];
+    stats.min = *std::min_element(values.begin(), values.end());
+    double sum{ 0.0 };
+    for(const auto value : values) {
+        sum += value;
+    }
+    stats.average = sum / count;
+    const size_t rank{ std::min(count - 1, (count * 99) / 100) };
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    stats.p99 = values[rank];
+    return stats;
+}
+
+const Profiler::Frame *Profiler::LatestComplete() const {
+    // frames without GPU scopes never resolve, fall back to the newest one
+    for(auto it = mHistory.rbegin(); it != mHistory.rend(); ++it) {
+        if(it->gpuResolved) {
+            return &*it;
+        }
+    }
+    return mHistory.empty() ? nullptr : &mHistory.back();
+}
+
+void Profiler::SaveTrace() const {
+    std::error_code error;
+    std::filesystem::create_directories(sTraceDirectory, error);
+    time_t now{ time(nullptr) };
+    std::stringstream name;
+    name << sTraceDirectory << "trace_" << std::put_time(localtime(&now), "%y%m%d_%H%M%S");
+    Trace::Instance()->Save(name.str() + ".json", Trace::Format::ChromeJson);
+    Trace::Instance()->Save(name.str() + ".pftrace", Trace::Format::Perfetto);
+}
+
+//================================= DRAW ====================================//
+
+void Profiler::Draw() {
+    Frame frame;
+    std::vector<std::string> keys;
+    {
+        std::lock_guard<std::mutex> lock{ mLock };
+        if(const Frame *latest{ LatestComplete() }) {
+            frame = *latest;
+        }
+        for(const auto &entry : mSamples) {
+            keys.push_back(entry.first);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+
+    ImGui::Begin("Profiler");
+    bool enabled{ mEnabled };
+    if(ImGui::Checkbox("Enabled", &enabled)) {
+        SetEnabled(enabled);
+    }
+    ImGui::SameLine();
+    auto *trace{ Trace::Instance() };
+    if(ImGui::Button(trace->Capturing() ? "Stop trace" : "Capture trace")) {
+        if(trace->Capturing()) {
+            trace->Stop();
+            SaveTrace();
+        } else {
+            trace->Start();
+        }
+    }
+    ImGui::SameLine();
+    ImGui::Text("Frame %llu: CPU %.3f ms, GPU %.3f ms", static_cast<unsigned long long>(frame.index), frame.cpu, frame.gpu);
+
+    // one band per lane, one row per nesting depth inside a band
+    uint16_t lanes{ 0 };
+    std::vector<uint16_t> depths;
+    for(const auto &event : frame.events) {
+        lanes = std::max<uint16_t>(lanes, event.lane + 1);
+        depths.resize(lanes, 0);
+        depths[event.lane] = std::max<uint16_t>(depths[event.lane], event.depth + 1);
+    }
+    std::vector<float> offsets(lanes + 1, 0.0f);
+    const float row{ ImGui::GetTextLineHeightWithSpacing() };
+    for(uint16_t lane = 0; lane < lanes; ++lane) {
+        offsets[lane + 1] = offsets[lane] + (depths[lane] + 1) * row;
+    }
+
+    const ImVec2 origin{ ImGui::GetCursorScreenPos() };
+    const float width{ std::max(1.0f, ImGui::GetContentRegionAvail().x) };
+    // CPU scopes of the frame may start before it (opened between frames) or end after it (pipelined jobs)
+    float first{ 0.0f };
+    float last{ std::max({ kMinTimelineMs, static_cast<float>(frame.cpu), static_cast<float>(frame.gpu) }) };
+    for(const auto &event : frame.events) {
+        first = std::min(first, static_cast<float>(event.begin));
+        last = std::max(last, static_cast<float>(event.end));
+    }
+    const float scale{ width / (last - first) };
+    auto *draw{ ImGui::GetWindowDrawList() };
+
+    for(uint16_t lane = 0; lane < lanes; ++lane) {
+        if(0 == depths[lane]) {
+            continue;
+        }
+        char title[32];
+        if(0 == lane) {
+            std::snprintf(title, sizeof(title), "GPU (own time base)");
+        } else {
+            std::snprintf(title, sizeof(title), "CPU thread %u", static_cast<unsigned>(lane));
+        }
+        draw->AddText(ImVec2{ origin.x, origin.y + offsets[lane] }, IM_COL32(200, 200, 200, 255), title);
+    }
+    for(const auto &event : frame.events) {
+        const float x0{ origin.x + (static_cast<float>(event.begin) - first) * scale };
+        const float x1{ origin.x + (static_cast<float>(event.end) - first) * scale };
+        const float y0{ origin.y + offsets[event.lane] + (event.depth + 1) * row };
+        const ImVec2 min{ x0, y0 };
+        const ImVec2 max{ std::max(x0 + 1.0f, x1), y0 + row - 1.0f };
+        draw->AddRectFilled(min, max, colorOf(event.name, 0 == event.lane));
+        if(ImGui::CalcTextSize(event.name).x < max.x - min.x) {
+            draw->PushClipRect(min, max, true);
+            draw->AddText(ImVec2{ x0 + 2.0f, y0 }, IM_COL32(20, 20, 20, 255), event.name);
+            draw->PopClipRect();
+        }
+        if(ImGui::IsMouseHoveringRect(min, max)) {
+            ImGui::SetTooltip("%s: %.3f ms", event.name, event.end - event.begin);
+        }
+    }
+    ImGui::Dummy(ImVec2{ width, offsets[lanes] + row });
+
+    if(ImGui::BeginTable("ProfilerStats", 5)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Last, ms");
+        ImGui::TableSetupColumn("Min, ms");
+        ImGui::TableSetupColumn("Avg, ms");
+        ImGui::TableSetupColumn("P99, ms");
+        ImGui::TableHeadersRow();
+        for(const auto &key : keys) {
+            const auto stats{ Stats(key) };
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(key.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.last);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.min);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.average);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.p99);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
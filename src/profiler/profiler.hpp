@@ -0,0 +1,148 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Hierarchical frame profiler.
+ * CPU scopes may be opened on any thread and nest per thread. GPU scopes
+ * must be opened on the thread owning the GL context; every scope brackets
+ * its commands with two GL_TIMESTAMP queries (unlike GL_TIME_ELAPSED those
+ * nest). Query results are read back Latency frames later and only when
+ * they are already available, so profiling never stalls the pipeline: a
+ * frame whose queries are still pending when its pool is reused is dropped.
+ *
+ * A CPU scope belongs to the frame it was opened in, even when a pipelined
+ * job closes it during a later one: it is filed under its own frame then.
+ *
+ * While a Trace capture runs, CPU and GPU scopes are forwarded to it too.
+ *
+ * Scope names must outlive the profiler (string literals).
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t Latency{ 3 };        ///< frames between issuing and reading GPU queries
+    static constexpr size_t HistoryFrames{ 240 };
+
+    struct Event {
+        const char *name;
+        double begin;      ///< ms from the start of the lane's frame
+        double end;
+        uint16_t depth;
+        uint16_t lane;     ///< 0 is the GPU, CPU threads follow
+    };
+
+    struct Frame {
+        uint64_t index{ 0 };
+        double start{ 0.0 };         ///< BeginFrame, ms since the profiler's epoch
+        double cpu{ 0.0 };           ///< BeginFrame to EndFrame, ms
+        double gpu{ 0.0 };           ///< first to last GPU timestamp, ms
+        bool gpuResolved{ false };
+        std::vector<Event> events;
+    };
+
+    struct ScopeStats {
+        double last{ 0.0 };
+        double min{ 0.0 };
+        double average{ 0.0 };
+        double p99{ 0.0 };
+    };
+
+    static Profiler *Instance();
+
+    void SetEnabled(bool enabled);
+    bool Enabled() const;
+
+    /// Frame boundaries, called on the GL thread.
+    void BeginFrame();
+    void EndFrame();
+
+    void PushCpu(const char *name);
+    void PopCpu();
+    void PushGpu(const char *name);
+    void PopGpu();
+
+    /// Rolling statistics over HistoryFrames samples, keyed "CPU name"/"GPU name".
+    ScopeStats Stats(const std::string &scope) const;
+
+    /// ImGui window with the flame graph of the last complete frame and the
+    /// trace capture toggle (traces are saved as JSON and Perfetto files).
+    void Draw();
+
+private:
+    struct Sample {
+        std::array<double, HistoryFrames> values{};   ///< per-frame totals
+        std::array<uint64_t, HistoryFrames> frames{};  ///< frame index of each value
+        size_t count{ 0 };
+    };
+    struct GpuScope {
+        const char *name;
+        uint16_t depth;
+        size_t begin;   ///< index into GpuFrame::queries
+        size_t end;
+    };
+    struct GpuFrame {
+        uint64_t index{ 0 };
+        bool pending{ false };
+        std::vector<unsigned> queries;
+        size_t used{ 0 };
+        std::vector<GpuScope> scopes;
+        int64_t traceOffset{ 0 };   ///< trace clock minus GPU clock, 0 if not tracing
+    };
+
+    std::atomic<bool> mEnabled{ true };
+    std::atomic<uint16_t> mLanes{ 1 };
+    std::atomic<uint64_t> mOpenFrame{ 0 };   ///< frame new CPU scopes belong to
+
+    mutable std::mutex mLock;    ///< guards everything below except mGpu*
+    Frame mCurrent;
+    std::deque<Frame> mHistory;
+    std::unordered_map<std::string, Sample> mSamples;
+    uint64_t mFrameIndex{ 0 };
+
+    bool mInFrame{ false };   ///< GL thread only, like the GPU state below
+    std::array<GpuFrame, Latency + 1> mGpuFrames{};
+    std::vector<size_t> mGpuStack;
+    uint64_t mGpuDropped{ 0 };
+
+    const std::string sTraceDirectory{ "traces/" };
+
+    Profiler() = default;
+
+    unsigned NextQuery(GpuFrame &frame);
+    void ResolveGpu(GpuFrame &frame);
+    /// Adds ms to the frame's total for key, a new value the first time.
+    void AddSample(const std::string &key, double ms, uint64_t frame);
+    const Frame *LatestComplete() const;
+    void SaveTrace() const;
+};
+
+/// RAII helpers for the macros below.
+class ProfileCpuScope {
+public:
+    explicit ProfileCpuScope(const char *name) { Profiler::Instance()->PushCpu(name); }
+    ~ProfileCpuScope() { Profiler::Instance()->PopCpu(); }
+};
+
+class ProfileGpuScope {
+public:
+    explicit ProfileGpuScope(const char *name) { Profiler::Instance()->PushGpu(name); }
+    ~ProfileGpuScope() { Profiler::Instance()->PopGpu(); }
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_CPU(name) ProfileCpuScope PROFILE_CONCAT(profileCpu, __LINE__){ name }
+#define PROFILE_GPU(name) ProfileGpuScope PROFILE_CONCAT(profileGpu, __LINE__){ name }
+
+#endif // __PROFILER_H__
@@ -0,0 +1,328 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+
+#include "trace.hpp"
+
+namespace {
+    constexpr uint32_t kPid{ 1 };
+    constexpr uint64_t kTrackBase{ 0x7a11 };   ///< Perfetto track uuids: base + track
+
+    thread_local void *tBuffer{ nullptr };
+
+    //======================== MINIMAL PROTOBUF WRITER ========================//
+
+    class Proto {
+    public:
+        void Varint(uint32_t field, uint64_t value) {
+            Key(field, 0);
+            Raw(value);
+        }
+        void String(uint32_t field, const std::string &value) {
+            Key(field, 2);
+            Raw(value.size());
+            mBytes.append(value);
+        }
+        void Message(uint32_t field, const Proto &message) {
+            String(field, message.mBytes);
+        }
+        const std::string &Bytes() const {
+            return mBytes;
+        }
+
+    private:
+        std::string mBytes;
+
+        void Key(uint32_t field, uint32_t wire) {
+            Raw((static_cast<uint64_t>(field) << 3) | wire);
+        }
+        void Raw(uint64_t value) {
+            while(value >= 0x80) {
+                mBytes.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            mBytes.push_back(static_cast<char>(value));
+        }
+    };
+
+    // field numbers from perfetto/trace/*.proto
+    namespace pb {
+        constexpr uint32_t TracePacket{ 1 };
+        constexpr uint32_t Timestamp{ 8 };
+        constexpr uint32_t SequenceId{ 10 };
+        constexpr uint32_t TrackEvent{ 11 };
+        constexpr uint32_t TrackDescriptor{ 60 };
+
+        constexpr uint32_t EventType{ 9 };
+        constexpr uint32_t EventTrack{ 11 };
+        constexpr uint32_t EventCategories{ 22 };
+        constexpr uint32_t EventName{ 23 };
+        constexpr uint64_t SliceBegin{ 1 };
+        constexpr uint64_t SliceEnd{ 2 };
+
+        constexpr uint32_t TrackUuid{ 1 };
+        constexpr uint32_t TrackName{ 2 };
+        constexpr uint32_t TrackThread{ 4 };
+        constexpr uint32_t ThreadPid{ 1 };
+        constexpr uint32_t ThreadTid{ 2 };
+        constexpr uint32_t ThreadName{ 5 };
+
+        constexpr uint32_t Sequence{ 1 };
+    }
+}
+
+Trace *Trace::Instance() {
+    static Trace trace;
+    return &trace;
+}
+
+int64_t Trace::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::WriteJsonString(std::ostream &out, const char *text) {
+    out << '"';
+    for(const char *c = text; *c; ++c) {
+        switch(*c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(*c) < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(*c) << std::dec;
+                } else {
+                    out << *c;
+                }
+        }
+    }
+    out << '"';
+}
+
+Trace::Trace() {
+    mGpu = Register("GPU");
+}
+
+void Trace::Start() {
+    mStarted = Now();
+    ++mSession;
+    mCapturing = true;
+    LOGI << "[Trace] Capture started";
+}
+
+void Trace::Stop() {
+    mCapturing = false;
+    LOGI << "[Trace] Capture stopped";
+}
+
+bool Trace::Capturing() const {
+    return mCapturing.load(std::memory_order_relaxed);
+}
+
+void Trace::SetThreadName(const char *name) {
+    Local()->name = name;
+}
+
+void Trace::Record(const char *category, const char *name, int64_t begin, int64_t end) {
+    if(Capturing()) {
+        Append(*Local(), { category, name, begin, end });
+    }
+}
+
+void Trace::RecordGpu(const char *name, int64_t begin, int64_t end) {
+    if(Capturing()) {
+        Append(*mGpu, { "gpu", name, begin, end });
+    }
+}
+
+Trace::Buffer::~Buffer() {
+    for(Block *block = head.next.load(); nullptr != block;) {
+        Block *next{ block->next.load() };
+        delete block;
+        block = next;
+    }
+}
+
+Trace::Buffer *Trace::Register(const char *name) {
+    std::lock_guard<std::mutex> lock{ mRegistryLock };
+    auto buffer{ std::make_unique<Buffer>() };
+    buffer->track = static_cast<uint32_t>(mBuffers.size());
+    buffer->name = name;
+    mBuffers.push_back(std::move(buffer));
+    return mBuffers.back().get();
+}
+
+Trace::Buffer *Trace::Local() {
+    if(nullptr == tBuffer) {
+        tBuffer = Register(nullptr);
+    }
+    return static_cast<Buffer *>(tBuffer);
+}
+
+void Trace::Append(Buffer &buffer, const Event &event) {
+    // a new session: the owner rewinds its own buffer, keeping the blocks
+    if(const uint64_t session{ mSession.load(std::memory_order_relaxed) }; buffer.session != session) {
+        buffer.session = session;
+        buffer.tail = &buffer.head;
+        buffer.dropped = 0;
+        buffer.count.store(0, std::memory_order_release);
+    }
+    const size_t count{ buffer.count.load(std::memory_order_relaxed) };
+    if(count >= MaxEventsPerThread) {
+        ++buffer.dropped;
+        return;
+    }
+    const size_t slot{ count % BlockEvents };
+    if(0 == slot && 0 != count) {
+        Block *next{ buffer.tail->next.load(std::memory_order_relaxed) };
+        if(nullptr == next) {
+            next = new Block;
+            buffer.tail->next.store(next, std::memory_order_release);
+        }
+        buffer.tail = next;
+    }
+    buffer.tail->events[slot] = event;
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+std::vector<std::pair<const Trace::Buffer *, std::vector<Trace::Event>>> Trace::Snapshot() const {
+    std::vector<std::pair<const Buffer *, std::vector<Event>>> tracks;
+    const int64_t started{ mStarted.load() };
+    std::lock_guard<std::mutex> lock{ mRegistryLock };
+    for(const auto &buffer : mBuffers) {
+        const size_t count{ buffer->count.load(std::memory_order_acquire) };
+        std::vector<Event> events;
+        events.reserve(count);
+        const Block *block{ &buffer->head };
+        for(size_t i = 0; i < count; ++i) {
+            if(0 == i % BlockEvents && 0 != i) {
+                block = block->next.load(std::memory_order_acquire);
+            }
+            const Event &event{ block->events[i % BlockEvents] };
+            // skip what a thread recorded in an older session before rewinding
+            if(event.begin >= started) {
+                events.push_back(event);
+            }
+        }
+        if(!events.empty()) {
+            tracks.emplace_back(buffer.get(), std::move(events));
+        }
+    }
+    return tracks;
+}
+
+//================================= SAVE ====================================//
+
+bool Trace::Save(const std::string &path, Format format) const {
+    std::ofstream out{ path, std::ios::binary };
+    if(!out) {
+        LOGE << "[Trace] Cannot open '" << path << "'";
+        return false;
+    }
+    const bool saved{ Format::ChromeJson == format ? SaveJson(out) : SavePerfetto(out) };
+    if(saved) {
+        LOGI << "[Trace] Saved '" << path << "'";
+    }
+    return saved;
+}
+
+bool Trace::SaveJson(std::ostream &out) const {
+    const auto tracks{ Snapshot() };
+    const int64_t origin{ mStarted.load() };
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first{ true };
+    auto separator = [&] {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+    out << std::fixed << std::setprecision(3);
+    for(const auto &[buffer, events] : tracks) {
+        separator();
+        std::string name{ nullptr != buffer->name ? buffer->name : "Thread " + std::to_string(buffer->track) };
+        out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << kPid << ",\"tid\":" << buffer->track << ",\"args\":{\"name\":";
+        WriteJsonString(out, name.c_str());
+        out << "}}";
+        for(const auto &event : events) {
+            separator();
+            out << "{\"ph\":\"X\",\"pid\":" << kPid << ",\"tid\":" << buffer->track << ",\"cat\":";
+            WriteJsonString(out, event.category);
+            out << ",\"name\":";
+            WriteJsonString(out, event.name);
+            out << ",\"ts\":" << (event.begin - origin) * 1e-3 << ",\"dur\":" << (event.end - event.begin) * 1e-3 << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+bool Trace::SavePerfetto(std::ostream &out) const {
+    const auto tracks{ Snapshot() };
+    auto packet = [&out](const Proto &body) {
+        Proto trace;
+        trace.Message(pb::TracePacket, body);
+        out.write(trace.Bytes().data(), static_cast<std::streamsize>(trace.Bytes().size()));
+    };
+
+    for(const auto &[buffer, events] : tracks) {
+        const uint64_t uuid{ kTrackBase + buffer->track };
+        std::string name{ nullptr != buffer->name ? buffer->name : "Thread " + std::to_string(buffer->track) };
+
+        Proto descriptor;
+        descriptor.Varint(pb::TrackUuid, uuid);
+        if(buffer == mGpu) {
+            descriptor.String(pb::TrackName, name);
+        } else {
+            Proto thread;
+            thread.Varint(pb::ThreadPid, kPid);
+            thread.Varint(pb::ThreadTid, buffer->track + 1);
+            thread.String(pb::ThreadName, name);
+            descriptor.Message(pb::TrackThread, thread);
+        }
+        Proto header;
+        header.Message(pb::TrackDescriptor, descriptor);
+        header.Varint(pb::SequenceId, pb::Sequence);
+        packet(header);
+
+        std::vector<const Event *> order;
+        order.reserve(events.size());
+        for(const auto &event : events) {
+            order.push_back(&event);
+        }
+        // slices on one track must nest: begins in time order (outer first),
+        // each preceded by the ends that happen no later than it
+        std::stable_sort(order.begin(), order.end(), [](const Event *a, const Event *b) {
+            return a->begin != b->begin ? a->begin < b->begin : a->end > b->end;
+        });
+        std::vector<int64_t> open;
+        auto closeUntil = [&](int64_t time) {
+            while(!open.empty() && open.back() <= time) {
+                Proto event;
+                event.Varint(pb::EventType, pb::SliceEnd);
+                event.Varint(pb::EventTrack, uuid);
+                Proto body;
+                body.Varint(pb::Timestamp, static_cast<uint64_t>(open.back()));
+                body.Message(pb::TrackEvent, event);
+                body.Varint(pb::SequenceId, pb::Sequence);
+                packet(body);
+                open.pop_back();
+            }
+        };
+        for(const Event *slice : order) {
+            closeUntil(slice->begin);
+            Proto event;
+            event.Varint(pb::EventType, pb::SliceBegin);
+            event.Varint(pb::EventTrack, uuid);
+            event.String(pb::EventCategories, slice->category);
+            event.String(pb::EventName, slice->name);
+            Proto body;
+            body.Varint(pb::Timestamp, static_cast<uint64_t>(slice->begin));
+            body.Message(pb::TrackEvent, event);
+            body.Varint(pb::SequenceId, pb::Sequence);
+            packet(body);
+            // clamp into the parent so a GPU/CPU clock wobble cannot break nesting
+            open.push_back(open.empty() ? slice->end : std::min(slice->end, open.back()));
+        }
+        closeUntil(std::numeric_limits<int64_t>::max());
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,115 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Session trace recorder.
+ * Every thread appends complete events to its own buffer: a chain of fixed
+ * blocks written by the owner only and published with a release store of
+ * the event count, so recording takes no locks (a thread registers itself
+ * once, under a mutex, on its first event). GPU events have a buffer of
+ * their own, written by the GL thread.
+ *
+ * Save may run while capturing and sees everything published so far;
+ * Start clears the buffers lazily, each owner resetting its own on its next
+ * event, so it should not overlap a Save. Names must be string literals.
+ */
+class Trace {
+public:
+    enum class Format {
+        ChromeJson,   ///< chrome://tracing, ui.perfetto.dev, Speedscope
+        Perfetto,     ///< protobuf TracePacket stream for ui.perfetto.dev / trace_processor
+    };
+
+    struct Event {
+        const char *category;
+        const char *name;
+        int64_t begin;   ///< ns, Trace::Now clock
+        int64_t end;
+    };
+
+    static constexpr size_t BlockEvents{ 4096 };
+    static constexpr size_t MaxEventsPerThread{ 1 << 20 };
+
+    static Trace *Instance();
+    static int64_t Now();
+    /// Writes text as a quoted, escaped JSON string.
+    static void WriteJsonString(std::ostream &out, const char *text);
+
+    void Start();
+    void Stop();
+    bool Capturing() const;
+
+    /// Names the calling thread's track.
+    void SetThreadName(const char *name);
+
+    void Record(const char *category, const char *name, int64_t begin, int64_t end);
+    void RecordGpu(const char *name, int64_t begin, int64_t end);
+
+    bool Save(const std::string &path, Format format) const;
+
+private:
+    struct Block {
+        Event events[BlockEvents];
+        std::atomic<Block *> next{ nullptr };
+    };
+    struct Buffer {
+        uint32_t track{ 0 };
+        const char *name{ nullptr };
+        uint64_t session{ 0 };             ///< owner only
+        Block head;
+        Block *tail{ &head };              ///< owner only
+        std::atomic<size_t> count{ 0 };    ///< published events
+        size_t dropped{ 0 };               ///< owner only
+
+        ~Buffer();
+    };
+
+    std::atomic<bool> mCapturing{ false };
+    std::atomic<uint64_t> mSession{ 0 };
+    std::atomic<int64_t> mStarted{ 0 };
+
+    mutable std::mutex mRegistryLock;
+    std::vector<std::unique_ptr<Buffer>> mBuffers;   ///< never shrinks: blocks stay valid for readers
+    Buffer *mGpu{ nullptr };
+
+    Trace();
+
+    Buffer *Register(const char *name);
+    Buffer *Local();
+    void Append(Buffer &buffer, const Event &event);
+    std::vector<std::pair<const Buffer *, std::vector<Event>>> Snapshot() const;
+
+    bool SaveJson(std::ostream &out) const;
+    bool SavePerfetto(std::ostream &out) const;
+};
+
+class TraceScope {
+public:
+    TraceScope(const char *category, const char *name)
+        : mCategory{ category }, mName{ name }, mBegin{ Trace::Instance()->Capturing() ? Trace::Now() : -1 }
+    {}
+    ~TraceScope() {
+        if(mBegin >= 0) {
+            Trace::Instance()->Record(mCategory, mName, mBegin, Trace::Now());
+        }
+    }
+
+private:
+    const char *mCategory;
+    const char *mName;
+    int64_t mBegin;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope, __LINE__){ category, name }
+
+#endif // __TRACE_H__
@@ -0,0 +1,79 @@
+#include "incs.hpp"
+
+#include "commandbuffer.hpp"
+
+void CommandBuffer::Reset() {
+    // clear() keeps the capacity, so steady-state recording does not allocate
+    mCommands.clear();
+    mVectors.clear();
+    mMatrices.clear();
+    mObjects.clear();
+}
+
+bool CommandBuffer::Empty() const {
+    return mCommands.empty();
+}
+
+size_t CommandBuffer::Size() const {
+    return mCommands.size();
+}
+
+void CommandBuffer::BindShader(Shader *shader) {
+    Push(CommandType::BindShader).shader = shader;
+}
+
+void CommandBuffer::BindTexture(Texture *texture, uint32_t unit) {
+    auto &command{ Push(CommandType::BindTexture) };
+    command.texture = texture;
+    command.payload = unit;
+}
+
+void CommandBuffer::Set(const char *name, float value) {
+    Push(CommandType::SetFloat, name).f = value;
+}
+
+void CommandBuffer::Set(const char *name, int value) {
+    Push(CommandType::SetInt, name).i = value;
+}
+
+void CommandBuffer::Set(const char *name, const glm::vec4 &value) {
+    Push(CommandType::SetVec4, name).payload = static_cast<uint32_t>(mVectors.size());
+    mVectors.push_back(value);
+}
+
+void CommandBuffer::Set(const char *name, const glm::mat4 &value) {
+    Push(CommandType::SetMat4, name).payload = static_cast<uint32_t>(mMatrices.size());
+    mMatrices.push_back(value);
+}
+
+void CommandBuffer::SetObject(const ObjectBlock &block) {
+    Push(CommandType::SetObject).payload = static_cast<uint32_t>(mObjects.size());
+    mObjects.push_back(block);
+}
+
+void CommandBuffer::Draw(Mash *mash) {
+    Push(CommandType::DrawMesh).mash = mash;
+}
+
+const std::vector<CommandBuffer::Command> &CommandBuffer::Commands() const {
+    return mCommands;
+}
+
+const glm::vec4 &CommandBuffer::Vec4(uint32_t payload) const {
+    return mVectors[payload];
+}
+
+const glm::mat4 &CommandBuffer::Mat4(uint32_t payload) const {
+    return mMatrices[payload];
+}
+
+const std::vector<ObjectBlock> &CommandBuffer::Objects() const {
+    return mObjects;
+}
+
+CommandBuffer::Command &CommandBuffer::Push(CommandType type, const char *name) {
+    Command command{};
+    command.type = type;
+    command.name = name;
+    return mCommands.emplace_back(command);
+}
@@ -0,0 +1,77 @@
+#ifndef __COMMANDBUFFER_H__
+#define __COMMANDBUFFER_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "uniformblocks.hpp"
+
+class Shader;
+class Texture;
+class Mash;
+
+enum class CommandType : uint8_t {
+    BindShader,
+    BindTexture,
+    SetFloat,
+    SetInt,
+    SetVec4,
+    SetMat4,
+    SetObject,
+    DrawMesh,
+};
+
+/**
+ * Backend-neutral list of render commands.
+ * Recording makes no GL calls, so any thread may fill its own buffer; a
+ * render backend replays the buffers later on the thread owning the context.
+ * Uniform names are kept by pointer and must outlive the buffer (literals).
+ * Per-object values go in an ObjectBlock instead: the backend uploads a
+ * buffer's blocks in one go and binds each with a buffer range.
+ */
+class CommandBuffer {
+public:
+    struct Command {
+        CommandType type;
+        uint32_t payload;   ///< index into the vec4/mat4/object pools, texture unit
+        const char *name;
+        union {
+            Shader *shader;
+            Texture *texture;
+            Mash *mash;
+            float f;
+            int i;
+        };
+    };
+
+    static constexpr uint32_t OwnUnit{ UINT32_MAX };
+
+    void Reset();
+    bool Empty() const;
+    size_t Size() const;
+
+    void BindShader(Shader *shader);
+    /// Binds to the texture's own unit, or to unit when given.
+    void BindTexture(Texture *texture, uint32_t unit = OwnUnit);
+    void Set(const char *name, float value);
+    void Set(const char *name, int value);
+    void Set(const char *name, const glm::vec4 &value);
+    void Set(const char *name, const glm::mat4 &value);
+    void SetObject(const ObjectBlock &block);
+    void Draw(Mash *mash);
+
+    const std::vector<Command> &Commands() const;
+    const glm::vec4 &Vec4(uint32_t payload) const;
+    const glm::mat4 &Mat4(uint32_t payload) const;
+    const std::vector<ObjectBlock> &Objects() const;
+
+private:
+    std::vector<Command> mCommands;
+    std::vector<glm::vec4> mVectors;
+    std::vector<glm::mat4> mMatrices;
+    std::vector<ObjectBlock> mObjects;
+
+    Command &Push(CommandType type, const char *name = nullptr);
+};
+
+#endif // __COMMANDBUFFER_H__
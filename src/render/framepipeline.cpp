@@ -0,0 +1,122 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+
+#include "framepipeline.hpp"
+
+//=============================== UI SNAPSHOT ===============================//
+
+UiSnapshot::~UiSnapshot() {
+    Release();
+}
+
+void UiSnapshot::Capture(const ImDrawData *source) {
+    Release();
+    if(nullptr == source || !source->Valid) {
+        return;
+    }
+    mData = *source;
+    mLists.reserve(source->CmdListsCount);
+    for(int i = 0; i < source->CmdListsCount; ++i) {
+        mLists.push_back(source->CmdLists[i]->CloneOutput());
+    }
+    mData.CmdLists = mLists.data();
+}
+
+void UiSnapshot::Release() {
+    for(auto *list : mLists) {
+        IM_DELETE(list);
+    }
+    mLists.clear();
+    mData = ImDrawData{};
+}
+
+ImDrawData *UiSnapshot::Data() {
+    return mData.Valid ? &mData : nullptr;
+}
+
+//============================== FRAME PIPELINE =============================//
+
+FramePipeline::FramePipeline(Stage prepare, Stage simulate, Stage submit, size_t depth)
+    : mPrepare{ std::move(prepare) }, mSimulate{ std::move(simulate) }, mSubmit{ std::move(submit) },
+      mDepth{ std::max<size_t>(1, depth) }
+{
+    for(size_t i = 0; i < mDepth; ++i) {
+        mFrames.push_back(std::make_unique<FrameData>());
+    }
+}
+
+FramePipeline::~FramePipeline() {
+    // the running job refers to this object and to whatever the stages capture
+    if(mBusy) {
+        JobSystem::Instance()->Wait(mRunning);
+    }
+}
+
+void FramePipeline::SetDepth(size_t depth) {
+    mDepth = std::max<size_t>(1, depth);
+}
+
+size_t FramePipeline::Depth() const {
+    return mDepth;
+}
+
+void FramePipeline::Frame() {
+    // prepare touches the same input/UI state as simulate: never overlap them
+    Retire();
+
+    const bool resizing{ mDepth != mFrames.size() };
+    if(resizing && mSimulated == mSubmitted) {
+        LOGI << "[FramePipeline] Depth " << mFrames.size() << " -> " << mDepth;
+        mFrames.resize(mDepth);
+        for(auto &frame : mFrames) {
+            if(nullptr == frame) {
+                frame = std::make_unique<FrameData>();
+            }
+        }
+    } else if(resizing) {
+        SubmitOldest();
+        return;
+    }
+
+    FrameData &next{ Slot(mSimulated) };
+    next.index = mSimulated;
+    mPrepare(next);
+    mBusy = true;
+    JobSystem::Instance()->Run([this, &next] { mSimulate(next); }, &mRunning);
+
+    // submit once the pipeline is full; with depth 1 that waits for the
+    // frame just started, with depth 2 it overlaps it with the previous one
+    if(mSimulated + 1 - mSubmitted >= mFrames.size()) {
+        SubmitOldest();
+    }
+}
+
+void FramePipeline::Flush() {
+    Retire();
+    while(mSubmitted < mSimulated) {
+        SubmitOldest();
+    }
+}
+
+FrameData &FramePipeline::Slot(uint64_t frame) {
+    return *mFrames[frame % mFrames.size()];
+}
+
+void FramePipeline::Retire() {
+    if(!mBusy) {
+        return;
+    }
+    JobSystem::Instance()->Wait(mRunning);
+    mBusy = false;
+    ++mSimulated;
+}
+
+void FramePipeline::SubmitOldest() {
+    if(mSubmitted == mSimulated) {
+        Retire();
+    }
+    if(mSubmitted < mSimulated) {
+        mSubmit(Slot(mSubmitted));
+        ++mSubmitted;
+    }
+}
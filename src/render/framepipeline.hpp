@@ -0,0 +1,81 @@
+#ifndef __FRAMEPIPELINE_H__
+#define __FRAMEPIPELINE_H__
+
+#include <cstdint>
+#include <functional>
+
+#include "commandbuffer.hpp"
+#include "jobsystem.hpp"
+
+/// Deep copy of ImGui's draw data, so a frame can be rendered after ImGui
+/// has already moved on to building the next one.
+class UiSnapshot {
+public:
+    UiSnapshot() = default;
+    UiSnapshot(const UiSnapshot &) = delete;
+    UiSnapshot &operator=(const UiSnapshot &) = delete;
+    ~UiSnapshot();
+
+    void Capture(const ImDrawData *source);
+    void Release();
+    ImDrawData *Data();
+
+private:
+    ImDrawData mData{};
+    std::vector<ImDrawList *> mLists;
+};
+
+/// Everything the render thread needs to submit one frame.
+struct FrameData {
+    uint64_t index{ 0 };
+    glm::vec4 clearColor{ 0.0f };
+    FrameBlock uniforms;
+    std::vector<CommandBuffer> commands;
+    UiSnapshot ui;
+};
+
+/**
+ * Overlaps simulation of frame N+1 with GL submission of frame N.
+ *  - prepare runs on the calling thread before a frame's simulation starts
+ *    (event polling and platform input: GLFW must stay on the main thread);
+ *  - simulate runs on a job worker and fills the frame's FrameData;
+ *  - submit runs on the calling thread and turns FrameData into GL calls.
+ * Depth is the number of FrameData slots, i.e. how many frames may be in
+ * flight between simulation and submission; depth 1 runs strictly in order.
+ * Only one simulation runs at a time since ImGui has a single context.
+ */
+class FramePipeline {
+public:
+    using Stage = std::function<void(FrameData &)>;
+
+    FramePipeline(Stage prepare, Stage simulate, Stage submit, size_t depth = 2);
+    ~FramePipeline();
+
+    /// Takes effect once the frames already in flight are submitted.
+    void SetDepth(size_t depth);
+    size_t Depth() const;
+
+    /// Starts simulating the next frame and submits the oldest one once all
+    /// slots are in use (may only submit while a depth change drains).
+    void Frame();
+    /// Submits every frame still in flight.
+    void Flush();
+
+private:
+    Stage mPrepare;
+    Stage mSimulate;
+    Stage mSubmit;
+
+    std::vector<std::unique_ptr<FrameData>> mFrames;
+    size_t mDepth;
+    JobSystem::Counter mRunning;
+    bool mBusy{ false };
+    uint64_t mSimulated{ 0 };
+    uint64_t mSubmitted{ 0 };
+
+    FrameData &Slot(uint64_t frame);
+    void Retire();
+    void SubmitOldest();
+};
+
+#endif // __FRAMEPIPELINE_H__
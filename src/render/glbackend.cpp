@@ -0,0 +1,123 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+
+#include "glbackend.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "mash.hpp"
+
+void GLBackend::Begin(const FrameBlock &frame) {
+    mShader = nullptr;
+    mMash = nullptr;
+    mVao = 0;
+    std::fill(std::begin(mTextures), std::end(mTextures), nullptr);
+    mStats = {};
+    mFrame.BeginFrame();
+    mObjects.BeginFrame();
+    mFrame.Bind(mFrame.Upload(&frame, 1));
+    mStats.calls += 3;
+}
+
+void GLBackend::Execute(const CommandBuffer &buffer) {
+    const auto &objects{ buffer.Objects() };
+    const size_t base{ mObjects.Upload(objects.data(), objects.size()) };
+    mStats.calls += objects.empty() ? 0 : 2;
+    for(const auto &command : buffer.Commands()) {
+        ++mStats.commands;
+        switch(command.type) {
+            case CommandType::BindShader:
+                if(mShader == command.shader) {
+                    ++mStats.redundant;
+                    break;
+                }
+                mShader = command.shader;
+                mShader->Use();
+                ++mStats.calls;
+                break;
+            case CommandType::BindTexture: {
+                const size_t unit{ CommandBuffer::OwnUnit == command.payload
+                    ? command.texture->position() - GL_TEXTURE0 : command.payload };
+                if(unit < MaxTextureUnits && mTextures[unit] == command.texture) {
+                    ++mStats.redundant;
+                    break;
+                }
+                if(unit < MaxTextureUnits) {
+                    mTextures[unit] = command.texture;
+                }
+                command.texture->BindTo(static_cast<GLenum>(GL_TEXTURE0 + unit));
+                mStats.calls += 2;
+                break;
+            }
+            case CommandType::SetFloat:
+                mShader->Set(command.name, command.f);
+                ++mStats.calls;
+                break;
+            case CommandType::SetInt:
+                mShader->Set(command.name, command.i);
+                ++mStats.calls;
+                break;
+            case CommandType::SetVec4:
+                mShader->Set(command.name, buffer.Vec4(command.payload));
+                ++mStats.calls;
+                break;
+            case CommandType::SetMat4:
+                mShader->Set(command.name, buffer.Mat4(command.payload));
+                ++mStats.calls;
+                break;
+            case CommandType::SetObject:
+                mObjects.Bind(base + command.payload);
+                ++mStats.calls;
+                break;
+            case CommandType::DrawMesh:
+                if(mMash == command.mash) {
+                    ++mStats.redundant;
+                } else {
+                    mMash = command.mash;
+                    // meshes of one format share a VAO and only swap buffers
+                    if(mVao != mMash->Vao()) {
+                        mVao = mMash->Vao();
+                        glBindVertexArray(mVao);
+                        ++mStats.calls;
+                    } else {
+                        ++mStats.redundant;
+                    }
+                    if(mMash->SharesVao()) {
+                        mMash->BindBuffers();
+                        mStats.calls += 2;
+                    }
+                }
+                mMash->Draw();
+                ++mStats.draws;
+                ++mStats.calls;
+                break;
+        }
+    }
+}
+
+void GLBackend::End() {
+    mObjects.EndFrame();
+    mFrame.EndFrame();
+    mStats.calls += 2;
+    if(0 != mVao) {
+        glBindVertexArray(0);
+        ++mStats.calls;
+    }
+    for(auto *texture : mTextures) {
+        if(nullptr != texture) {
+            texture->Unbind();
+            mStats.calls += 2;
+        }
+    }
+    if(nullptr != mShader) {
+        mShader->UnUse();
+        ++mStats.calls;
+    }
+    mShader = nullptr;
+    mMash = nullptr;
+    mVao = 0;
+    std::fill(std::begin(mTextures), std::end(mTextures), nullptr);
+}
+
+const GLBackend::Stats &GLBackend::GetStats() const {
+    return mStats;
+}
@@ -0,0 +1,44 @@
+#ifndef __GLBACKEND_H__
+#define __GLBACKEND_H__
+
+#include "commandbuffer.hpp"
+#include "uniformring.hpp"
+
+/**
+ * Replays CommandBuffers into OpenGL. Must only be used on the thread that
+ * owns the GL context. Tracks bound program, vertex array, mesh and
+ * textures and drops bindings that would not change anything.
+ *
+ * Begin uploads and binds the frame's FrameBlock, shared by every program;
+ * Execute uploads a buffer's ObjectBlocks with one call and SetObject binds
+ * one of them, so uniform traffic is a few buffer writes per frame instead
+ * of a glUniform call per uniform and object.
+ */
+class GLBackend {
+public:
+    struct Stats {
+        size_t commands{ 0 };
+        size_t draws{ 0 };
+        size_t redundant{ 0 };   ///< bindings skipped because already current
+        size_t calls{ 0 };       ///< GL entry points called
+    };
+
+    void Begin(const FrameBlock &frame = {});
+    void Execute(const CommandBuffer &buffer);
+    void End();
+
+    const Stats &GetStats() const;
+
+private:
+    static constexpr size_t MaxTextureUnits{ 32 };
+
+    Shader *mShader{ nullptr };
+    Mash *mMash{ nullptr };
+    GLuint mVao{ 0 };
+    Texture *mTextures[MaxTextureUnits]{};
+    UniformRing mFrame{ FrameBlock::Binding, sizeof(FrameBlock), 1 };
+    UniformRing mObjects{ ObjectBlock::Binding, sizeof(ObjectBlock) };
+    Stats mStats;
+};
+
+#endif // __GLBACKEND_H__
@@ -0,0 +1,20 @@
+#include "incs.hpp"
+#include <atomic>
+
+#include "gpustats.hpp"
+
+namespace {
+    std::atomic<size_t> sUploaded{ 0 };
+}
+
+void GpuStats::AddUpload(size_t bytes) {
+    sUploaded.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+size_t GpuStats::Uploaded() {
+    return sUploaded.load(std::memory_order_relaxed);
+}
+
+void GpuStats::Reset() {
+    sUploaded.store(0, std::memory_order_relaxed);
+}
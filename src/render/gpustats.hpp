@@ -0,0 +1,13 @@
+#ifndef __GPUSTATS_H__
+#define __GPUSTATS_H__
+
+#include <cstddef>
+
+/// Process-wide counters of data handed to the driver; safe from any thread.
+namespace GpuStats {
+    void AddUpload(size_t bytes);
+    size_t Uploaded();
+    void Reset();
+}
+
+#endif // __GPUSTATS_H__
@@ -0,0 +1,103 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#include <cstring>
+
+#include "uniformring.hpp"
+#include "gpustats.hpp"
+
+namespace {
+    /// the fence is an optimisation, glBufferSubData stays correct without
+    /// it: past this the driver orders the write itself
+    constexpr GLuint64 kFenceTimeout{ 100'000'000 };
+}
+
+UniformRing::UniformRing(GLuint binding, size_t blockSize, size_t capacity)
+    : mBinding{ binding }, mBlockSize{ blockSize }, mCapacity{ std::max<size_t>(capacity, 1) }
+{}
+
+UniformRing::~UniformRing() {
+    DropFences();
+    if(0 != mBuffer) {
+        glDeleteBuffers(1, &mBuffer);
+    }
+}
+
+void UniformRing::BeginFrame() {
+    if(0 == mBuffer) {
+        GLint alignment{ 0 };
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        const size_t align{ static_cast<size_t>(std::max(alignment, 1)) };
+        mStride = (mBlockSize + align - 1) / align * align;
+        glGenBuffers(1, &mBuffer);
+        Allocate(mCapacity);
+    }
+    mSegment = (mSegment + 1) % Segments;
+    mUsed = 0;
+    if(GLsync fence{ mFences[mSegment] }) {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout);
+        glDeleteSync(fence);
+        mFences[mSegment] = nullptr;
+    }
+}
+
+size_t UniformRing::Upload(const void *blocks, size_t count) {
+    if(0 == count) {
+        return mUsed;
+    }
+    if(mUsed + count > mCapacity) {
+        // blocks bound earlier this frame were drawn from the old storage,
+        // which the driver keeps until the GPU is done with it
+        Allocate(std::max(mCapacity * 2, mUsed + count));
+    }
+    const auto *source{ static_cast<const uint8_t *>(blocks) };
+    mStaging.resize(count * mStride);
+    for(size_t i = 0; i < count; ++i) {
+        std::memcpy(mStaging.data() + i * mStride, source + i * mBlockSize, mBlockSize);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, Offset(mUsed), static_cast<GLsizeiptr>(mStaging.size()), mStaging.data());
+    GpuStats::AddUpload(mStaging.size());
+
+    const size_t first{ mUsed };
+    mUsed += count;
+    return first;
+}
+
+void UniformRing::Bind(size_t slot) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, mBinding, mBuffer, Offset(slot), static_cast<GLsizeiptr>(mBlockSize));
+}
+
+void UniformRing::EndFrame() {
+    if(0 != mBuffer) {
+        mFences[mSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+size_t UniformRing::Capacity() const {
+    return mCapacity;
+}
+
+void UniformRing::Allocate(size_t capacity) {
+    if(capacity != mCapacity) {
+        LOGD << "[UniformRing] Binding " << mBinding << " grows to " << capacity << " blocks per frame";
+    }
+    mCapacity = capacity;
+    // new storage: nothing in flight reads it, the fences of the old one go
+    DropFences();
+    glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(Segments * mCapacity * mStride), nullptr, GL_DYNAMIC_DRAW);
+}
+
+void UniformRing::DropFences() {
+    for(GLsync &fence : mFences) {
+        if(nullptr != fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+}
+
+GLintptr UniformRing::Offset(size_t slot) const {
+    return static_cast<GLintptr>((mSegment * mCapacity + slot) * mStride);
+}
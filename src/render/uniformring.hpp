@@ -0,0 +1,56 @@
+#ifndef __UNIFORMRING_H__
+#define __UNIFORMRING_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Uniform buffer of fixed-size std140 blocks, written once per frame and
+ * bound block by block with glBindBufferRange. The buffer holds one segment
+ * per frame in flight; a frame fills the next segment with one
+ * glBufferSubData per Upload, at offsets rounded up to
+ * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, and a fence per segment keeps it from
+ * rewriting blocks the GPU may still read. A frame that outgrows its segment
+ * reallocates the buffer at twice the size.
+ *
+ * GL thread only; the buffer is created by the first BeginFrame.
+ */
+class UniformRing {
+public:
+    UniformRing(GLuint binding, size_t blockSize, size_t capacity = 256);
+    ~UniformRing();
+
+    UniformRing(const UniformRing &) = delete;
+    UniformRing &operator=(const UniformRing &) = delete;
+
+    void BeginFrame();
+    /// Copies count tightly packed blocks into the frame's segment and
+    /// returns the slot of the first; slots count from the frame's start.
+    size_t Upload(const void *blocks, size_t count);
+    /// Binds an uploaded block to the ring's binding point.
+    void Bind(size_t slot) const;
+    void EndFrame();
+
+    /// Blocks a frame may upload before the buffer grows.
+    size_t Capacity() const;
+
+private:
+    static constexpr size_t Segments{ 3 };
+
+    const GLuint mBinding;
+    const size_t mBlockSize;
+    size_t mStride{ 0 };            ///< block size rounded up to the offset alignment
+    size_t mCapacity;
+    GLuint mBuffer{ 0 };
+    size_t mSegment{ 0 };
+    size_t mUsed{ 0 };              ///< slots uploaded this frame
+    GLsync mFences[Segments]{};
+    std::vector<uint8_t> mStaging;
+
+    void Allocate(size_t capacity);
+    void DropFences();
+    GLintptr Offset(size_t slot) const;
+};
+
+#endif // __UNIFORMRING_H__
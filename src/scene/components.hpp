@@ -0,0 +1,25 @@
+#ifndef __COMPONENTS_H__
+#define __COMPONENTS_H__
+
+#include "transform.hpp"
+
+class Mash;
+class Texture;
+
+// Components are plain data: resources are referenced, never owned, so the
+// objects behind these pointers must outlive the entities using them.
+
+struct TransformComponent {
+    TransformHierarchy::Node node;
+};
+
+struct MeshComponent {
+    Mash *mash;
+};
+
+struct TextureComponent {
+    Texture *texture;
+    int unit;   ///< sampler index in the shader (sample_<unit>)
+};
+
+#endif // __COMPONENTS_H__
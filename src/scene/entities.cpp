@@ -0,0 +1,192 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <mutex>
+
+#include "entities.hpp"
+
+namespace {
+    std::mutex &typesMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    std::vector<size_t> &typeSizes() {
+        static std::vector<size_t> sizes;
+        return sizes;
+    }
+}
+
+//============================== COMPONENT TYPES ==============================//
+
+EntityRegistry::TypeId EntityRegistry::Register(size_t size) {
+    std::lock_guard<std::mutex> lock{ typesMutex() };
+    auto &sizes{ typeSizes() };
+    if(sizes.size() >= MaxComponents) {
+        LOGF << "[Entities] Too many component types, the limit is " << MaxComponents;
+        std::abort();
+    }
+    sizes.push_back(size);
+    return static_cast<TypeId>(sizes.size() - 1);
+}
+
+size_t EntityRegistry::SizeOf(TypeId type) {
+    std::lock_guard<std::mutex> lock{ typesMutex() };
+    return typeSizes()[type];
+}
+
+//================================ ARCHETYPES ================================//
+
+size_t EntityRegistry::Archetype::Column(TypeId type) const {
+    // types are sorted, so the column is the number of lower type bits set
+    const Signature lower{ signature & ((Signature{ 1 } << type) - 1) };
+    size_t column{ 0 };
+    for(Signature bits = lower; bits != 0; bits &= bits - 1) {
+        ++column;
+    }
+    return column;
+}
+
+uint8_t *EntityRegistry::Archetype::Row(size_t column, size_t row) {
+    return columns[column].data() + row * sizes[column];
+}
+
+uint32_t EntityRegistry::FindOrCreate(Signature signature) {
+    if(auto it{ mLookup.find(signature) }; it != mLookup.end()) {
+        return it->second;
+    }
+    Archetype archetype;
+    archetype.signature = signature;
+    for(TypeId type = 0; type < MaxComponents; ++type) {
+        if(0 != (signature & (Signature{ 1 } << type))) {
+            archetype.types.push_back(type);
+            archetype.sizes.push_back(SizeOf(type));
+            archetype.rowBytes += archetype.sizes.back();
+        }
+    }
+    archetype.columns.resize(archetype.types.size());
+
+    const auto index{ static_cast<uint32_t>(mArchetypes.size()) };
+    mArchetypes.push_back(std::move(archetype));
+    mLookup.emplace(signature, index);
+    return index;
+}
+
+std::vector<EntityRegistry::Chunk> EntityRegistry::CollectChunks(Signature mask) {
+    std::vector<Chunk> chunks;
+    for(auto &archetype : mArchetypes) {
+        if((archetype.signature & mask) != mask) {
+            continue;
+        }
+        const size_t rows{ archetype.entities.size() };
+        const size_t step{ std::max<size_t>(1, ChunkBytes / std::max<size_t>(1, archetype.rowBytes)) };
+        for(size_t begin = 0; begin < rows; begin += step) {
+            chunks.push_back({ &archetype, begin, std::min(begin + step, rows) });
+        }
+    }
+    return chunks;
+}
+
+//================================= ENTITIES =================================//
+
+Entity EntityRegistry::Create() {
+    uint32_t index{};
+    if(!mFreeList.empty()) {
+        index = mFreeList.back();
+        mFreeList.pop_back();
+    } else {
+        index = static_cast<uint32_t>(mLocations.size());
+        mLocations.push_back({ 0, 0, 0, false });
+    }
+    auto &location{ mLocations[index] };
+    const Entity entity{ index, location.generation };
+    const uint32_t empty{ FindOrCreate(0) };
+    auto &archetype{ mArchetypes[empty] };
+    location.archetype = empty;
+    location.row = static_cast<uint32_t>(archetype.entities.size());
+    location.alive = true;
+    archetype.entities.push_back(entity);
+    ++mAlive;
+    return entity;
+}
+
+void EntityRegistry::Destroy(Entity entity) {
+    if(!Alive(entity)) {
+        return;
+    }
+    auto &location{ mLocations[entity.index] };
+    RemoveRow(location.archetype, location.row);
+    location.alive = false;
+    ++location.generation;
+    mFreeList.push_back(entity.index);
+    --mAlive;
+}
+
+bool EntityRegistry::Alive(Entity entity) const {
+    return entity.index < mLocations.size()
+        && mLocations[entity.index].alive
+        && mLocations[entity.index].generation == entity.generation;
+}
+
+size_t EntityRegistry::Size() const {
+    return mAlive;
+}
+
+void EntityRegistry::Reserve(size_t entities) {
+    mLocations.reserve(entities);
+}
+
+uint8_t *EntityRegistry::Component(Entity entity, TypeId type) {
+    if(!Alive(entity)) {
+        return nullptr;
+    }
+    const auto &location{ mLocations[entity.index] };
+    auto &archetype{ mArchetypes[location.archetype] };
+    if(0 == (archetype.signature & (Signature{ 1 } << type))) {
+        return nullptr;
+    }
+    return archetype.Row(archetype.Column(type), location.row);
+}
+
+void EntityRegistry::Move(Entity entity, Signature signature) {
+    const uint32_t target{ FindOrCreate(signature) };
+    auto &location{ mLocations[entity.index] };
+    if(target == location.archetype) {
+        return;
+    }
+    auto &from{ mArchetypes[location.archetype] };
+    auto &to{ mArchetypes[target] };
+
+    const auto row{ static_cast<uint32_t>(to.entities.size()) };
+    to.entities.push_back(entity);
+    for(size_t column = 0; column < to.types.size(); ++column) {
+        const TypeId type{ to.types[column] };
+        const size_t size{ to.sizes[column] };
+        auto &data{ to.columns[column] };
+        data.resize(data.size() + size);
+        if(0 != (from.signature & (Signature{ 1 } << type))) {
+            std::memcpy(data.data() + row * size, from.Row(from.Column(type), location.row), size);
+        }
+    }
+    RemoveRow(location.archetype, location.row);
+    location.archetype = target;
+    location.row = row;
+}
+
+void EntityRegistry::RemoveRow(uint32_t index, uint32_t row) {
+    // swap with the last row so the arrays stay dense
+    auto &archetype{ mArchetypes[index] };
+    const auto last{ static_cast<uint32_t>(archetype.entities.size() - 1) };
+    for(size_t column = 0; column < archetype.types.size(); ++column) {
+        const size_t size{ archetype.sizes[column] };
+        auto &data{ archetype.columns[column] };
+        if(row != last) {
+            std::memcpy(data.data() + row * size, data.data() + last * size, size);
+        }
+        data.resize(data.size() - size);
+    }
+    if(row != last) {
+        const Entity moved{ archetype.entities[last] };
+        archetype.entities[row] = moved;
+        mLocations[moved.index].row = row;
+    }
+    archetype.entities.pop_back();
+}
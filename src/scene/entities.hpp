@@ -0,0 +1,228 @@
+#ifndef __ENTITIES_H__
+#define __ENTITIES_H__
+
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+#include "jobsystem.hpp"
+
+struct Entity {
+    uint32_t index;
+    uint32_t generation;
+
+    bool operator==(const Entity &other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const Entity &other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * Archetype-based entity storage.
+ * Entities with the same set of components share an archetype, which keeps
+ * one dense array per component type. Iteration walks those arrays linearly,
+ * so a system touches only the components it asks for. Components must be
+ * trivially copyable: rows are moved between archetypes with memcpy.
+ *
+ * Structural changes (Create/Destroy/Add/Remove) invalidate component
+ * pointers and must not happen inside Each/ParallelEach.
+ */
+class EntityRegistry {
+public:
+    using TypeId = uint32_t;
+    using Signature = uint64_t;
+    static constexpr size_t MaxComponents{ 64 };
+    static constexpr size_t ChunkBytes{ 16 * 1024 };   ///< ParallelEach work item size
+
+    EntityRegistry() = default;
+    EntityRegistry(const EntityRegistry &) = delete;
+    EntityRegistry &operator=(const EntityRegistry &) = delete;
+
+    template<class C>
+    static TypeId Type() {
+        static_assert(std::is_trivially_copyable_v<C>, "Components must be trivially copyable");
+        static const TypeId id{ Register(sizeof(C)) };
+        return id;
+    }
+
+    template<class... Cs>
+    static Signature SignatureOf() {
+        return (Signature{ 0 } | ... | (Signature{ 1 } << Type<Cs>()));
+    }
+
+    Entity Create();
+    template<class... Cs>
+    Entity Create(const Cs &...components);
+    void Destroy(Entity entity);
+    bool Alive(Entity entity) const;
+    size_t Size() const;
+    void Reserve(size_t entities);
+
+    template<class C>
+    void Add(Entity entity, const C &component);
+    template<class C>
+    void Remove(Entity entity);
+    template<class C>
+    bool Has(Entity entity) const;
+    template<class C>
+    C *Get(Entity entity);
+
+    /// fn(Cs &...) or fn(Entity, Cs &...) for every entity having all of Cs.
+    template<class... Cs, class Fn>
+    void Each(Fn &&fn);
+
+    /// Same as Each, but chunks of rows run in parallel; fn must be thread safe.
+    template<class... Cs, class Fn>
+    void ParallelEach(Fn &&fn);
+
+    /// Number of chunks ParallelChunks<Cs...> will visit.
+    template<class... Cs>
+    size_t Chunks();
+
+    /// Like ParallelEach, calling fn(chunk, Entity, Cs &...); chunk is a stable
+    /// index in [0, Chunks<Cs...>()) so callers can keep per-chunk output in order.
+    template<class... Cs, class Fn>
+    void ParallelChunks(Fn &&fn);
+
+private:
+    struct Archetype {
+        Signature signature{ 0 };
+        std::vector<TypeId> types;
+        std::vector<size_t> sizes;                   ///< component size per entry in types
+        std::vector<std::vector<uint8_t>> columns;   ///< one dense array per entry in types
+        std::vector<Entity> entities;
+        size_t rowBytes{ 0 };
+
+        size_t Column(TypeId type) const;
+        uint8_t *Row(size_t column, size_t row);
+    };
+    struct Chunk {
+        Archetype *archetype;
+        size_t begin;
+        size_t end;
+    };
+    struct Location {
+        uint32_t archetype;
+        uint32_t row;
+        uint32_t generation;
+        bool alive;
+    };
+
+    std::vector<Location> mLocations;
+    std::vector<uint32_t> mFreeList;
+    std::vector<Archetype> mArchetypes;
+    std::unordered_map<Signature, uint32_t> mLookup;
+    size_t mAlive{ 0 };
+
+    static TypeId Register(size_t size);
+    static size_t SizeOf(TypeId type);
+
+    uint32_t FindOrCreate(Signature signature);
+    uint8_t *Component(Entity entity, TypeId type);
+    void Move(Entity entity, Signature signature);
+    void RemoveRow(uint32_t archetype, uint32_t row);
+
+    std::vector<Chunk> CollectChunks(Signature mask);
+
+    template<class... Cs, class Fn>
+    static void Visit(Archetype &archetype, size_t begin, size_t end, Fn &fn);
+};
+
+//================================ TEMPLATES ================================//
+
+template<class... Cs>
+Entity EntityRegistry::Create(const Cs &...components) {
+    const Entity entity{ Create() };
+    Move(entity, SignatureOf<Cs...>());
+    ((std::memcpy(Component(entity, Type<Cs>()), &components, sizeof(Cs))), ...);
+    return entity;
+}
+
+template<class C>
+void EntityRegistry::Add(Entity entity, const C &component) {
+    if(!Alive(entity)) {
+        return;
+    }
+    const auto &location{ mLocations[entity.index] };
+    Move(entity, mArchetypes[location.archetype].signature | SignatureOf<C>());
+    std::memcpy(Component(entity, Type<C>()), &component, sizeof(C));
+}
+
+template<class C>
+void EntityRegistry::Remove(Entity entity) {
+    if(!Has<C>(entity)) {
+        return;
+    }
+    const auto &location{ mLocations[entity.index] };
+    Move(entity, mArchetypes[location.archetype].signature & ~SignatureOf<C>());
+}
+
+template<class C>
+bool EntityRegistry::Has(Entity entity) const {
+    if(!Alive(entity)) {
+        return false;
+    }
+    const auto &location{ mLocations[entity.index] };
+    return 0 != (mArchetypes[location.archetype].signature & SignatureOf<C>());
+}
+
+template<class C>
+C *EntityRegistry::Get(Entity entity) {
+    return reinterpret_cast<C *>(Component(entity, Type<C>()));
+}
+
+template<class... Cs, class Fn>
+void EntityRegistry::Visit(Archetype &archetype, size_t begin, size_t end, Fn &fn) {
+    auto columns{ std::make_tuple(reinterpret_cast<Cs *>(archetype.columns[archetype.Column(Type<Cs>())].data())...) };
+    for(size_t row = begin; row < end; ++row) {
+        if constexpr(std::is_invocable_v<Fn &, Entity, Cs &...>) {
+            fn(archetype.entities[row], std::get<Cs *>(columns)[row]...);
+        } else {
+            fn(std::get<Cs *>(columns)[row]...);
+        }
+    }
+}
+
+template<class... Cs, class Fn>
+void EntityRegistry::Each(Fn &&fn) {
+    const Signature mask{ SignatureOf<Cs...>() };
+    for(auto &archetype : mArchetypes) {
+        if((archetype.signature & mask) == mask && !archetype.entities.empty()) {
+            Visit<Cs...>(archetype, 0, archetype.entities.size(), fn);
+        }
+    }
+}
+
+template<class... Cs, class Fn>
+void EntityRegistry::ParallelEach(Fn &&fn) {
+    const auto chunks{ CollectChunks(SignatureOf<Cs...>()) };
+    JobSystem::Instance()->ParallelFor(0, chunks.size(), 1, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) {
+            Visit<Cs...>(*chunks[i].archetype, chunks[i].begin, chunks[i].end, fn);
+        }
+    });
+}
+
+template<class... Cs>
+size_t EntityRegistry::Chunks() {
+    return CollectChunks(SignatureOf<Cs...>()).size();
+}
+
+template<class... Cs, class Fn>
+void EntityRegistry::ParallelChunks(Fn &&fn) {
+    const auto chunks{ CollectChunks(SignatureOf<Cs...>()) };
+    JobSystem::Instance()->ParallelFor(0, chunks.size(), 1, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) {
+            auto visit = [&fn, i](Entity entity, Cs &...components) {
+                fn(i, entity, components...);
+            };
+            Visit<Cs...>(*chunks[i].archetype, chunks[i].begin, chunks[i].end, visit);
+        }
+    });
+}
+
+#endif // __ENTITIES_H__
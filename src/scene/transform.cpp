@@ -0,0 +1,192 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+
+#include "transform.hpp"
+#include "jobsystem.hpp"
+#include "batchmath.hpp"
+
+namespace {
+    constexpr size_t kParallelGrain{ 1024 };
+    /// dirty nodes gathered per BatchMath call, small enough for a job's stack
+    constexpr size_t kBatch{ 32 };
+}
+
+TransformHierarchy::TransformHierarchy(size_t reserve) {
+    mPositions.reserve(reserve);
+    mRotations.reserve(reserve);
+    mScales.reserve(reserve);
+    mParents.reserve(reserve);
+    mDepths.reserve(reserve);
+    mDirty.reserve(reserve);
+    mWorlds.reserve(reserve);
+}
+
+TransformHierarchy::Node TransformHierarchy::Create(Node parent) {
+    if(InvalidNode != parent && parent >= Size()) {
+        LOGE << "[Transform] Incorrect parent node: " << parent;
+        parent = InvalidNode;
+    }
+    const Node node{ static_cast<Node>(Size()) };
+    mPositions.emplace_back(0.0f);
+    mRotations.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+    mScales.emplace_back(1.0f);
+    mParents.push_back(parent);
+    mDepths.push_back(InvalidNode == parent ? 0 : mDepths[parent] + 1);
+    mDirty.push_back(1);
+    mWorlds.emplace_back(1.0f);
+
+    mOrderDirty = true;
+    mAnyDirty = true;
+    return node;
+}
+
+void TransformHierarchy::Clear() {
+    mPositions.clear();
+    mRotations.clear();
+    mScales.clear();
+    mParents.clear();
+    mDepths.clear();
+    mDirty.clear();
+    mWorlds.clear();
+    mOrder.clear();
+    mLevels.clear();
+    mOrderDirty = false;
+    mAnyDirty = false;
+}
+
+size_t TransformHierarchy::Size() const {
+    return mParents.size();
+}
+
+void TransformHierarchy::SetPosition(Node node, const glm::vec3 &position) {
+    mPositions[node] = position;
+    MarkDirty(node);
+}
+
+void TransformHierarchy::SetRotation(Node node, const glm::quat &rotation) {
+    mRotations[node] = rotation;
+    MarkDirty(node);
+}
+
+void TransformHierarchy::SetScale(Node node, const glm::vec3 &scale) {
+    mScales[node] = scale;
+    MarkDirty(node);
+}
+
+const glm::vec3 &TransformHierarchy::Position(Node node) const {
+    return mPositions[node];
+}
+
+const glm::quat &TransformHierarchy::Rotation(Node node) const {
+    return mRotations[node];
+}
+
+const glm::vec3 &TransformHierarchy::Scale(Node node) const {
+    return mScales[node];
+}
+
+const glm::mat4 &TransformHierarchy::World(Node node) const {
+    return mWorlds[node];
+}
+
+TransformHierarchy::Node TransformHierarchy::Parent(Node node) const {
+    return mParents[node];
+}
+
+uint32_t TransformHierarchy::Depth(Node node) const {
+    return mDepths[node];
+}
+
+void TransformHierarchy::Update() {
+    if(!mAnyDirty) {
+        return;
+    }
+    if(mOrderDirty) {
+        RebuildOrder();
+    }
+    // Levels must go strictly one after another: a node reads its parent's
+    // world matrix and dirty flag, both written while updating the previous level.
+    for(size_t level = 0; level + 1 < mLevels.size(); ++level) {
+        JobSystem::Instance()->ParallelFor(mLevels[level], mLevels[level + 1], kParallelGrain, [this](size_t begin, size_t end) {
+            UpdateLevel(begin, end);
+        });
+    }
+    std::fill(mDirty.begin(), mDirty.end(), 0);
+    mAnyDirty = false;
+}
+
+void TransformHierarchy::MarkDirty(Node node) {
+    mDirty[node] = 1;
+    mAnyDirty = true;
+}
+
+void TransformHierarchy::RebuildOrder() {
+    // counting sort by depth keeps the order stable and costs O(n)
+    uint32_t maxDepth{ 0 };
+    for(const auto depth : mDepths) {
+        maxDepth = std::max(maxDepth, depth);
+    }
+    mLevels.assign(maxDepth + 2, 0);
+    for(const auto depth : mDepths) {
+        ++mLevels[depth + 1];
+    }
+    for(size_t level = 1; level < mLevels.size(); ++level) {
+        mLevels[level] += mLevels[level - 1];
+    }
+    mOrder.resize(Size());
+    std::vector<size_t> cursor(mLevels.begin(), mLevels.end() - 1);
+    for(Node node = 0; node < Size(); ++node) {
+        mOrder[cursor[mDepths[node]]++] = node;
+    }
+    mOrderDirty = false;
+}
+
+void TransformHierarchy::UpdateLevel(size_t begin, size_t end) {
+    // Dirty nodes are gathered and composed kBatch at a time. A level has
+    // one depth, so either every node in it has a parent or none has.
+    Node nodes[kBatch];
+    glm::vec3 positions[kBatch];
+    glm::quat rotations[kBatch];
+    glm::vec3 scales[kBatch];
+    glm::mat4 locals[kBatch];
+    glm::mat4 parents[kBatch];
+    glm::mat4 worlds[kBatch];
+    size_t count{ 0 };
+
+    const auto flush = [&] {
+        BatchMath::ComposeTRS(positions, rotations, scales, locals, count);
+        const glm::mat4 *result{ locals };
+        if(InvalidNode != mParents[nodes[0]]) {
+            for(size_t i = 0; i < count; ++i) {
+                parents[i] = mWorlds[mParents[nodes[i]]];
+            }
+            BatchMath::Multiply(parents, locals, worlds, count);
+            result = worlds;
+        }
+        for(size_t i = 0; i < count; ++i) {
+            mWorlds[nodes[i]] = result[i];
+            mDirty[nodes[i]] = 1;
+        }
+        count = 0;
+    };
+
+    for(size_t i = begin; i < end; ++i) {
+        const Node node{ mOrder[i] };
+        const Node parent{ mParents[node] };
+        const bool parentDirty{ InvalidNode != parent && 0 != mDirty[parent] };
+        if(0 == mDirty[node] && !parentDirty) {
+            continue;
+        }
+        nodes[count] = node;
+        positions[count] = mPositions[node];
+        rotations[count] = mRotations[node];
+        scales[count] = mScales[node];
+        if(++count == kBatch) {
+            flush();
+        }
+    }
+    if(count > 0) {
+        flush();
+    }
+}
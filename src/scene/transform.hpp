@@ -0,0 +1,56 @@
+#ifndef __TRANSFORM_H__
+#define __TRANSFORM_H__
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Transform hierarchy with local TRS stored as structure-of-arrays.
+ * World matrices are recomputed only for dirty subtrees, level by level
+ * (nodes are processed in hierarchy-depth order, each level in parallel),
+ * through the BatchMath kernels, which round exactly like glm.
+ */
+class TransformHierarchy {
+public:
+    using Node = uint32_t;
+    static constexpr Node InvalidNode{ std::numeric_limits<Node>::max() };
+
+    explicit TransformHierarchy(size_t reserve = 0);
+
+    Node Create(Node parent = InvalidNode);
+    void Clear();
+    size_t Size() const;
+
+    void SetPosition(Node node, const glm::vec3 &position);
+    void SetRotation(Node node, const glm::quat &rotation);
+    void SetScale(Node node, const glm::vec3 &scale);
+
+    const glm::vec3 &Position(Node node) const;
+    const glm::quat &Rotation(Node node) const;
+    const glm::vec3 &Scale(Node node) const;
+    const glm::mat4 &World(Node node) const;
+    Node Parent(Node node) const;
+    uint32_t Depth(Node node) const;
+
+    void Update();
+
+private:
+    std::vector<glm::vec3> mPositions;
+    std::vector<glm::quat> mRotations;
+    std::vector<glm::vec3> mScales;
+    std::vector<Node> mParents;
+    std::vector<uint32_t> mDepths;
+    std::vector<uint8_t> mDirty;
+    std::vector<glm::mat4> mWorlds;
+
+    std::vector<Node> mOrder;         ///< nodes sorted by depth
+    std::vector<size_t> mLevels;      ///< offsets of each depth level in mOrder
+    bool mOrderDirty{ false };
+    bool mAnyDirty{ false };
+
+    void MarkDirty(Node node);
+    void RebuildOrder();
+    void UpdateLevel(size_t begin, size_t end);
+};
+
+#endif // __TRANSFORM_H__
@@ -0,0 +1,42 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <filesystem>
+#include <mutex>
+#include <set>
+
+#include "embeddedshaders.hpp"
+
+namespace {
+    // generated by tools/shaderpack, see "Shaders" in CMakeLists.txt
+#include "embeddedshaders.inc"
+
+    std::mutex gLock;
+    std::set<std::string> gInvalid;
+
+    std::string normal(const std::string &path) {
+        return std::filesystem::path{ path }.lexically_normal().generic_string();
+    }
+}
+
+const EmbeddedShaders::Entry *EmbeddedShaders::Find(const std::string &path) {
+    const std::string key{ normal(path) };
+    {
+        std::lock_guard<std::mutex> lock{ gLock };
+        if(gInvalid.count(key)) {
+            return nullptr;
+        }
+    }
+    for(const auto &entry : kShaders) {
+        if(key == entry.path) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void EmbeddedShaders::Invalidate(const std::string &path) {
+    std::lock_guard<std::mutex> lock{ gLock };
+    if(gInvalid.insert(normal(path)).second) {
+        LOGD << "[EmbeddedShaders] '" << path << "' changed on disk, the built-in copy is no longer used";
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef __EMBEDDEDSHADERS_H__
+#define __EMBEDDEDSHADERS_H__
+
+#include <string>
+#include <string_view>
+
+/**
+ * Shader sources compiled into the executable. The build preprocesses the
+ * files listed in CMakeLists.txt (see ShaderSource) with tools/shaderpack
+ * into a generated table, so Shader finds them without touching the disk.
+ * Paths are the ones the sources are created with, e.g.
+ * "resources/shaders/vs.glsl".
+ *
+ * Hot reload invalidates a path once its file changes on disk: later
+ * shaders built from it, e.g. new variants, read the file instead.
+ */
+namespace EmbeddedShaders {
+    struct Entry {
+        const char *path;
+        std::string_view source;        ///< preprocessed
+        std::string_view includes;      ///< files it includes, one per line
+    };
+
+    /// Null when the path is not embedded or was invalidated. Thread safe.
+    const Entry *Find(const std::string &path);
+    void Invalidate(const std::string &path);
+}
+
+#endif // __EMBEDDEDSHADERS_H__
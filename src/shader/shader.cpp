@@ -1,31 +1,147 @@
 #include "incs.hpp"
 #include "plog/Log.h"
+#include <atomic>
 
 #include "shader.hpp"
+#include "embeddedshaders.hpp"
+#include "shadersource.hpp"
+#include "trace.hpp"
+#include "uniformblocks.hpp"
+#include "binarylog.hpp"
 
 namespace {
-    void printSource(std::string src) {
-        if(src.back() == '\n') {
-            src.pop_back();
+    void printSource(std::string_view src) {
+        if(!src.empty() && src.back() == '\n') {
+            src.remove_suffix(1);
         }
 
         size_t line = 0;
-        std::string strline;
-        for(const char c : src) {
-            if('\n' == c) {
-                LOGD << "[Shader] " << std::setw(4) << ++line << " | " << strline;
-                strline.clear();
+        for(size_t begin = 0; begin <= src.size();) {
+            size_t end{ src.find('\n', begin) };
+            end = std::string_view::npos == end ? src.size() : end;
+            LOGD << "[Shader] " << std::setw(4) << ++line << " | " << std::string{ src.substr(begin, end - begin) };
+            begin = end + 1;
+        }
+    }
+
+    bool parallelCompile() {
+        static const bool supported{ [] {
+            if(GLEW_KHR_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+                return true;
+            }
+            if(GLEW_ARB_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+                return true;
+            }
+            return false;
+        }() };
+        return supported;
+    }
+
+    /// Copies the values of the plain (non-array) uniforms the two programs
+    /// share from one to the other, e.g. the sampler units set at startup.
+    /// Leaves no program bound.
+    void copyUniforms(GLuint from, GLuint to) {
+        GLint count{ 0 };
+        glGetProgramiv(to, GL_ACTIVE_UNIFORMS, &count);
+        glUseProgram(to);
+        for(GLint i = 0; i < count; ++i) {
+            char name[256];
+            GLsizei length{ 0 };
+            GLint size{ 0 };
+            GLenum type{ 0 };
+            glGetActiveUniform(to, i, sizeof(name), &length, &size, &type, name);
+            const GLint source{ glGetUniformLocation(from, name) };
+            const GLint target{ glGetUniformLocation(to, name) };
+            if(size != 1 || source < 0 || target < 0) {
                 continue;
             }
-            strline += c;
+            GLfloat f[16];
+            GLint n[4];
+            switch(type) {
+                case GL_FLOAT:
+                    glGetUniformfv(from, source, f);
+                    glUniform1f(target, f[0]);
+                    break;
+                case GL_FLOAT_VEC4:
+                    glGetUniformfv(from, source, f);
+                    glUniform4fv(target, 1, f);
+                    break;
+                case GL_FLOAT_MAT4:
+                    glGetUniformfv(from, source, f);
+                    glUniformMatrix4fv(target, 1, GL_FALSE, f);
+                    break;
+                case GL_INT:
+                case GL_BOOL:
+                case GL_SAMPLER_2D:
+                case GL_SAMPLER_CUBE:
+                    glGetUniformiv(from, source, n);
+                    glUniform1i(target, n[0]);
+                    break;
+                default:
+                    LOGW << "[Shader] Uniform '" << name << "' is not copied between programs";
+                    break;
+            }
         }
-        LOGD << "[Shader] " << std::setw(4) << ++line << " | " << strline;
+        glUseProgram(0);
+    }
+
+    std::atomic<uint64_t> gPrograms{ 0 };
+
+    /// Points the shared uniform blocks the linked program declares at their
+    /// binding points; the backend binds the buffers there.
+    void bindBlocks(GLuint program) {
+        const std::pair<const char *, GLuint> blocks[]{
+            { FrameBlock::Name, FrameBlock::Binding },
+            { ObjectBlock::Name, ObjectBlock::Binding },
+        };
+        for(const auto &[name, binding] : blocks) {
+            const GLuint index{ glGetUniformBlockIndex(program, name) };
+            if(GL_INVALID_INDEX != index) {
+                glUniformBlockBinding(program, index, binding);
+            }
+        }
+    }
+
+    /// source with "#define <define>" lines added after its #version line
+    std::string injectDefines(const std::string &source, const Shader::Defines &defines) {
+        std::string block;
+        for(const auto &define : defines) {
+            block += "#define " + define + "\n";
+        }
+        const size_t version{ source.find("#version") };
+        const size_t lineEnd{ std::string::npos == version ? std::string::npos : source.find('\n', version) };
+        std::string result{ source };
+        if(std::string::npos == version) {
+            result.insert(0, block);
+        } else if(std::string::npos == lineEnd) {
+            result += "\n" + block;
+        } else {
+            result.insert(lineEnd + 1, block);
+        }
+        return result;
     }
 }
 
 Shader::Shader(const std::string &vShader, const std::string &fShader)
-    : prog{ glCreateProgram() }, lastError{ nullptr }
+    : Shader{ vShader, fShader, Defines{} }
+{}
+
+Shader::Shader(const std::string &vShader, const std::string &fShader, Defines shaderDefines, bool deferred, Setup onBuild)
+    : prog{ 0 }, lastError{ nullptr }, vPath{ vShader }, fPath{ fShader }
+    , defines{ std::move(shaderDefines) }, setup{ std::move(onBuild) }
 {
+    if(!deferred) {
+        build();
+    }
+}
+
+void Shader::build() {
+    TRACE_SCOPE("shader", "Shader::Shader");
+    prog = glCreateProgram();
+    const std::string &vShader{ vPath };
+    const std::string &fShader{ fPath };
     if(vShader.empty() || fShader.empty()) {
         lastError.reset(new ShaderError{"The pathes to shaders is empty.", -1});
         return;
@@ -42,7 +158,7 @@ Shader::Shader(const std::string &vShader, const std::string &fShader)
     }
     GLuint fragment = generateShader(GL_FRAGMENT_SHADER, fShader);
     if(hasError(fragment, GL_COMPILE_STATUS)) {
-        onError(vertex);
+        onError(fragment);
     }
 
     glAttachShader(prog, vertex);
@@ -50,10 +166,22 @@ Shader::Shader(const std::string &vShader, const std::string &fShader)
     glLinkProgram(prog);
     if(hasError(prog, GL_LINK_STATUS)) {
         onError(prog, GL_PROGRAM);
+    } else {
+        bindBlocks(prog);
+        reflect();
+    }
+    // the program keeps the binaries, the shader objects are not needed
+    glDetachShader(prog, vertex);
+    glDetachShader(prog, fragment);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    if(setup) {
+        setup(*this);
     }
 }
 
 Shader::~Shader() {
+    dropRebuild();
     glDeleteProgram(prog);
 }
 
@@ -65,17 +193,14 @@ std::shared_ptr<ShaderError> Shader::GetLastError() const {
     return lastError;
 }
 
+const Shader::Reflection &Shader::GetReflection() const {
+    return reflection;
+}
+
 int Shader::Location(const std::string &property, PropertyType type) const {
-    GLint loc{ -1 };
-    switch(type) {
-        case PropertyType::UNIFORM:
-            loc = glGetUniformLocation(prog, property.c_str());
-            break;
-        case PropertyType::ATTRIBUTE:
-            loc = glGetAttribLocation(prog, property.c_str());
-            break;
-    }
-    return loc;
+    const auto &variables{ PropertyType::UNIFORM == type ? reflection.uniforms : reflection.attributes };
+    const auto it{ variables.find(property) };
+    return variables.end() != it ? it->second.location : -1;
 }
 
 void Shader::Set(const std::string &property, float value) {
@@ -90,11 +215,18 @@ void Shader::Set(const std::string &property, bool value) {
     glUniform1i(this->Location(property), static_cast<int>(value));
 }
 
+void Shader::Set(const std::string &property, const glm::vec4 &value) {
+    glUniform4fv(this->Location(property), 1, glm::value_ptr(value));
+}
+
 void Shader::Set(const std::string &property, const glm::mat4 &value) {
     glUniformMatrix4fv(this->Location(property), 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void Shader::Use() {
+    if(0 == prog) {
+        build();
+    }
     glUseProgram(prog);
 }
 
@@ -102,32 +234,164 @@ void Shader::UnUse() {
     glUseProgram(0);
 }
 
+const std::string &Shader::VertexPath() const {
+    return vPath;
+}
+
+const std::string &Shader::FragmentPath() const {
+    return fPath;
+}
+
+const Shader::Defines &Shader::GetDefines() const {
+    return defines;
+}
+
+void Shader::CopyUniforms(const Shader &from) {
+    copyUniforms(from.prog, prog);
+}
+
+void Shader::reflect() {
+    Reflection result;
+    result.id = ++gPrograms;
+    char name[256];
+    GLint count{ 0 };
+    glGetProgramiv(prog, GL_ACTIVE_ATTRIBUTES, &count);
+    for(GLint i = 0; i < count; ++i) {
+        GLsizei length{ 0 };
+        Reflection::Variable variable{ -1, 0, 0 };
+        glGetActiveAttrib(prog, i, sizeof(name), &length, &variable.size, &variable.type, name);
+        variable.location = glGetAttribLocation(prog, name);
+        result.attributes[std::string{ name, static_cast<size_t>(length) }] = variable;
+    }
+    glGetProgramiv(prog, GL_ACTIVE_UNIFORMS, &count);
+    for(GLint i = 0; i < count; ++i) {
+        GLsizei length{ 0 };
+        Reflection::Variable variable{ -1, 0, 0 };
+        glGetActiveUniform(prog, i, sizeof(name), &length, &variable.size, &variable.type, name);
+        variable.location = glGetUniformLocation(prog, name);
+        std::string uniform{ name, static_cast<size_t>(length) };
+        constexpr std::string_view first{ "[0]" };
+        if(uniform.size() > first.size() && 0 == uniform.compare(uniform.size() - first.size(), first.size(), first)) {
+            result.uniforms[uniform.substr(0, uniform.size() - first.size())] = variable;
+        }
+        result.uniforms[std::move(uniform)] = variable;
+    }
+    BLOGD("[Shader] Program {}: {} attributes, {} uniforms", prog, result.attributes.size(), result.uniforms.size());
+    reflection = std::move(result);
+}
+
+void Shader::Rebuild(const std::string &vSource, const std::string &fSource) {
+    if(0 == prog) {
+        // deferred and not built yet: its first Use reads the new sources
+        return;
+    }
+    TRACE_SCOPE("shader", "Shader::Rebuild");
+    dropRebuild();
+    parallelCompile();
+    nextStages[0] = compileShader(GL_VERTEX_SHADER, vSource);
+    nextStages[1] = compileShader(GL_FRAGMENT_SHADER, fSource);
+    nextProg = glCreateProgram();
+    glAttachShader(nextProg, nextStages[0]);
+    glAttachShader(nextProg, nextStages[1]);
+    glLinkProgram(nextProg);
+}
+
+void Shader::FinishRebuild() {
+    if(0 == nextProg) {
+        return;
+    }
+    if(parallelCompile()) {
+        GLint done{ GL_FALSE };
+        glGetProgramiv(nextProg, GL_COMPLETION_STATUS_KHR, &done);
+        if(GL_TRUE != done) {
+            return;
+        }
+    }
+
+    TRACE_SCOPE("shader", "Shader::FinishRebuild");
+    std::string error;
+    for(const GLuint stage : nextStages) {
+        if(error.empty() && hasError(stage, GL_COMPILE_STATUS)) {
+            error = getError(stage, GL_SHADER);
+        }
+    }
+    if(error.empty() && hasError(nextProg, GL_LINK_STATUS)) {
+        error = getError(nextProg, GL_PROGRAM);
+    }
+    if(!error.empty()) {
+        LOGE << "[Shader] Reload of '" << vPath << "', '" << fPath << "' failed, keeping the current program: " << error;
+        dropRebuild();
+        return;
+    }
+
+    for(GLuint &stage : nextStages) {
+        glDetachShader(nextProg, stage);
+        glDeleteShader(stage);
+        stage = 0;
+    }
+    bindBlocks(nextProg);
+    copyUniforms(prog, nextProg);
+    glDeleteProgram(prog);
+    prog = nextProg;
+    nextProg = 0;
+    reflect();
+    lastError.reset();
+    LOGI << "[Shader] Reloaded '" << vPath << "', '" << fPath << "': program " << prog;
+}
+
+bool Shader::Rebuilding() const {
+    return 0 != nextProg;
+}
+
+void Shader::dropRebuild() {
+    for(GLuint &stage : nextStages) {
+        if(0 != stage) {
+            if(0 != nextProg) {
+                glDetachShader(nextProg, stage);
+            }
+            glDeleteShader(stage);
+            stage = 0;
+        }
+    }
+    if(0 != nextProg) {
+        glDeleteProgram(nextProg);
+        nextProg = 0;
+    }
+}
+
 GLuint Shader::generateShader(GLenum type, const std::string &fpath) const {
     auto source{ loadFormFile(fpath) };
     if(source.empty()) {
         return 0;
     }
-    LOGI << "[Shader] Load source from '" << fpath << "'";
-    printSource(source);
+    BLOGI("[Shader] Load source from '{}'{}", fpath, defines.empty() ? "" : " with defines");
+    const GLuint shader{ compileShader(type, source) };
+    BLOGI("[Shader] Generated shader: {}", shader);
+    return shader;
+}
+
+GLuint Shader::compileShader(GLenum type, const std::string &source) const {
+    const std::string text{ defines.empty() ? source : injectDefines(source, defines) };
+    // the listing is skipped outright unless debug records are wanted
+    IF_LOG(plog::debug) printSource(text);
     GLuint shader{ glCreateShader(type) };
-    const char *src{ source.c_str() };
+    const char *src{ text.c_str() };
     glShaderSource(shader, 1, &src, nullptr);
     glCompileShader(shader);
-    LOGI << "[Shader] Generated shader: " << shader;
     return shader;
 }
 
-std::string Shader::loadFormFile(const std::string &fname) const try {
-    std::ifstream file;
-    file.exceptions(std::ios_base::badbit | std::ios_base::failbit);
-    file.open(fname);
-    std::stringstream strstream;
-    strstream << file.rdbuf();
-    return strstream.str();
-} catch (std::fstream::failure &fail) {
-    LOGE << "[Shader] Cannot load '" << fname << "' file: " << fail.what();
-    lastError.reset(new ShaderError{fail.what(), fail.code().value()});
-    return "";
+std::string Shader::loadFormFile(const std::string &fname) const {
+    if(const auto *embedded{ EmbeddedShaders::Find(fname) }) {
+        return std::string{ embedded->source };
+    }
+    std::string source, error;
+    if(!ShaderSource::Read(fname, source, error)) {
+        LOGE << "[Shader] Cannot load '" << fname << "' file: " << error;
+        lastError.reset(new ShaderError{error, static_cast<int>(std::io_errc::stream)});
+        return "";
+    }
+    return source;
 }
 
 bool Shader::hasError(GLuint target, GLenum what) const {
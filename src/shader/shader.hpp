@@ -1,7 +1,12 @@
 #ifndef __SHADER_H__
 #define __SHADER_H__
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 struct ShaderError {
     using Ref = std::shared_ptr<ShaderError>;
@@ -12,30 +17,83 @@ struct ShaderError {
 class Shader {
 public:
     using Ref = std::shared_ptr<Shader>;
+    /// "NAME" or "NAME value", each becomes a #define after the #version line.
+    using Defines = std::vector<std::string>;
+    using Setup = std::function<void(Shader &)>;
 
     Shader(const std::string &vShader, const std::string &fShader);
+    /// A deferred shader makes no GL calls here, so it may be created on any
+    /// thread; its first Use builds it on the GL thread and then runs setup.
+    Shader(const std::string &vShader, const std::string &fShader, Defines shaderDefines,
+           bool deferred = false, Setup onBuild = {});
     virtual ~Shader();
 
+    /// Active inputs of the linked program, queried once per link.
+    struct Reflection {
+        struct Variable {
+            GLint location;     ///< -1 for uniform block members
+            GLenum type;
+            GLint size;         ///< array length, 1 otherwise
+        };
+        uint64_t id{ 0 };       ///< unique per linked program; GL reuses program names
+        std::unordered_map<std::string, Variable> attributes;
+        std::unordered_map<std::string, Variable> uniforms;     ///< arrays as "name" and "name[0]"
+    };
+
     bool Valide() const;
     ShaderError::Ref GetLastError() const;
+    /// Empty until the program is built.
+    const Reflection &GetReflection() const;
 
     enum class PropertyType { UNIFORM, ATTRIBUTE };
+    /// From the reflection, no driver query; -1 when the program has no such input.
     int Location(const std::string &property, PropertyType type = PropertyType::UNIFORM) const;
 
     void Set(const std::string &property, float value);
     void Set(const std::string &property, int value);
     void Set(const std::string &property, bool value);
+    void Set(const std::string &property, const glm::vec4 &value);
     void Set(const std::string &property, const glm::mat4 &value);
 
     void Use();
     void UnUse();
 
+    const std::string &VertexPath() const;
+    const std::string &FragmentPath() const;
+    const Defines &GetDefines() const;
+    /// Takes the values of the plain uniforms both programs have (GL thread).
+    void CopyUniforms(const Shader &from);
+
+    /**
+     * Hot reload, GL thread only. Rebuild starts compiling and linking a new
+     * program next to the current one (replacing a rebuild still in flight);
+     * with GL_KHR_parallel_shader_compile the driver does it on its threads.
+     * FinishRebuild, called once per frame, returns at once while the driver
+     * is busy; when the program is ready it takes over with the current
+     * uniform values and the old one is deleted. A program that fails is
+     * logged and dropped, the current one stays.
+     */
+    void Rebuild(const std::string &vSource, const std::string &fSource);
+    void FinishRebuild();
+    bool Rebuilding() const;
+
 protected:
     GLuint prog;
     mutable ShaderError::Ref lastError;
+    std::string vPath;
+    std::string fPath;
+    const Defines defines;
+    const Setup setup;
+    GLuint nextProg{ 0 };
+    GLuint nextStages[2]{ 0, 0 };
+    Reflection reflection;
 
+    void build();
+    void reflect();
     GLuint generateShader(GLenum type, const std::string &fpath) const;
+    GLuint compileShader(GLenum type, const std::string &source) const;
     std::string loadFormFile(const std::string &fname) const;
+    void dropRebuild();
     bool hasError(GLuint target, GLenum what) const;
     std::string getError(GLuint target, GLenum type) const;
 };
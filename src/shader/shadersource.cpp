@@ -0,0 +1,138 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <filesystem>
+#include <set>
+
+#include "shadersource.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int kMaxDepth{ 16 };
+
+    bool readFile(const std::string &path, std::string &text, std::string &error) try {
+        std::ifstream file;
+        file.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+        file.open(path);
+        std::stringstream strstream;
+        strstream << file.rdbuf();
+        text = strstream.str();
+        return true;
+    } catch (std::fstream::failure &fail) {
+        error = "'" + path + "': " + fail.what();
+        return false;
+    }
+
+    /// The quoted name of an #include line, false for any other line.
+    bool includeName(std::string_view line, std::string_view &name, bool &valid) {
+        const auto skip = [&line] {
+            while(!line.empty() && (' ' == line.front() || '\t' == line.front())) {
+                line.remove_prefix(1);
+            }
+        };
+        skip();
+        if(line.empty() || '#' != line.front()) {
+            return false;
+        }
+        line.remove_prefix(1);
+        skip();
+        constexpr std::string_view directive{ "include" };
+        if(line.substr(0, directive.size()) != directive) {
+            return false;
+        }
+        line.remove_prefix(directive.size());
+        skip();
+        const size_t end{ line.size() > 1 && '"' == line.front() ? line.find('"', 1) : std::string_view::npos };
+        valid = std::string_view::npos != end;
+        name = valid ? line.substr(1, end - 1) : line;
+        return true;
+    }
+
+    bool expand(const std::string &path, std::set<std::string> &seen, std::string &out, std::string &error,
+                std::vector<std::string> *includes, int depth) {
+        std::string text;
+        if(!readFile(path, text, error)) {
+            return false;
+        }
+        const std::string stripped{ ShaderSource::StripComments(text) };
+        const std::string_view source{ stripped };
+        size_t lineNumber{ 0 };
+        for(size_t begin = 0; begin < source.size();) {
+            size_t end{ source.find('\n', begin) };
+            end = std::string_view::npos == end ? source.size() : end;
+            std::string_view line{ source.substr(begin, end - begin) };
+            while(!line.empty() && (' ' == line.back() || '\t' == line.back() || '\r' == line.back())) {
+                line.remove_suffix(1);
+            }
+            begin = end + 1;
+            ++lineNumber;
+
+            std::string_view name;
+            bool valid{ false };
+            if(!includeName(line, name, valid)) {
+                out.append(line);
+                out += '\n';
+                continue;
+            }
+            const std::string where{ "'" + path + "':" + std::to_string(lineNumber) + ": " };
+            if(!valid) {
+                error = where + "expected #include \"file\"";
+                return false;
+            }
+            if(depth >= kMaxDepth) {
+                error = where + "includes nest too deep";
+                return false;
+            }
+            const std::string target{ (fs::path{ path }.parent_path() / std::string{ name }).lexically_normal().generic_string() };
+            if(!seen.insert(target).second) {
+                out += '\n';
+                continue;
+            }
+            if(nullptr != includes) {
+                includes->push_back(target);
+            }
+            if(!expand(target, seen, out, error, includes, depth + 1)) {
+                error = where + error;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool ShaderSource::Read(const std::string &path, std::string &source, std::string &error, std::vector<std::string> *includes) {
+    std::set<std::string> seen{ fs::path{ path }.lexically_normal().generic_string() };
+    std::string out;
+    if(!expand(path, seen, out, error, includes, 0)) {
+        return false;
+    }
+    source = std::move(out);
+    return true;
+}
+
+std::string ShaderSource::StripComments(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    for(size_t i = 0; i < text.size(); ++i) {
+        const char next{ i + 1 < text.size() ? text[i + 1] : '\0' };
+        if('/' == text[i] && '/' == next) {
+            while(i < text.size() && '\n' != text[i]) {
+                ++i;
+            }
+            if(i < text.size()) {
+                out += '\n';
+            }
+        } else if('/' == text[i] && '*' == next) {
+            out += ' ';
+            for(i += 2; i < text.size() && !('*' == text[i] && i + 1 < text.size() && '/' == text[i + 1]); ++i) {
+                if('\n' == text[i]) {
+                    out += '\n';
+                }
+            }
+            ++i;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
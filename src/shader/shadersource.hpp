@@ -0,0 +1,25 @@
+#ifndef __SHADERSOURCE_H__
+#define __SHADERSOURCE_H__
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * GLSL preprocessing done before the driver sees a source: `#include "file"`
+ * (relative to the including file, each file at most once per source) and
+ * comment stripping. The build runs it through tools/shaderpack to embed
+ * resources/shaders (see EmbeddedShaders); hot reload runs it on the files.
+ */
+namespace ShaderSource {
+    /// Reads and preprocesses a file; false with the reason in error.
+    /// includes, when given, receives the included files, lexically normal.
+    bool Read(const std::string &path, std::string &source, std::string &error,
+              std::vector<std::string> *includes = nullptr);
+
+    /// Comments become a space; their line breaks stay, so compiler
+    /// messages keep the file's line numbers.
+    std::string StripComments(std::string_view text);
+}
+
+#endif // __SHADERSOURCE_H__
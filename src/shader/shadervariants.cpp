@@ -0,0 +1,65 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+
+#include "shadervariants.hpp"
+#include "shaderwatcher.hpp"
+
+ShaderVariants::ShaderVariants(const std::string &vShader, const std::string &fShader, std::vector<std::string> features)
+    : mVertexPath{ vShader }
+    , mFragmentPath{ fShader }
+    , mFeatures{ std::move(features) }
+    , mBase{ std::make_shared<Shader>(vShader, fShader) }
+{
+    if(mFeatures.size() > MaxFeatures) {
+        LOGE << "[ShaderVariants] " << mFeatures.size() << " features, only the first " << MaxFeatures << " are used";
+    }
+    mVariants[0] = mBase;
+    mTable[0].store(mBase.get(), std::memory_order_release);
+}
+
+const Shader::Ref &ShaderVariants::Base() const {
+    return mBase;
+}
+
+Shader *ShaderVariants::Get(uint32_t mask) {
+    mask &= (1u << std::min(mFeatures.size(), MaxFeatures)) - 1;
+    if(Shader *shader{ mTable[mask].load(std::memory_order_acquire) }) {
+        return shader;
+    }
+
+    std::lock_guard<std::mutex> lock{ mLock };
+    auto &variant{ mVariants[mask] };
+    if(nullptr != variant) {
+        return variant.get();
+    }
+    Shader::Defines defines;
+    for(size_t bit = 0; bit < mFeatures.size() && bit < MaxFeatures; ++bit) {
+        if(mask & (1u << bit)) {
+            defines.push_back(mFeatures[bit]);
+        }
+    }
+    // the base outlives its variants: both are owned here
+    const Shader *base{ mBase.get() };
+    variant = std::make_shared<Shader>(mVertexPath, mFragmentPath, std::move(defines), true, [base, mask](Shader &built) {
+        built.CopyUniforms(*base);
+        LOGI << "[ShaderVariants] Built variant " << mask;
+    });
+    if(mWatch) {
+        ShaderWatcher::Instance()->Watch(variant);
+    }
+    mTable[mask].store(variant.get(), std::memory_order_release);
+    return variant.get();
+}
+
+size_t ShaderVariants::Count() const {
+    std::lock_guard<std::mutex> lock{ mLock };
+    return mVariants.size();
+}
+
+void ShaderVariants::Watch() {
+    std::lock_guard<std::mutex> lock{ mLock };
+    mWatch = true;
+    for(const auto &variant : mVariants) {
+        ShaderWatcher::Instance()->Watch(variant.second);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef __SHADERVARIANTS_H__
+#define __SHADERVARIANTS_H__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shader.hpp"
+
+/**
+ * Permutations of one vertex/fragment pair. Bit i of a feature mask turns
+ * on the define features[i], so the sources can `#ifdef` away branches and
+ * uniforms a draw does not need. Each mask is compiled once, lazily: Get
+ * may be called while recording on any thread and returns a deferred
+ * Shader that is built by its first Use on the GL thread. A new variant
+ * starts with the uniform values of the base program (mask 0, built right
+ * away), e.g. the sampler units TextureGenerator set on it.
+ */
+class ShaderVariants {
+public:
+    using Ref = std::shared_ptr<ShaderVariants>;
+
+    static constexpr size_t MaxFeatures{ 8 };
+
+    ShaderVariants(const std::string &vShader, const std::string &fShader, std::vector<std::string> features);
+
+    const Shader::Ref &Base() const;
+    /// Thread safe, lock free once the variant exists; the pointer stays
+    /// valid as long as this object. Bits past the features are ignored.
+    Shader *Get(uint32_t mask);
+    /// Variants created so far, the base included.
+    size_t Count() const;
+
+    /// Hot reload for the base and every variant, present and future.
+    void Watch();
+
+private:
+    const std::string mVertexPath;
+    const std::string mFragmentPath;
+    const std::vector<std::string> mFeatures;
+    Shader::Ref mBase;
+
+    std::array<std::atomic<Shader *>, 1u << MaxFeatures> mTable{};
+
+    mutable std::mutex mLock;
+    std::unordered_map<uint32_t, Shader::Ref> mVariants;    ///< owners of mTable's entries
+    bool mWatch{ false };
+};
+
+#endif // __SHADERVARIANTS_H__
@@ -0,0 +1,250 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "shaderwatcher.hpp"
+#include "embeddedshaders.hpp"
+#include "shadersource.hpp"
+#include "trace.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    /// how often the thread checks for Stop while nothing changes
+    constexpr int kIdlePoll{ 250 };
+    /// quiet time after the last write before the sources are read; editors
+    /// save in several steps (truncate, write, rename)
+    constexpr int kSettle{ 50 };
+
+    std::string normal(const std::string &path) {
+        return fs::path{ path }.lexically_normal().string();
+    }
+}
+
+ShaderWatcher *ShaderWatcher::Instance() {
+    static ShaderWatcher watcher;
+    return &watcher;
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    Stop();
+}
+
+void ShaderWatcher::Watch(const Shader::Ref &shader) {
+    auto files{ Files(shader->VertexPath(), shader->FragmentPath()) };
+    std::lock_guard<std::mutex> lock{ mLock };
+    if(!mRunning) {
+#ifdef __linux__
+        mNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(mNotify < 0) {
+            LOGW << "[ShaderWatcher] inotify is unavailable, shaders are not reloaded";
+            return;
+        }
+#endif
+        mRunning = true;
+        mThread = std::thread{ &ShaderWatcher::Run, this };
+    }
+    for(const auto &file : files) {
+        AddWatch(file);
+    }
+    mEntries.push_back({ shader, shader->VertexPath(), shader->FragmentPath(), std::move(files) });
+    LOGI << "[ShaderWatcher] Watching '" << shader->VertexPath() << "', '" << shader->FragmentPath() << "'";
+}
+
+void ShaderWatcher::Update() {
+    std::vector<Sources> ready;
+    {
+        std::lock_guard<std::mutex> lock{ mLock };
+        ready.swap(mReady);
+    }
+    for(const auto &sources : ready) {
+        if(auto shader{ sources.shader.lock() }) {
+            shader->Rebuild(sources.vertex, sources.fragment);
+            const auto building{ std::find_if(mBuilding.begin(), mBuilding.end(), [&shader](const auto &entry) {
+                return entry.lock() == shader;
+            }) };
+            if(mBuilding.end() == building) {
+                mBuilding.push_back(shader);
+            }
+        }
+    }
+    for(auto entry = mBuilding.begin(); entry != mBuilding.end();) {
+        auto shader{ entry->lock() };
+        if(nullptr != shader) {
+            shader->FinishRebuild();
+        }
+        if(nullptr == shader || !shader->Rebuilding()) {
+            entry = mBuilding.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+}
+
+void ShaderWatcher::Stop() {
+    mRunning = false;
+    if(mThread.joinable()) {
+        mThread.join();
+    }
+    std::lock_guard<std::mutex> lock{ mLock };
+#ifdef __linux__
+    if(mNotify >= 0) {
+        close(mNotify);
+        mNotify = -1;
+    }
+    mDirectories.clear();
+#else
+    mTimes.clear();
+#endif
+    mEntries.clear();
+    mReady.clear();
+}
+
+void ShaderWatcher::AddWatch(const std::string &path) {
+#ifdef __linux__
+    // the directory, not the file: editors often replace the file on save
+    std::string directory{ fs::path{ path }.parent_path().string() };
+    directory = directory.empty() ? "." : directory;
+    for(const auto &watched : mDirectories) {
+        if(watched.second == directory) {
+            return;
+        }
+    }
+    const int watch{ inotify_add_watch(mNotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) };
+    if(watch < 0) {
+        LOGW << "[ShaderWatcher] Cannot watch '" << directory << "'";
+        return;
+    }
+    mDirectories[watch] = directory;
+#else
+    std::error_code error;
+    mTimes[path] = fs::last_write_time(path, error);
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::Files(const std::string &vPath, const std::string &fPath) {
+    std::vector<std::string> files{ normal(vPath), normal(fPath) };
+    for(const auto &path : { vPath, fPath }) {
+        std::vector<std::string> includes;
+        if(const auto *embedded{ EmbeddedShaders::Find(path) }) {
+            std::string_view list{ embedded->includes };
+            for(size_t end = list.find('\n'); std::string_view::npos != end; end = list.find('\n')) {
+                includes.emplace_back(list.substr(0, end));
+                list.remove_prefix(end + 1);
+            }
+        } else {
+            std::string source, error;
+            ShaderSource::Read(path, source, error, &includes);
+        }
+        for(auto &include : includes) {
+            include = normal(include);
+            if(files.end() == std::find(files.begin(), files.end(), include)) {
+                files.push_back(std::move(include));
+            }
+        }
+    }
+    return files;
+}
+
+void ShaderWatcher::Run() {
+    Trace::Instance()->SetThreadName("ShaderWatcher");
+    std::set<std::string> pending;
+    while(mRunning) {
+        const auto changed{ Poll(pending.empty() ? kIdlePoll : kSettle) };
+        if(changed.empty() && !pending.empty()) {
+            Load(pending);
+            pending.clear();
+        }
+        pending.insert(changed.begin(), changed.end());
+    }
+}
+
+std::set<std::string> ShaderWatcher::Poll(int timeout) {
+    std::set<std::string> changed;
+#ifdef __linux__
+    pollfd descriptor{ mNotify, POLLIN, 0 };
+    if(poll(&descriptor, 1, timeout) <= 0) {
+        return changed;
+    }
+    alignas(inotify_event) char buffer[4096];
+    ssize_t size{ 0 };
+    while((size = read(mNotify, buffer, sizeof(buffer))) > 0) {
+        std::lock_guard<std::mutex> lock{ mLock };
+        for(ssize_t at = 0; at < size;) {
+            const auto *event{ reinterpret_cast<const inotify_event *>(buffer + at) };
+            const auto directory{ mDirectories.find(event->wd) };
+            if(event->len > 0 && mDirectories.end() != directory) {
+                changed.insert((fs::path{ directory->second } / event->name).lexically_normal().string());
+            }
+            at += sizeof(inotify_event) + event->len;
+        }
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+    std::lock_guard<std::mutex> lock{ mLock };
+    for(auto &[path, time] : mTimes) {
+        std::error_code error;
+        const auto now{ fs::last_write_time(path, error) };
+        if(!error && now != time) {
+            time = now;
+            changed.insert(path);
+        }
+    }
+#endif
+    return changed;
+}
+
+void ShaderWatcher::Load(const std::set<std::string> &changed) {
+    std::vector<Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock{ mLock };
+        mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(), [](const Entry &entry) {
+            return entry.shader.expired();
+        }), mEntries.end());
+        for(const auto &entry : mEntries) {
+            const bool touched{ std::any_of(entry.files.begin(), entry.files.end(), [&changed](const std::string &file) {
+                return changed.count(file) > 0;
+            }) };
+            if(touched) {
+                entries.push_back(entry);
+            }
+        }
+    }
+
+    for(const auto &entry : entries) {
+        TRACE_SCOPE("shader", "ShaderWatcher::Load");
+        Sources sources{ entry.shader };
+        std::string error;
+        std::vector<std::string> includes;
+        if(!ShaderSource::Read(entry.vPath, sources.vertex, error, &includes)
+            || !ShaderSource::Read(entry.fPath, sources.fragment, error, &includes)) {
+            LOGW << "[ShaderWatcher] Cannot read '" << entry.vPath << "', '" << entry.fPath << "': " << error;
+            continue;
+        }
+        LOGI << "[ShaderWatcher] '" << entry.vPath << "', '" << entry.fPath << "' changed, rebuilding";
+        // shaders built from these paths from now on, e.g. new variants, read the files
+        EmbeddedShaders::Invalidate(entry.vPath);
+        EmbeddedShaders::Invalidate(entry.fPath);
+
+        std::lock_guard<std::mutex> lock{ mLock };
+        mReady.push_back(std::move(sources));
+        // the includes may have changed with the sources
+        for(auto &watched : mEntries) {
+            if(watched.shader.lock() != entry.shader.lock()) {
+                continue;
+            }
+            for(const auto &include : includes) {
+                const std::string file{ normal(include) };
+                if(watched.files.end() == std::find(watched.files.begin(), watched.files.end(), file)) {
+                    AddWatch(file);
+                    watched.files.push_back(file);
+                }
+            }
+        }
+    }
+}
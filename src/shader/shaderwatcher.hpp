@@ -0,0 +1,78 @@
+#ifndef __SHADERWATCHER_H__
+#define __SHADERWATCHER_H__
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shader.hpp"
+
+/**
+ * Shader hot reload. A background thread watches the source files of the
+ * shaders given to Watch (inotify on Linux, modification times elsewhere)
+ * and, once a burst of writes has settled, reads the changed shaders'
+ * sources. Update, called by the GL thread between frames, hands them to
+ * Shader::Rebuild and lets programs that finished building take over, so a
+ * frame never waits on a file or on the compiler.
+ *
+ * Shaders are held weakly: a shader that is destroyed simply stops being
+ * watched. Files a source includes are watched as well; once a source is
+ * reloaded its embedded copy (see EmbeddedShaders) is no longer used.
+ */
+class ShaderWatcher {
+public:
+    static ShaderWatcher *Instance();
+    ~ShaderWatcher();
+
+    /// Starts the watching thread on first use.
+    void Watch(const Shader::Ref &shader);
+    /// GL thread, at a frame boundary.
+    void Update();
+    /// Joins the watching thread; Watch starts it again.
+    void Stop();
+
+private:
+    struct Entry {
+        std::weak_ptr<Shader> shader;
+        std::string vPath;
+        std::string fPath;
+        std::vector<std::string> files;     ///< both sources and their includes, lexically normal as the watch reports them
+    };
+    struct Sources {
+        std::weak_ptr<Shader> shader;
+        std::string vertex;
+        std::string fragment;
+    };
+
+    std::mutex mLock;
+    std::vector<Entry> mEntries;
+    std::vector<Sources> mReady;
+    std::vector<std::weak_ptr<Shader>> mBuilding;   ///< GL thread only
+
+    std::thread mThread;
+    std::atomic<bool> mRunning{ false };
+#ifdef __linux__
+    int mNotify{ -1 };
+    std::map<int, std::string> mDirectories;        ///< inotify watch -> directory
+#else
+    std::map<std::string, std::filesystem::file_time_type> mTimes;
+#endif
+
+    ShaderWatcher() = default;
+
+    void AddWatch(const std::string &path);
+    /// The sources of a shader and, without reading them when they are embedded, their includes.
+    static std::vector<std::string> Files(const std::string &vPath, const std::string &fPath);
+    void Run();
+    /// Files changed within the next timeout milliseconds.
+    std::set<std::string> Poll(int timeout);
+    void Load(const std::set<std::string> &changed);
+};
+
+#endif // __SHADERWATCHER_H__
@@ -0,0 +1,41 @@
+#ifndef __UNIFORMBLOCKS_H__
+#define __UNIFORMBLOCKS_H__
+
+#include <cstdint>
+
+/**
+ * std140 uniform blocks every program may declare, mirrored from the GLSL in
+ * resources/shaders. GLSL 3.30 cannot give a block its binding point, so
+ * Shader points the blocks it finds, by name, at Binding after each link;
+ * GLBackend binds the buffers (see UniformRing).
+ *
+ * std140 aligns a mat4 to 16 bytes and a scalar to 4; members stay packed
+ * in vec4 rows so the C++ layout is the GLSL one.
+ */
+
+/// Written once per frame.
+struct FrameBlock {
+    static constexpr GLuint Binding{ 0 };
+    static constexpr const char *Name{ "Frame" };
+
+    glm::mat4 view{ 1.0f };
+    glm::mat4 projection{ 1.0f };
+    float time{ 0.0f };
+    float padding[3]{};
+};
+
+/// One per drawn object, bound with a range of the per-object ring.
+struct ObjectBlock {
+    static constexpr GLuint Binding{ 1 };
+    static constexpr const char *Name{ "Object" };
+
+    glm::mat4 transform{ 1.0f };
+    float mixValue{ 0.0f };
+    int32_t texId{ 0 };
+    float padding[2]{};
+};
+
+static_assert(sizeof(FrameBlock) == 144, "FrameBlock must match the std140 layout of Frame");
+static_assert(sizeof(ObjectBlock) == 80, "ObjectBlock must match the std140 layout of Object");
+
+#endif // __UNIFORMBLOCKS_H__
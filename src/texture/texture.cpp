@@ -22,6 +22,11 @@ void Texture::Bind() {
     glBindTexture(mType, mId);
 }
 
+void Texture::BindTo(GLenum position) {
+    glActiveTexture(position);
+    glBindTexture(mType, mId);
+}
+
 void Texture::Unbind() {
     glActiveTexture(0);
     glBindTexture(mType, 0);
@@ -35,3 +40,7 @@ GLenum Texture::type() const {
     return mType;
 }
 
+GLenum Texture::position() const {
+    return mPos;
+}
+
@@ -22,10 +22,13 @@ public:
 
     virtual TextureError load(const std::string &texFilename) = 0;
     virtual void Bind();
+    /// Binds to another unit than its own, for shaders sampling a fixed set of units
+    void BindTo(GLenum position);
     virtual void Unbind();
 
     GLenum id() const;
     GLenum type() const;
+    GLenum position() const;
 
 protected:
     GLuint mId;
@@ -5,6 +5,10 @@
 #include "texturegen.hpp"
 #include "texture.hpp"
 #include "shader.hpp"
+#include "jobsystem.hpp"
+#include "trace.hpp"
+#include "gpustats.hpp"
+#include "binarylog.hpp"
 
 namespace {
     struct Img {
@@ -12,17 +16,15 @@ namespace {
         int width{-1};
         int height{-1};
         int nrChannels{-1};
+        /// stbi_set_flip_vertically_on_load is global state: set it before decoding
         explicit Img(const std::string &path) {
-            stbi_set_flip_vertically_on_load(true);
+            TRACE_SCOPE("texture", "Img::decode");
             source = ::stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
             if(!valid()) {
-                LOGE << "[Texture] Cannot load '" << path << "' image";
+                BLOGE("[Texture] Cannot load '{}' image", path);
                 return;
             }
-            LOGI << "[Texture] The '" << path << "' was successfully loaded:";
-            LOGI << "[Texture] Texture width: " << width;
-            LOGI << "[Texture] Texture height: " << height;
-            LOGI << "[Texture] Texture channels: " << nrChannels;
+            BLOGI("[Texture] The '{}' was successfully loaded: width {}, height {}, channels {}", path, width, height, nrChannels);
         }
         ~Img() {
             if(nullptr != source) {
@@ -50,11 +52,18 @@ public:
     explicit Texture2D(GLenum type, GLenum position) : Texture(type, position) {}
 
     TextureError load(const std::string &texFilename) override {
+        TRACE_SCOPE("texture", "Texture2D::load");
         if(texFilename.empty()) {
             return TextureError::EmptyFilename;
         }
 
+        stbi_set_flip_vertically_on_load(true);
         Img image(texFilename);
+        return upload(image, texFilename);
+    }
+
+    TextureError upload(const Img &image, const std::string &texFilename) {
+        TRACE_SCOPE("texture", "Texture2D::upload");
         if(!image.valid()) {
             LOGW << "[Texture] Cannot load source from file '" << texFilename << "'";
             return TextureError::CannotLoadSource;
@@ -63,6 +72,7 @@ public:
         glTexImage2D(mType, 0, image.getChannels(), image.width, image.height,
                      0, image.getChannels(), GL_UNSIGNED_BYTE, image.source);
         glGenerateMipmap(mType);
+        GpuStats::AddUpload(static_cast<size_t>(image.width) * image.height * image.nrChannels);
 
         return TextureError::NoError;
     }
@@ -70,44 +80,87 @@ public:
 
 //== == == == == == == == == == = TextureGenerator = == == == == == == == == == ==//
 
-Texture::Ref TextureGenerator::Gen(const std::string &filename, Shader::Ref shader, GLenum type) {
-    Params defaultParams {
-        std::make_pair(GL_TEXTURE_WRAP_S, GL_REPEAT),
-        std::make_pair(GL_TEXTURE_WRAP_T, GL_REPEAT),
-        std::make_pair(GL_TEXTURE_MIN_FILTER, GL_LINEAR),
-        std::make_pair(GL_TEXTURE_MAG_FILTER, GL_LINEAR)
-    };
-    return Gen(filename, shader, defaultParams, type);
-}
-
-Texture::Ref TextureGenerator::Gen(const std::string &filename, Shader::Ref shader, const Params &params, GLenum type) {
-    static GLenum position = GL_TEXTURE0;
-    if(GL_TEXTURE31 == position) {
-        LOGW << "[TextureGenerator] Cannot create texture: the all slots was filles";
-        return nullptr;
+namespace {
+    TextureGenerator::Params defaultParams() {
+        return {
+            std::make_pair(GL_TEXTURE_WRAP_S, GL_REPEAT),
+            std::make_pair(GL_TEXTURE_WRAP_T, GL_REPEAT),
+            std::make_pair(GL_TEXTURE_MIN_FILTER, GL_LINEAR),
+            std::make_pair(GL_TEXTURE_MAG_FILTER, GL_LINEAR)
+        };
     }
 
-    Texture::Ref texture;
-    switch(type) {
-        case GL_TEXTURE_2D:
-            texture = std::make_shared<Texture2D>(type, position);
-            break;
-        default:
-            LOGE << "[TextureGenerator] Incorrect type";
+    /// Creates the texture in the next free slot; uploads decoded when given,
+    /// otherwise loads filename on the spot.
+    Texture::Ref generate(const std::string &filename, const Img *decoded, Shader::Ref shader,
+                          const TextureGenerator::Params &params, GLenum type) {
+        static GLenum position = GL_TEXTURE0;
+        if(GL_TEXTURE31 == position) {
+            LOGW << "[TextureGenerator] Cannot create texture: the all slots was filles";
             return nullptr;
-    }
+        }
+
+        std::shared_ptr<Texture2D> texture;
+        switch(type) {
+            case GL_TEXTURE_2D:
+                texture = std::make_shared<Texture2D>(type, position);
+                break;
+            default:
+                LOGE << "[TextureGenerator] Incorrect type";
+                return nullptr;
+        }
+
+        for(const auto &param : params) {
+            texture->Set(param.first, param.second);
+        }
 
-    for(const auto &param : params) {
-        texture->Set(param.first, param.second);
+        TextureError status{ nullptr != decoded ? texture->upload(*decoded, filename) : texture->load(filename) };
+        if(TextureError::NoError != status) {
+            LOGE << "[TextureGenerator] The loading was failed: " << static_cast<int>(status);
+        }
+        int id{ static_cast<int>(position) - GL_TEXTURE0 };
+        BLOGI("[TextureGenerator] The texture id: {}", id);
+        const std::string sampler{ "sample_" + std::to_string(id) };
+        if(shader->Location(sampler) >= 0) {
+            shader->Set(sampler, id);
+        } else {
+            LOGD << "[TextureGenerator] The shader has no '" << sampler << "', bind the texture to a sampled unit";
+        }
+        ++position;
+        return texture;
     }
+}
 
-    TextureError status{ texture->load(filename) };
-    if(TextureError::NoError != status) {
-        LOGE << "[TextureGenerator] The loading was failed: " << static_cast<int>(status);
+Texture::Ref TextureGenerator::Gen(const std::string &filename, Shader::Ref shader, GLenum type) {
+    return Gen(filename, shader, defaultParams(), type);
+}
+
+Texture::Ref TextureGenerator::Gen(const std::string &filename, Shader::Ref shader, const Params &params, GLenum type) {
+    return generate(filename, nullptr, shader, params, type);
+}
+
+std::vector<Texture::Ref> TextureGenerator::Gen(const std::vector<std::string> &filenames, Shader::Ref shader, GLenum type) {
+    // decoding is plain CPU work and fans out over the job system,
+    // the GL upload stays on the calling thread that owns the context
+    stbi_set_flip_vertically_on_load(true);
+    std::vector<std::unique_ptr<Img>> images(filenames.size());
+    JobSystem::Instance()->ParallelFor(0, filenames.size(), 1, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) {
+            if(!filenames[i].empty()) {
+                images[i] = std::make_unique<Img>(filenames[i]);
+            }
+        }
+    });
+
+    std::vector<Texture::Ref> textures;
+    textures.reserve(filenames.size());
+    for(size_t i = 0; i < filenames.size(); ++i) {
+        if(nullptr == images[i]) {
+            LOGE << "[TextureGenerator] The loading was failed: " << static_cast<int>(TextureError::EmptyFilename);
+            textures.push_back(nullptr);
+            continue;
+        }
+        textures.push_back(generate(filenames[i], images[i].get(), shader, defaultParams(), type));
     }
-    int id{ static_cast<int>(position) - GL_TEXTURE0 };
-    LOGI << "[TextureGenerator] The texture id: " << id;
-    shader->Set("sample_" + std::to_string(id), id);
-    ++position;
-    return texture;
+    return textures;
 }
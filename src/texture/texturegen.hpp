@@ -8,6 +8,8 @@ struct TextureGenerator {
     using Params = std::map<GLenum, GLint>;
     static Texture::Ref Gen(const std::string &filename, Shader::Ref shader, GLenum type = GL_TEXTURE_2D);
     static Texture::Ref Gen(const std::string &filename, Shader::Ref shader, const Params &params, GLenum type = GL_TEXTURE_2D);
+    /// Decodes all files in parallel, then creates the textures in order
+    static std::vector<Texture::Ref> Gen(const std::vector<std::string> &filenames, Shader::Ref shader, GLenum type = GL_TEXTURE_2D);
 };
 
 #endif // __TEXTUREGEN_H__
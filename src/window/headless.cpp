@@ -0,0 +1,291 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(WITH_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "headless.hpp"
+
+namespace {
+    /// ImGui gets a fixed time step so runs are reproducible.
+    constexpr float kFrameDelta{ 1.0f / 60.0f };
+
+#if defined(WITH_EGL)
+    bool hasExtension(const char *extensions, const char *name) {
+        if(nullptr == extensions) {
+            return false;
+        }
+        const size_t length{ std::strlen(name) };
+        for(const char *at = std::strstr(extensions, name); nullptr != at; at = std::strstr(at + 1, name)) {
+            const bool starts{ at == extensions || ' ' == at[-1] };
+            const bool ends{ '\0' == at[length] || ' ' == at[length] };
+            if(starts && ends) {
+                return true;
+            }
+        }
+        return false;
+    }
+#endif
+}
+
+HeadlessWindow::HeadlessWindow(const glm::ivec2 &targetSize, uint64_t frameCount)
+    : size{ targetSize }, frames{ frameCount }
+{
+    if(!createContext()) {
+        return;
+    }
+    // GLEW only built for GLX reports the missing GLX display after it has
+    // already loaded the context's entry points: that is fine here
+    glewExperimental = GL_TRUE;
+    if(auto rc{ glewInit() }; GLEW_OK != rc && GLEW_ERROR_NO_GLX_DISPLAY != rc) {
+        LOGE << "[Headless] Cannot initialize GLEW: " << rc;
+        return;
+    }
+    if(!createTarget()) {
+        return;
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+    ImGui_ImplOpenGL3_Init("#version 330 core");
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_ALWAYS);
+    times.reserve(frames);
+    valid = true;
+    LOGI << "[Headless] " << size.x << "x" << size.y << " target, " << frames << " frames, renderer: "
+         << reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+}
+
+HeadlessWindow::~HeadlessWindow() {
+    if(valid) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui::DestroyContext();
+    }
+    if(0 != fbo) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &color);
+        glDeleteRenderbuffers(1, &depth);
+    }
+#if defined(WITH_EGL)
+    if(nullptr != display) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if(nullptr != surface) {
+            eglDestroySurface(display, surface);
+        }
+        if(nullptr != context) {
+            eglDestroyContext(display, context);
+        }
+        eglTerminate(display);
+    }
+#endif
+}
+
+void HeadlessWindow::restart(uint64_t frameCount) {
+    frames = frameCount;
+    polled = 0;
+    frame = 0;
+    started = {};
+    frameStart = {};
+    times.clear();
+    times.reserve(frames);
+}
+
+bool HeadlessWindow::createContext() {
+#if defined(WITH_EGL)
+    const char *clientExtensions{ eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS) };
+    EGLDisplay eglDisplay{ EGL_NO_DISPLAY };
+    if(hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay{ reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT")) };
+        if(nullptr != getPlatformDisplay) {
+            eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if(EGL_NO_DISPLAY == eglDisplay) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    EGLint major{ 0 }, minor{ 0 };
+    if(EGL_NO_DISPLAY == eglDisplay || !eglInitialize(eglDisplay, &major, &minor)) {
+        LOGE << "[Headless] Cannot initialize EGL display: " << eglGetError();
+        return false;
+    }
+    display = eglDisplay;
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        LOGE << "[Headless] Desktop OpenGL is not available through EGL";
+        return false;
+    }
+
+    const bool surfaceless{ hasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") };
+    const EGLint configAttributes[]{
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config{ nullptr };
+    EGLint configs{ 0 };
+    if(!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configs) || 0 == configs) {
+        LOGE << "[Headless] No suitable EGL config: " << eglGetError();
+        return false;
+    }
+
+    const EGLint contextAttributes[]{
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+    if(EGL_NO_CONTEXT == context) {
+        context = nullptr;
+        LOGE << "[Headless] Cannot create a 3.3 core context: " << eglGetError();
+        return false;
+    }
+
+    if(!surfaceless) {
+        // the pbuffer only satisfies MakeCurrent, rendering goes to the FBO
+        const EGLint pbufferAttributes[]{ EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(eglDisplay, config, pbufferAttributes);
+        if(EGL_NO_SURFACE == surface) {
+            surface = nullptr;
+            LOGE << "[Headless] Cannot create a pbuffer: " << eglGetError();
+            return false;
+        }
+    }
+    const EGLSurface target{ nullptr != surface ? surface : EGL_NO_SURFACE };
+    if(!eglMakeCurrent(eglDisplay, target, target, context)) {
+        LOGE << "[Headless] Cannot make the context current: " << eglGetError();
+        return false;
+    }
+    LOGI << "[Headless] EGL " << major << "." << minor << (surfaceless ? ", surfaceless" : ", pbuffer");
+    return true;
+#else
+    LOGE << "[Headless] Built without EGL support";
+    return false;
+#endif
+}
+
+bool HeadlessWindow::createTarget() {
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    if(auto status{ glCheckFramebufferStatus(GL_FRAMEBUFFER) }; GL_FRAMEBUFFER_COMPLETE != status) {
+        LOGE << "[Headless] Incomplete framebuffer: " << status;
+        return false;
+    }
+    glViewport(0, 0, size.x, size.y);
+    return true;
+}
+
+void HeadlessWindow::poll_events() {
+    if(Clock::time_point{} == started) {
+        started = Clock::now();
+        frameStart = started;
+    }
+    ++polled;
+}
+
+void HeadlessWindow::new_frame() {
+    ImGui_ImplOpenGL3_NewFrame();
+    auto &io{ ImGui::GetIO() };
+    io.DisplaySize = ImVec2{ static_cast<float>(size.x), static_cast<float>(size.y) };
+    io.DisplayFramebufferScale = ImVec2{ 1.0f, 1.0f };
+    io.DeltaTime = kFrameDelta;
+}
+
+void HeadlessWindow::clear(const glm::vec4 &clr) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    Window::clear(clr);
+}
+
+void HeadlessWindow::update() {
+    const auto requested{ Clock::now() };
+    // nothing is presented: waiting for the GPU makes the frame time cover it
+    glFinish();
+    const auto now{ Clock::now() };
+    times.push_back(std::chrono::duration<double, std::milli>(now - frameStart).count());
+    frameStart = now;
+    ++frame;
+    recordFrame(requested);
+}
+
+bool HeadlessWindow::isActive() const {
+    return valid && polled < frames;
+}
+
+size_t HeadlessWindow::width() const {
+    return static_cast<size_t>(size.x);
+}
+
+size_t HeadlessWindow::height() const {
+    return static_cast<size_t>(size.y);
+}
+
+std::vector<uint8_t> HeadlessWindow::readPixels() const {
+    if(!valid) {
+        return {};
+    }
+    std::vector<uint8_t> pixels(static_cast<size_t>(size.x) * size.y * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    // GL rows start at the bottom
+    const size_t stride{ static_cast<size_t>(size.x) * 4 };
+    std::vector<uint8_t> row(stride);
+    for(size_t top = 0, bottom = size.y - 1; top < bottom; ++top, --bottom) {
+        std::memcpy(row.data(), &pixels[top * stride], stride);
+        std::memcpy(&pixels[top * stride], &pixels[bottom * stride], stride);
+        std::memcpy(&pixels[bottom * stride], row.data(), stride);
+    }
+    return pixels;
+}
+
+bool HeadlessWindow::save(const std::string &filename) const {
+    const auto pixels{ readPixels() };
+    if(pixels.empty()) {
+        return false;
+    }
+    std::ofstream out{ filename, std::ios::binary };
+    if(!out) {
+        LOGE << "[Headless] Cannot open '" << filename << "'";
+        return false;
+    }
+    out << "P6\n" << size.x << " " << size.y << "\n255\n";
+    for(size_t i = 0; i < pixels.size(); i += 4) {
+        out.write(reinterpret_cast<const char *>(&pixels[i]), 3);
+    }
+    LOGI << "[Headless] Saved '" << filename << "'";
+    return static_cast<bool>(out);
+}
+
+HeadlessWindow::Report HeadlessWindow::report() const {
+    Report result;
+    result.frames = times.size();
+    if(times.empty()) {
+        return result;
+    }
+    result.total = std::chrono::duration<double, std::milli>(frameStart - started).count();
+    result.average = result.total / times.size();
+    result.min = *std::min_element(times.begin(), times.end());
+    result.max = *std::max_element(times.begin(), times.end());
+    std::vector<double> sorted{ times };
+    const size_t rank{ std::min(sorted.size() - 1, (sorted.size() * 99) / 100) };
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    result.p99 = sorted[rank];
+    return result;
+}
@@ -0,0 +1,72 @@
+#ifndef __HEADLESS_H__
+#define __HEADLESS_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "window.hpp"
+
+/**
+ * Offscreen stand-in for Window: an EGL context (surfaceless when the
+ * driver allows it, a pbuffer otherwise) rendering into a framebuffer
+ * object, so frames can be produced without a display, e.g. by Mesa
+ * llvmpipe on build servers. It stays active for a fixed number of frames
+ * and keeps per-frame timings for the report.
+ *
+ * The GL entry points are loaded by the constructor.
+ */
+class HeadlessWindow : public Window {
+public:
+    struct Report {
+        uint64_t frames{ 0 };
+        double total{ 0.0 };     ///< ms, first frame start to last swap
+        double average{ 0.0 };
+        double min{ 0.0 };
+        double max{ 0.0 };
+        double p99{ 0.0 };
+    };
+
+    HeadlessWindow(const glm::ivec2 &size, uint64_t frames);
+    ~HeadlessWindow() override;
+
+    /// Runs another frames frames, dropping the timings collected so far.
+    void restart(uint64_t frames);
+
+    void poll_events() override;
+    void new_frame() override;
+    void clear(const glm::vec4 &clr) override;
+    void update() override;
+
+    bool isActive() const override;
+    size_t width() const override;
+    size_t height() const override;
+
+    /// RGBA8 rows of the render target, top row first.
+    std::vector<uint8_t> readPixels() const;
+    /// Binary PPM of the render target, for golden-image comparisons.
+    bool save(const std::string &filename) const;
+
+    Report report() const;
+
+private:
+    void *display{ nullptr };
+    void *context{ nullptr };
+    void *surface{ nullptr };
+    GLuint fbo{ 0 };
+    GLuint color{ 0 };
+    GLuint depth{ 0 };
+    glm::ivec2 size;
+    bool valid{ false };
+
+    uint64_t frames;
+    uint64_t polled{ 0 };
+    uint64_t frame{ 0 };
+    Clock::time_point started{};
+    Clock::time_point frameStart{};
+    std::vector<double> times;
+
+    bool createContext();
+    bool createTarget();
+};
+
+#endif // __HEADLESS_H__
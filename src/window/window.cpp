@@ -1,8 +1,19 @@
 #include "incs.hpp"
 #include "plog/Log.h"
+#include <cmath>
+#include <thread>
 
 #include "window.hpp"
 
+namespace {
+    constexpr double kMissedFactor{ 1.5 };
+    constexpr double kSpinMarginMs{ 0.2 };
+
+    double elapsedMs(Window::Clock::time_point from, Window::Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+}
+
 Window::Window(const glm::vec2 &size, const std::string &title)
     : wnd{ nullptr }
 {
@@ -39,14 +50,18 @@ Window::Window(GLFWmonitor *monitor, const std::string &title)
     setupWindowSettings();
 }
 
+Window::Window()
+    : wnd{ nullptr }
+{}
+
 Window::~Window() {
-    if(nullptr != wnd) {
-        glfwDestroyWindow(wnd);
+    if(nullptr == wnd) {
+        return;
     }
+    glfwDestroyWindow(wnd);
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
-
 }
 
 Window &Window::add_event(Window::Event e) {
@@ -63,6 +78,8 @@ Window &Window::remove_event(size_t id) {
 }
 
 void Window::poll_events() {
+    waitForDeadline();
+    sampled = Clock::now();
     for(const auto &e : events) {
         e();
     }
@@ -70,13 +87,55 @@ void Window::poll_events() {
     glfwPollEvents();
 }
 
+void Window::new_frame() {
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+}
+
 void Window::clear(const glm::vec4 &clr) {
     glClearColor(clr.r, clr.g, clr.b, clr.a);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 void Window::update() {
+    const auto requested{ Clock::now() };
+    applyPresentMode();
     glfwSwapBuffers(wnd);
+    if(lowLatency()) {
+        glFinish();
+    }
+    recordFrame(requested);
+}
+
+void Window::setPresentMode(PresentMode presentMode, double fps) {
+    std::lock_guard<std::mutex> lock{ pacingLock };
+    mode = presentMode;
+    fpsLimit = std::max(1.0, fps);
+}
+
+PresentMode Window::presentMode() const {
+    std::lock_guard<std::mutex> lock{ pacingLock };
+    return mode;
+}
+
+double Window::frameRateLimit() const {
+    std::lock_guard<std::mutex> lock{ pacingLock };
+    return fpsLimit;
+}
+
+void Window::setLowLatency(bool enabled) {
+    std::lock_guard<std::mutex> lock{ pacingLock };
+    finishAfterSwap = enabled;
+}
+
+bool Window::lowLatency() const {
+    std::lock_guard<std::mutex> lock{ pacingLock };
+    return finishAfterSwap;
+}
+
+Window::PacingStats Window::pacing() const {
+    std::lock_guard<std::mutex> lock{ pacingLock };
+    return stats;
 }
 
 bool Window::isActive() const {
@@ -134,6 +193,9 @@ void Window::setupWindowSettings() {
     glfwSetMouseButtonCallback(wnd, Window::onMouseButtonPressed);
     glfwMakeContextCurrent(wnd);
     glfwSwapInterval(1);
+    if(const auto *video{ glfwGetVideoMode(glfwGetPrimaryMonitor()) }) {
+        refreshRate = video->refreshRate;
+    }
     glfwSetWindowOpacity(wnd, 0.95);
 
     ImGui::SetCurrentContext(ctx);
@@ -160,3 +222,116 @@ void Window::onMouseButtonPressed(GLFWwindow *window, int button, int action, in
     UNUSED(action);
     UNUSED(mods);
 }
+
+void Window::applyPresentMode() {
+    PresentMode wanted;
+    {
+        std::lock_guard<std::mutex> lock{ pacingLock };
+        wanted = mode;
+    }
+    if(wanted == appliedMode) {
+        return;
+    }
+    int interval{ 1 };
+    switch(wanted) {
+        case PresentMode::VSync:
+            break;
+        case PresentMode::Adaptive:
+            if(glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+                interval = -1;
+            } else {
+                LOGW << "[Window] Adaptive vsync is not supported, using vsync";
+            }
+            break;
+        case PresentMode::Uncapped:
+        case PresentMode::Limited:
+            interval = 0;
+            break;
+    }
+    glfwSwapInterval(interval);
+    appliedMode = wanted;
+    deadline = Clock::time_point{};
+    LOGI << "[Window] Swap interval: " << interval;
+}
+
+void Window::waitForDeadline() {
+    double fps;
+    {
+        std::lock_guard<std::mutex> lock{ pacingLock };
+        if(PresentMode::Limited != appliedMode) {
+            waited = 0.0;
+            return;
+        }
+        fps = fpsLimit;
+    }
+    const auto period{ std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps)) };
+    const auto start{ Clock::now() };
+    // a deadline far behind (first frame, a stall) restarts the schedule
+    // instead of letting the limiter run frames back to back to catch up
+    if(deadline == Clock::time_point{} || start - deadline > period) {
+        deadline = start;
+    }
+
+    // coarse sleeps while the remaining time is well above the observed
+    // oversleep, then spin for the last fraction of a millisecond
+    while(true) {
+        const double remaining{ elapsedMs(Clock::now(), deadline) };
+        if(remaining <= sleepError + kSpinMarginMs) {
+            break;
+        }
+        const auto before{ Clock::now() };
+        const double request{ std::min(1.0, remaining - sleepError - kSpinMarginMs) };
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(request));
+        const double overshoot{ elapsedMs(before, Clock::now()) - request };
+        sleepError = 0.9 * sleepError + 0.1 * std::max(0.0, overshoot);
+    }
+    while(Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    deadline += period;
+    waited = elapsedMs(start, Clock::now());
+}
+
+void Window::recordFrame(Clock::time_point requested) {
+    const auto now{ Clock::now() };
+    std::lock_guard<std::mutex> lock{ pacingLock };
+    if(lastSwap == Clock::time_point{}) {
+        lastSwap = now;
+        return;
+    }
+    stats.frame = elapsedMs(lastSwap, now);
+    stats.work = sampled == Clock::time_point{} ? 0.0 : elapsedMs(sampled, requested);
+    stats.wait = waited;
+    switch(appliedMode) {
+        case PresentMode::Limited:
+            stats.target = 1000.0 / fpsLimit;
+            break;
+        case PresentMode::Uncapped:
+            stats.target = 0.0;
+            break;
+        default:
+            stats.target = refreshRate > 0.0 ? 1000.0 / refreshRate : 0.0;
+            break;
+    }
+    if(stats.target > 0.0 && stats.frame > stats.target * kMissedFactor) {
+        ++stats.missed;
+    }
+    history[stats.frames % PacingHistory] = stats.frame;
+    ++stats.frames;
+    lastSwap = now;
+
+    const size_t count{ std::min<size_t>(stats.frames, PacingHistory) };
+    double sum{ 0.0 }, peak{ 0.0 };
+    for(size_t i = 0; i < count; ++i) {
+        sum += history[i];
+        peak = std::max(peak, history[i]);
+    }
+    const double mean{ sum / count };
+    double variance{ 0.0 };
+    for(size_t i = 0; i < count; ++i) {
+        variance += (history[i] - mean) * (history[i] - mean);
+    }
+    stats.average = mean;
+    stats.peak = peak;
+    stats.jitter = std::sqrt(variance / count);
+}
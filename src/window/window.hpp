@@ -1,12 +1,39 @@
 #ifndef __WINDOW_H__
 #define __WINDOW_H__
 
+#include <array>
+#include <mutex>
+
 struct GLFWwindow;
 
+enum class PresentMode {
+    VSync,      ///< swap interval 1
+    Adaptive,   ///< swap interval -1 (tears instead of stalling on a late frame), vsync fallback
+    Uncapped,   ///< swap interval 0
+    Limited,    ///< swap interval 0 plus a sleep/spin limiter at a fixed rate
+};
+
 class Window {
 public:
     using Ref = std::shared_ptr<Window>;
     using Event = int (*)();
+    using Clock = std::chrono::steady_clock;
+
+    /// Per-frame pacing, all times in milliseconds. Averages, peak and
+    /// jitter (standard deviation) cover the last Window::PacingHistory frames.
+    struct PacingStats {
+        double frame{ 0.0 };     ///< swap to swap
+        double work{ 0.0 };      ///< input sampled to swap requested
+        double wait{ 0.0 };      ///< spent in the limiter
+        double target{ 0.0 };    ///< expected frame time, 0 when unknown
+        double average{ 0.0 };
+        double peak{ 0.0 };
+        double jitter{ 0.0 };
+        uint64_t frames{ 0 };
+        uint64_t missed{ 0 };    ///< frames longer than 1.5 * target
+    };
+    static constexpr size_t PacingHistory{ 120 };
+
     Window(const glm::vec2 &size, const std::string &title);
     Window(GLFWmonitor *monitor, const std::string &title);
     virtual ~Window();
@@ -14,23 +41,60 @@ public:
     Window &add_event(Event e);
     Window &remove_event(size_t id);
 
-    void poll_events();
-    void clear(const glm::vec4 &clr);
-    void update();
+    /// In Limited mode sleeps until the next frame is due first, so input is
+    /// sampled as late as possible before the frame is built.
+    virtual void poll_events();
+    /// Starts the platform and renderer halves of an ImGui frame.
+    virtual void new_frame();
+    virtual void clear(const glm::vec4 &clr);
+    virtual void update();
 
-    bool isActive() const;
+    /// Applied at the next update(), on the thread owning the GL context.
+    void setPresentMode(PresentMode mode, double fps = 60.0);
+    PresentMode presentMode() const;
+    double frameRateLimit() const;
+    /// glFinish after every swap: the CPU never queues frames ahead of the
+    /// GPU, trading throughput for one or two frames of input latency.
+    void setLowLatency(bool enabled);
+    bool lowLatency() const;
+    PacingStats pacing() const;
+
+    virtual bool isActive() const;
     bool isPressed(unsigned key);
     bool isHold(unsigned key);
 
-    size_t width() const;
-    size_t height() const;
+    virtual size_t width() const;
+    virtual size_t height() const;
 
     GLFWwindow *handler();
+protected:
+    /// For subclasses that bring their own context instead of a GLFW window.
+    Window();
+
+    void recordFrame(Clock::time_point requested);
+
 private:
     GLFWwindow *wnd;
     std::vector<Event> events;
 
+    mutable std::mutex pacingLock;
+    PresentMode mode{ PresentMode::VSync };
+    PresentMode appliedMode{ PresentMode::VSync };
+    double fpsLimit{ 60.0 };
+    bool finishAfterSwap{ false };
+    double refreshRate{ 0.0 };
+    double sleepError{ 1.0 };   ///< running estimate of sleep overshoot, ms
+
+    Clock::time_point deadline{};
+    Clock::time_point lastSwap{};
+    Clock::time_point sampled{};
+    double waited{ 0.0 };
+    std::array<double, PacingHistory> history{};
+    PacingStats stats;
+
     void setupWindowSettings();
+    void applyPresentMode();
+    void waitForDeadline();
 
     static void onWindowResized(GLFWwindow *, int width, int height);
     static void onKeyPressed(GLFWwindow *window, int key, int scancode, int action, int mods);
@@ -0,0 +1,139 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <algorithm>
+#include <cstdio>
+
+#include "logutilites.hpp"
+#include "headless.hpp"
+#include "glreplay.hpp"
+
+/**
+ * Replays a GL capture (main --gl-capture <file>) headless.
+ *
+ *   glreplay <capture> [--stats] [--loops N] [--size WxH] [--output image.ppm]
+ *
+ * Prints the per-call counts and redundancy of the capture, then, unless
+ * --stats is given, re-executes it and reports the time per frame (calls
+ * issued plus glFinish), i.e. driver overhead without the application.
+ */
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::string capture;
+        bool statsOnly{ false };
+        int loops{ 1 };
+        glm::ivec2 size{ 1370, 900 };
+        std::string output;
+    };
+
+    Options parseOptions(int argc, char **argv) {
+        Options options;
+        for(int i = 1; i < argc; ++i) {
+            const std::string arg{ argv[i] };
+            const bool hasValue{ i + 1 < argc };
+            if("--stats" == arg) {
+                options.statsOnly = true;
+            } else if("--loops" == arg && hasValue) {
+                options.loops = std::max(1, std::stoi(argv[++i]));
+            } else if("--size" == arg && hasValue) {
+                std::sscanf(argv[++i], "%dx%d", &options.size.x, &options.size.y);
+            } else if("--output" == arg && hasValue) {
+                options.output = argv[++i];
+            } else if(options.capture.empty()) {
+                options.capture = arg;
+            } else {
+                std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            }
+        }
+        return options;
+    }
+
+    void printStats(const GLCapture::Stats &stats, uint64_t frames) {
+        std::vector<size_t> order;
+        GLCapture::CallStats total;
+        for(size_t i = 0; i < stats.size(); ++i) {
+            if(stats[i].calls > 0) {
+                order.push_back(i);
+                total.calls += stats[i].calls;
+                total.redundant += stats[i].redundant;
+            }
+        }
+        std::sort(order.begin(), order.end(), [&stats](size_t a, size_t b) {
+            return stats[a].calls > stats[b].calls;
+        });
+        const double perFrame{ frames > 0 ? 1.0 / frames : 1.0 };
+        std::printf("%-28s %12s %12s %10s\n", "call", "per frame", "redundant", "%");
+        for(const size_t i : order) {
+            std::printf("%-28s %12.1f %12.1f %9.1f%%\n", GLStream::Name(static_cast<GLStream::Call>(i)),
+                stats[i].calls * perFrame, stats[i].redundant * perFrame, 100.0 * stats[i].redundant / stats[i].calls);
+        }
+        std::printf("%-28s %12.1f %12.1f %9.1f%%\n", "total", total.calls * perFrame, total.redundant * perFrame,
+            total.calls > 0 ? 100.0 * total.redundant / total.calls : 0.0);
+        std::printf("%llu frames\n", static_cast<unsigned long long>(frames));
+    }
+}
+
+int main(int argc, char **argv) {
+    Utilites::LogHelper::Instance()->Initialize(plog::info);
+    const Options options{ parseOptions(argc, argv) };
+    if(options.capture.empty()) {
+        std::fprintf(stderr, "Usage: glreplay <capture> [--stats] [--loops N] [--size WxH] [--output image.ppm]\n");
+        return 1;
+    }
+
+    GLReplay replay;
+    if(!replay.Open(options.capture)) {
+        return 2;
+    }
+    uint64_t frames{ 0 };
+    const auto stats{ replay.Scan(frames) };
+    printStats(stats, frames);
+    if(options.statsOnly) {
+        return 0;
+    }
+
+    HeadlessWindow window{ options.size, std::max<uint64_t>(1, frames * options.loops) };
+    if(!window.isActive()) {
+        return 3;
+    }
+    window.clear(glm::vec4{ 0.0f });
+    GLint target{ 0 };
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target);
+
+    std::vector<double> times;
+    times.reserve(frames * options.loops);
+    for(int loop = 0; loop < options.loops; ++loop) {
+        auto frameStart{ Clock::now() };
+        const bool ok{ replay.Run(static_cast<GLuint>(target), [&](uint64_t) {
+            glFinish();
+            const auto now{ Clock::now() };
+            times.push_back(std::chrono::duration<double, std::milli>(now - frameStart).count());
+            frameStart = now;
+        }) };
+        if(!ok) {
+            return 4;
+        }
+    }
+    if(times.empty()) {
+        std::printf("No complete frames to replay\n");
+        return 0;
+    }
+
+    std::vector<double> sorted{ times };
+    std::sort(sorted.begin(), sorted.end());
+    double total{ 0.0 };
+    for(const double time : times) {
+        total += time;
+    }
+    std::printf("replayed %zu frames: avg %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms, %llu queries skipped per loop\n",
+        times.size(), total / times.size(), sorted[sorted.size() / 2],
+        sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)], sorted.back(),
+        static_cast<unsigned long long>(replay.Skipped()));
+
+    if(!options.output.empty() && !window.save(options.output)) {
+        return 5;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <cstdio>
+#include <plog/Appenders/ConsoleAppender.h>
+#include <plog/Formatters/MessageOnlyFormatter.h>
+
+#include "binarylog.hpp"
+
+/**
+ * Prints a binary log (main --binary-log writes logs/<date>.blog) as text.
+ *
+ *   logdecode <file.blog> [--min-severity warning]
+ *
+ * Lines follow the text log: local time with microseconds, severity, thread,
+ * function@line and the message.
+ */
+
+namespace {
+    struct Options {
+        std::string path;
+        plog::Severity minSeverity{ plog::verbose };
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options) {
+        for(int i = 1; i < argc; ++i) {
+            const std::string arg{ argv[i] };
+            if("--min-severity" == arg && i + 1 < argc) {
+                options.minSeverity = plog::severityFromString(argv[++i]);
+                if(plog::none == options.minSeverity) {
+                    std::fprintf(stderr, "Unknown severity: %s\n", argv[i]);
+                    return false;
+                }
+            } else if(options.path.empty()) {
+                options.path = arg;
+            } else {
+                std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+                return false;
+            }
+        }
+        return !options.path.empty();
+    }
+
+    void print(const BinaryLogReader::Entry &entry) {
+        const time_t seconds{ static_cast<time_t>(entry.time / 1000000) };
+        tm t;
+        plog::util::localtime_s(&t, &seconds);
+        std::printf("%04d-%02d-%02d %02d:%02d:%02d.%06u %-5s [%u] [%s@%zu] %s\n",
+            t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+            static_cast<unsigned>(entry.time % 1000000), plog::severityToString(entry.site->severity),
+            entry.tid, entry.site->func.c_str(), entry.site->line, entry.text.c_str());
+    }
+}
+
+int main(int argc, char **argv) {
+    // reader errors
+    static plog::ConsoleAppender<plog::MessageOnlyFormatter> Console;
+    plog::init(plog::warning, &Console);
+
+    Options options;
+    if(!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: logdecode <file.blog> [--min-severity none|fatal|error|warning|info|debug|verbose]\n");
+        return 2;
+    }
+
+    BinaryLogReader reader;
+    if(!reader.Open(options.path)) {
+        return 1;
+    }
+    BinaryLogReader::Entry entry;
+    while(reader.Next(entry)) {
+        if(entry.site->severity <= options.minSeverity) {
+            print(entry);
+        }
+    }
+    if(reader.Failed()) {
+        std::fprintf(stderr, "%s: corrupt record, output stops there\n", options.path.c_str());
+        return 1;
+    }
+    return 0;
+}
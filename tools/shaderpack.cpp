@@ -0,0 +1,143 @@
+#include "incs.hpp"
+#include "plog/Log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+#include "shadersource.hpp"
+
+/**
+ * Build step behind EmbeddedShaders.
+ *
+ *   shaderpack --output <file.inc> [--validate <glslangValidator>] <path>[:vert|:frag]...
+ *
+ * Runs from the source root, so the paths are the ones the renderer creates
+ * its shaders with. Each file is preprocessed (ShaderSource) and written as
+ * an entry of a constexpr table; files given with a stage are also checked
+ * by the validator, without defines, and a rejected one fails the build.
+ */
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr std::string_view kDelimiter{ ")glsl\"" };
+    /// raw literals are split so no single one nears the compilers' limits
+    constexpr size_t kChunk{ 4096 };
+
+    struct Input {
+        std::string path;
+        std::string stage;      ///< empty: embed only
+    };
+
+    struct Options {
+        std::string output;
+        std::string validator;
+        std::vector<Input> inputs;
+    };
+
+    bool parseOptions(int argc, char **argv, Options &options) {
+        for(int i = 1; i < argc; ++i) {
+            const std::string arg{ argv[i] };
+            if("--output" == arg && i + 1 < argc) {
+                options.output = argv[++i];
+            } else if("--validate" == arg && i + 1 < argc) {
+                options.validator = argv[++i];
+            } else if(!arg.empty() && '-' != arg.front()) {
+                const size_t colon{ arg.rfind(':') };
+                const std::string stage{ std::string::npos == colon ? "" : arg.substr(colon + 1) };
+                if("vert" == stage || "frag" == stage) {
+                    options.inputs.push_back({ arg.substr(0, colon), stage });
+                } else {
+                    options.inputs.push_back({ arg, "" });
+                }
+            } else {
+                std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+                return false;
+            }
+        }
+        return !options.output.empty() && !options.inputs.empty();
+    }
+
+    std::string escaped(std::string_view text) {
+        std::string out{ "\"" };
+        for(const char c : text) {
+            if('"' == c || '\\' == c) {
+                out += '\\';
+            }
+            out += '\n' == c ? std::string{ "\\n" } : std::string(1, c);
+        }
+        return out + "\"";
+    }
+
+    /// Adjacent raw literals holding source, split at line ends.
+    std::string literal(std::string_view source) {
+        std::string out;
+        while(!source.empty()) {
+            size_t size{ std::min(source.size(), kChunk) };
+            if(size < source.size()) {
+                const size_t line{ source.rfind('\n', size - 1) };
+                size = std::string_view::npos == line ? size : line + 1;
+            }
+            out += out.empty() ? "R\"glsl(" : "\n        R\"glsl(";
+            out.append(source.substr(0, size)).append(kDelimiter);
+            source.remove_prefix(size);
+        }
+        return out.empty() ? std::string{ "\"\"" } : out;
+    }
+
+    bool validate(const std::string &validator, const Input &input, const std::string &source, const fs::path &directory) {
+        const fs::path file{ directory / (fs::path{ input.path }.filename().string() + "." + input.stage) };
+        std::ofstream{ file, std::ios::binary } << source;
+        std::string command{ "\"" + validator + "\" \"" + file.string() + "\"" };
+#ifdef _WIN32
+        command = "\"" + command + "\"";
+#endif
+        if(0 != std::system(command.c_str())) {
+            std::fprintf(stderr, "shaderpack: %s does not validate (preprocessed copy: %s)\n", input.path.c_str(), file.string().c_str());
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if(!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: shaderpack --output <file.inc> [--validate <glslangValidator>] <path>[:vert|:frag]...\n");
+        return 2;
+    }
+
+    std::string table{ "// Generated by shaderpack, do not edit.\n"
+                       "constexpr EmbeddedShaders::Entry kShaders[]{\n" };
+    for(const auto &input : options.inputs) {
+        std::string source, error;
+        std::vector<std::string> includes;
+        if(!ShaderSource::Read(input.path, source, error, &includes)) {
+            std::fprintf(stderr, "shaderpack: %s\n", error.c_str());
+            return 1;
+        }
+        if(std::string_view::npos != source.find(kDelimiter)) {
+            std::fprintf(stderr, "shaderpack: %s contains %s\n", input.path.c_str(), std::string{ kDelimiter }.c_str());
+            return 1;
+        }
+        if(!options.validator.empty() && !input.stage.empty()
+            && !validate(options.validator, input, source, fs::path{ options.output }.parent_path())) {
+            return 1;
+        }
+        std::string list;
+        for(const auto &include : includes) {
+            list += include + "\n";
+        }
+        const std::string path{ fs::path{ input.path }.lexically_normal().generic_string() };
+        table += "    {\n        " + escaped(path) + ",\n        " + literal(source) + ",\n        " + escaped(list) + "\n    },\n";
+    }
+    table += "};\n";
+
+    std::ofstream file{ options.output, std::ios::binary | std::ios::trunc };
+    file << table;
+    if(!file) {
+        std::fprintf(stderr, "shaderpack: cannot write %s\n", options.output.c_str());
+        return 1;
+    }
+    return 0;
+}